@@ -0,0 +1,65 @@
+#pragma once
+#include <cstdint>
+
+// Activity context from gravity orientation and motion energy.
+// Updated per sample with two exponential filters (no window buffers);
+// classified once per window with a short confirmation delay so one odd
+// window does not flip the context. Each context carries a detector
+// policy that decides which detectors run and with what thresholds.
+//
+// Orientation assumes the board is worn on the trunk or thigh with
+// ACTIVITY_UP_AXIS pointing up while standing.
+
+#ifndef ACTIVITY_UP_AXIS
+#define ACTIVITY_UP_AXIS 2   // 0 = x, 1 = y, 2 = z
+#endif
+
+enum ActivityContext : uint8_t {
+    ACTIVITY_LYING = 0,
+    ACTIVITY_SITTING,
+    ACTIVITY_STANDING,
+    ACTIVITY_WALKING,
+    ACTIVITY_COUNT
+};
+
+struct DetectorPolicy {
+    bool  run_tremor;
+    bool  run_tremor_axes;        // per-axis coherence and direction (needs run_tremor)
+    bool  run_dyskinesia;
+    bool  run_fog;
+    float tremor_threshold;       // % band energy
+    float dyskinesia_threshold;   // % band energy
+};
+
+// Classifier state; the firmware uses one static instance through
+// activity_init/update/classify, host tools keep one per stream
+struct ActivityState {
+    float gravity_alpha;
+    float motion_alpha;
+    float gravity[3];
+    float motion_power;
+    ActivityContext context;
+    ActivityContext candidate;
+    int   candidate_windows;
+};
+
+void activity_state_reset(ActivityState &s, float fs_hz);
+void activity_state_update(ActivityState &s, float ax, float ay, float az);
+ActivityContext activity_state_classify(ActivityState &s, float step_hz);
+
+void activity_init(float fs_hz);
+
+// Per sample, acceleration in g
+void activity_update(float ax, float ay, float az);
+
+// Once per window; step_hz from the last gait_update() (0 if not walking)
+ActivityContext activity_classify(float step_hz);
+
+ActivityContext activity_context();
+const DetectorPolicy &activity_policy(ActivityContext context);
+const char *activity_name(ActivityContext context);
+
+// Per-context CPU accounting for detect_symptoms()
+void activity_account(ActivityContext context, uint32_t analysis_us);
+uint32_t activity_windows(ActivityContext context);
+uint64_t activity_cpu_us(ActivityContext context);
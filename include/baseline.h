@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Per-patient adaptive baselines for detection thresholds.
+// Each metric keeps one streaming quantile estimate (stochastic
+// approximation, O(1) memory) whose step size follows an exponentially
+// weighted spread of the data, so it adapts over hours to days. Once warmed
+// up, the detection threshold becomes margin x quantile, clamped to a band
+// around the fixed default so a drifting baseline cannot disable a detector.
+
+enum BaselineMetric : uint8_t {
+    BASELINE_TREMOR = 0,     // tremor band energy %, upper quantile
+    BASELINE_DYSKINESIA,     // dyskinesia band energy %, upper quantile
+    BASELINE_GAIT_STD,       // gait magnitude std-dev (g), noise floor
+    BASELINE_COUNT
+};
+
+struct BaselineEstimate {
+    float estimate;
+    float spread;
+    uint32_t count;
+};
+
+// All metrics of one wearer; the firmware uses one static instance through
+// the functions below (the persisted one), host tools keep one per stream
+struct BaselineState {
+    BaselineEstimate metrics[BASELINE_COUNT];
+};
+
+void baseline_state_reset(BaselineState &s);
+void baseline_state_observe(BaselineState &s, BaselineMetric metric, float value);
+float baseline_state_threshold(const BaselineState &s, BaselineMetric metric, float default_threshold);
+
+void baseline_init();
+
+// Feed one window's value for a metric
+void baseline_observe(BaselineMetric metric, float value);
+
+// Patient-relative threshold; returns default_threshold until warmed up
+float baseline_threshold(BaselineMetric metric, float default_threshold);
+
+// Persisted form: magic, version, then per-metric estimate/spread/count.
+// A rejected blob only costs a re-learn. save returns bytes written or 0.
+size_t baseline_save(uint8_t *out, size_t capacity);
+bool baseline_load(const uint8_t *in, size_t length);
@@ -0,0 +1,122 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Bulk offload of stored records over BLE notifications.
+// The sender streams fixed-size records in frames sized to the negotiated
+// ATT MTU and keeps a window of unacknowledged records in flight. The
+// central acknowledges cumulatively and can resume a transfer after a
+// disconnect from the first record it is missing. Transport independent:
+// ble_service.cpp drives it from GATT events, tools/ble_offload_model.cpp
+// from a simulated link.
+//
+// Frame (notification):  u32 first_seq, u8 count, u8 flags, records...
+// Control (write):       u8 command, u32 seq  (little endian)
+// The central should ACK at least every half window and on OFFLOAD_FRAME_LAST.
+
+constexpr size_t OFFLOAD_FRAME_HEADER = 6;
+constexpr size_t OFFLOAD_CONTROL_BYTES = 5;
+constexpr size_t ATT_NOTIFY_HEADER = 3;      // opcode + handle
+constexpr size_t L2CAP_HEADER = 4;
+
+enum OffloadFrameFlags : uint8_t {
+    OFFLOAD_FRAME_LAST = 0x01,     // frame ends at the transfer's end_seq
+};
+
+enum OffloadCommand : uint8_t {
+    OFFLOAD_CMD_START = 1,         // seq = first record the central needs
+    OFFLOAD_CMD_ACK   = 2,         // seq = next record expected (cumulative)
+    OFFLOAD_CMD_STOP  = 3,
+};
+
+// Negotiated link parameters
+struct BleLinkParams {
+    uint16_t att_mtu;              // 23 default, up to 247 for one-PDU notifications
+    uint16_t ll_octets;            // LL max TX payload: 27, or up to 251 with DLE
+    bool     phy_2m;
+    uint32_t conn_interval_us;
+    uint8_t  max_pdus_per_event;   // controller limit per connection event
+};
+
+// Where records come from (e.g. session_log)
+struct OffloadSource {
+    uint32_t (*first_seq)();
+    uint32_t (*end_seq)();
+    size_t   (*read)(uint32_t seq, uint8_t *out, size_t max_records);
+    uint16_t record_bytes;
+};
+
+struct OffloadStats {
+    uint32_t bytes_sent;              // record bytes, retransmissions included
+    uint32_t bytes_acked;
+    uint32_t records_retransmitted;
+    uint32_t records_skipped;         // overwritten at the source before delivery
+    uint32_t timeouts;
+    uint32_t resumes;
+    uint32_t active_ms;               // connected with a transfer running
+    bool     complete;
+};
+
+struct OffloadSender {
+    OffloadSource source;
+    uint8_t  ack_rtt_events;          // connection events from a notification to its ACK
+    uint8_t  window_frames;           // from the link's bandwidth-delay product
+    uint32_t ack_timeout_ms;
+    uint16_t records_per_frame;       // from the link's ATT MTU
+    bool     started;
+    bool     active;                  // transfer requested and not complete
+    bool     linked;
+    uint32_t base_seq;                // oldest unacknowledged record
+    uint32_t next_seq;                // next record to send
+    uint32_t end_seq;                 // source end when the transfer started
+    uint32_t last_progress_ms;
+    uint32_t active_since_ms;
+    OffloadStats stats;
+};
+
+void ble_offload_init(OffloadSender &sender, const OffloadSource &source,
+                      uint8_t ack_rtt_events, uint32_t ack_timeout_ms);
+
+// Size frames and the window for the negotiated link (call again when
+// MTU/DLE/PHY or the connection interval change)
+void ble_offload_set_link(OffloadSender &sender, const BleLinkParams &link);
+
+void ble_offload_start(OffloadSender &sender, uint32_t from_seq, uint32_t now_ms);
+void ble_offload_ack(OffloadSender &sender, uint32_t next_seq, uint32_t now_ms);
+void ble_offload_stop(OffloadSender &sender, uint32_t now_ms);
+
+// Unacknowledged frames are assumed lost with the link
+void ble_offload_link_lost(OffloadSender &sender, uint32_t now_ms);
+
+// Parse and apply a control write. Returns false if malformed.
+bool ble_offload_control(OffloadSender &sender, const uint8_t *data, size_t length, uint32_t now_ms);
+
+// Go back to the oldest unacknowledged record after ack_timeout_ms without progress
+void ble_offload_poll(OffloadSender &sender, uint32_t now_ms);
+
+// Build the next frame without consuming it; 0 when the window is full or
+// everything has been sent. Call ble_offload_frame_sent() once the stack
+// accepted it.
+size_t ble_offload_frame(OffloadSender &sender, uint8_t *frame, size_t capacity);
+void ble_offload_frame_sent(OffloadSender &sender, const uint8_t *frame, uint32_t now_ms);
+
+// Acknowledged record throughput while connected (bits/s)
+uint32_t ble_offload_throughput_bps(const OffloadStats &stats);
+
+// Upper bound for record throughput on a link (bits/s): air time of the
+// data PDUs, the peer's empty acks and inter-frame spaces per event
+uint32_t ble_link_capacity_bps(const BleLinkParams &link, uint16_t record_bytes);
+
+// Radio time for one ATT notification or write carrying `value_bytes`
+// (same air-time model): charged to ENERGY_RADIO for each frame sent and
+// each control write received
+uint32_t ble_att_air_us(const BleLinkParams &link, size_t value_bytes);
+
+// Records that fit in one notification on this link
+uint16_t ble_offload_records_per_frame(const BleLinkParams &link, uint16_t record_bytes);
+
+// Frames in flight that keep the link busy: notifications per connection
+// event times the ACK round trip, doubled because the central only ACKs
+// every half window. 2..255 frames.
+uint8_t ble_offload_window_frames(const BleLinkParams &link, uint16_t record_bytes,
+                                  uint8_t ack_rtt_events);
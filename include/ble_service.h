@@ -1,9 +1,23 @@
 #pragma once
 
+#include <cstdint>
 #include "dsp.h"
+#include "energy.h"
 #include "gait.h"
 
-bool ble_service_init();
+// Starts the BLE stack and the bulk offload service when BLE_OFFLOAD_ENABLED.
+// on_events is called (from interrupt context) when the stack needs
+// ble_service_process() to run.
+bool ble_service_init(void (*on_events)());
+
+// Process pending stack events and stream offload frames; main loop only
+void ble_service_process(uint32_t now_ms);
 
 // Send latest analysis results over BLE
 void ble_service_update(const MovementAnalysis &m, const GaitStatus &g);
+
+// Publish the energy estimate on the telemetry characteristic. Value (little
+// endian): u32 uptime_s, then u32 charge since reset in uAh per
+// EnergySubsystem, CPU-other included. Readable; notified when the
+// negotiated ATT MTU fits it.
+void ble_service_energy(const EnergyReport &report, uint32_t uptime_s);
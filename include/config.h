@@ -1,5 +1,6 @@
 #pragma once
 #include <cstddef>
+#include <cstdint>
 
 // Sampling configuration
 constexpr float  FS_HZ        = 52.0f;        // IMU sampling rate
@@ -18,3 +19,11 @@ constexpr float DYSK_F_HIGH   = 7.0f;
 // Simple thresholds (you will tune these)
 constexpr float MIN_TOTAL_POWER      = 1e-3f;  // ignore windows with almost no motion
 constexpr float MIN_RELATIVE_ENERGY  = 0.3f;   // 30% of energy in band to count as tremor/dysk
+
+// Load shedding: below this magnitude std-dev the limb is treated as still
+constexpr float MOTION_GATE_STD_G    = 0.02f;
+
+// Scheduling (per stream: the device loop and every gateway stream)
+constexpr uint32_t HOP_PERIOD_MS         = 3000;  // one window per hop
+constexpr uint32_t HOP_DEADLINE_SLACK_MS = 500;   // tolerated lateness before a hop counts as missed
+constexpr uint32_t SENSOR_STALL_MS       = 1500;  // no samples for this long = stalled sensor
@@ -0,0 +1,147 @@
+#pragma once
+#include <cstdint>
+
+#include "activity.h"
+#include "baseline.h"
+#include "config.h"
+#include "harmonic_canceller.h"
+#include "load_shed.h"
+
+// Window-level detection core shared by the firmware and host tools.
+// Nothing here touches mbed or global state: spectral scratch and the
+// state carried between windows are passed in, so a host process can run
+// many streams at once. The firmware's analyze_frequency_band() and
+// gait_update() are thin wrappers over these with static instances.
+
+// 0 = none, 1 = freeze start, 2 = sustained freeze
+struct GaitStatus {
+    uint8_t fog_state;
+    float step_hz;      // cadence while walking, 0 when no gait detected
+    float std_dev;      // magnitude standard deviation over the window (g)
+
+    // Periodicity from the magnitude autocorrelation (detect_gait_periodicity)
+    float acf_step_hz;        // cadence from the step-lag peak, 0 if no peak
+    float step_regularity;    // normalised autocorrelation at one step (1 = identical steps)
+    float stride_regularity;  // ... at two steps, 0 if beyond the usable lag range
+    float step_symmetry;      // step / stride regularity, ~1 when both legs match
+};
+
+// Detector state carried from one window to the next
+struct GaitState {
+    float prev_variance;
+};
+
+// FFT buffers for one band analysis at a time (2.5 KB)
+struct SpectralScratch {
+    float fft_in[FFT_SIZE];
+    float fft_out[FFT_SIZE];
+    float power[FFT_SIZE / 2];
+};
+
+// Percentage of Hann-windowed spectral energy in [freq_low, freq_high]
+// for one WINDOW_SAMPLES window, zero padded to FFT_SIZE, computed by the
+// build's SpectralBackend (spectral_backend.h). With a full-spectrum
+// backend scratch.power holds the half spectrum afterwards.
+float detect_band_percent(const float *data, float freq_low, float freq_high,
+                          SpectralScratch &scratch);
+
+// Freeze and cadence detection on one window of x/y/z acceleration (g)
+GaitStatus detect_gait(const float *accel_x, const float *accel_y, const float *accel_z,
+                       float rigid_threshold, GaitState &state);
+
+// Wiener-Khinchin: the autocorrelation of the window is one more real FFT
+// of its power spectrum. scratch.power must hold the spectrum of
+// `magnitude` as detect_band_percent() left it; with have_power false it is
+// computed here first, by the build's SpectralBackend. Fills the
+// periodicity fields of status. Lags up to FFT_SIZE - WINDOW_SAMPLES
+// (100 samples, 1.9 s) are free of wrap-around.
+void detect_gait_periodicity(const float *magnitude, bool have_power, SpectralScratch &scratch,
+                             GaitStatus &status);
+
+// The same with the missing spectrum from Backend::power_spectrum();
+// instantiated for the three backends in spectral_backend.h
+template <typename Backend>
+void detect_gait_periodicity_with(const float *magnitude, bool have_power,
+                                  SpectralScratch &scratch, GaitStatus &status);
+
+// Relation between the axes in one band, from the 3x3 cross-spectral
+// matrix S = sum over band bins of v v^H, v = (X, Y, Z)
+struct AxisCoherence {
+    float coherence_xy;      // |S_xy|^2 / (S_xx S_yy), 0-1
+    float coherence_xz;
+    float coherence_yz;
+    float direction[3];      // principal axis of Re(S), unit vector, largest component > 0
+    float linearity;         // its share of band power: 1 = one direction, 1/3 = isotropic
+    float amplitude_g;       // sinusoid amplitude equivalent to the band power
+    bool valid;              // amplitude_g above the noise floor; other fields 0 if not
+};
+
+// All three axes share one FFT_SIZE real transform: each mean-removed,
+// Hann-windowed axis is wrapped to FFT_SIZE/4 samples (exact DTFT samples
+// at FS_HZ/64 spacing) into one slot of a 4-way interleave, and a radix-4
+// butterfly per band bin separates the slots again. Only scratch.fft_in
+// and fft_out are used; scratch.power is left as it was.
+AxisCoherence detect_axis_coherence(const float *accel_x, const float *accel_y,
+                                    const float *accel_z, float freq_low, float freq_high,
+                                    SpectralScratch &scratch);
+
+// Standard deviation of a window of vector magnitudes: the motion gate
+float detect_motion_std(const float *magnitude);
+
+// Per-stream pipeline in the order detect_symptoms() uses: activity
+// context picks the detectors and default thresholds, harmonic canceller
+// into the tremor band, total magnitude into the dyskinesia band, gait on
+// x/y/z, thresholds relative to the stream's learned baselines, cadence
+// fed back to the canceller and the classifier for the next window.
+// Below TIER_FULL work is skipped and the previous window's results held:
+//   TIER_LONG_HOP   every other window skips the band, coherence and
+//                   periodicity FFTs; gait still runs in the time domain
+//   TIER_GATE_ONLY  only the motion gate, which clears tremor and
+//                   dyskinesia when the limb is still
+// Per-sample state (canceller, activity filters) is updated at every tier.
+// Baselines learn only from values computed in that window.
+constexpr float DETECT_RIGID_STD_G = 0.15f;   // GAIT_RIGID_STD_G on the device
+
+struct DetectWindowResult {
+    float tremor_intensity;
+    float dyskinesia_intensity;
+    float step_hz;
+    float std_dev;
+    float step_regularity;
+    float step_symmetry;
+    float tremor_coherence;      // mean pairwise axis coherence in the tremor band
+    float tremor_linearity;
+    uint8_t fog_state;
+    ActivityContext activity;
+    bool tremor_detected;
+    bool dyskinesia_detected;
+    bool freezing_detected;
+};
+
+struct DetectStream {
+    HarmonicCanceller canceller;
+    GaitState gait;
+    ActivityState activity;
+    BaselineState baseline;
+    float last_step_hz;
+    uint32_t windows;                // analysed so far; LONG_HOP skips the odd ones
+    DetectWindowResult previous;     // held through shed work
+    SpectralScratch scratch;
+    float accel_x[WINDOW_SAMPLES];
+    float accel_y[WINDOW_SAMPLES];
+    float accel_z[WINDOW_SAMPLES];
+    float accel_total[WINDOW_SAMPLES];
+    float accel_tremor[WINDOW_SAMPLES];
+};
+
+void detect_stream_init(DetectStream &stream);
+
+// One window of interleaved x/y/z samples (WINDOW_SAMPLES * 3 floats, g)
+// at the tier load shedding picked for the stream
+DetectWindowResult detect_stream_window(DetectStream &stream, const float *xyz, AnalysisTier tier);
+
+// The same pipeline on a given spectral backend; instantiated for the
+// three in spectral_backend.h. detect_stream_window() uses SpectralBackend.
+template <typename Backend>
+DetectWindowResult detect_stream_window_with(DetectStream &stream, const float *xyz,
+                                             AnalysisTier tier);
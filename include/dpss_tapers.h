@@ -0,0 +1,121 @@
+#pragma once
+// Generated by tools/gen_dpss.py - do not edit.
+// DPSS (Slepian) tapers, N = 156, NW = 2.5, K = 4, unit energy.
+
+#define DPSS_N     156
+#define DPSS_K     4
+
+static const float DPSS_TAPERS[DPSS_K][DPSS_N] = {
+    {
+        6.20892874e-04f, 8.36299716e-04f, 1.08647757e-03f, 1.37430190e-03f, 1.70269821e-03f, 2.07462930e-03f,
+        2.49308168e-03f, 2.96105115e-03f, 3.48152768e-03f, 4.05747965e-03f, 4.69183741e-03f, 5.38747637e-03f,
+        6.14719971e-03f, 6.97372061e-03f, 7.86964435e-03f, 8.83745019e-03f, 9.87947322e-03f, 1.09978862e-02f,
+        1.21946818e-02f, 1.34716546e-02f, 1.48303840e-02f, 1.62722176e-02f, 1.77982545e-02f, 1.94093302e-02f,
+        2.11060019e-02f, 2.28885347e-02f, 2.47568888e-02f, 2.67107080e-02f, 2.87493096e-02f, 3.08716750e-02f,
+        3.30764424e-02f, 3.53619004e-02f, 3.77259838e-02f, 4.01662703e-02f, 4.26799793e-02f, 4.52639726e-02f,
+        4.79147561e-02f, 5.06284843e-02f, 5.34009657e-02f, 5.62276706e-02f, 5.91037405e-02f, 6.20239990e-02f,
+        6.49829651e-02f, 6.79748677e-02f, 7.09936620e-02f, 7.40330475e-02f, 7.70864875e-02f, 8.01472303e-02f,
+        8.32083316e-02f, 8.62626781e-02f, 8.93030128e-02f, 9.23219607e-02f, 9.53120561e-02f, 9.82657703e-02f,
+        1.01175540e-01f, 1.04033798e-01f, 1.06833001e-01f, 1.09565658e-01f, 1.12224366e-01f, 1.14801834e-01f,
+        1.17290916e-01f, 1.19684640e-01f, 1.21976236e-01f, 1.24159168e-01f, 1.26227155e-01f, 1.28174205e-01f,
+        1.29994636e-01f, 1.31683103e-01f, 1.33234617e-01f, 1.34644574e-01f, 1.35908767e-01f, 1.37023410e-01f,
+        1.37985153e-01f, 1.38791097e-01f, 1.39438804e-01f, 1.39926313e-01f, 1.40252145e-01f, 1.40415308e-01f,
+        1.40415308e-01f, 1.40252145e-01f, 1.39926313e-01f, 1.39438804e-01f, 1.38791097e-01f, 1.37985153e-01f,
+        1.37023410e-01f, 1.35908767e-01f, 1.34644574e-01f, 1.33234617e-01f, 1.31683103e-01f, 1.29994636e-01f,
+        1.28174205e-01f, 1.26227155e-01f, 1.24159168e-01f, 1.21976236e-01f, 1.19684640e-01f, 1.17290916e-01f,
+        1.14801834e-01f, 1.12224366e-01f, 1.09565658e-01f, 1.06833001e-01f, 1.04033798e-01f, 1.01175540e-01f,
+        9.82657703e-02f, 9.53120561e-02f, 9.23219607e-02f, 8.93030128e-02f, 8.62626781e-02f, 8.32083316e-02f,
+        8.01472303e-02f, 7.70864875e-02f, 7.40330475e-02f, 7.09936620e-02f, 6.79748677e-02f, 6.49829651e-02f,
+        6.20239990e-02f, 5.91037405e-02f, 5.62276706e-02f, 5.34009657e-02f, 5.06284843e-02f, 4.79147561e-02f,
+        4.52639726e-02f, 4.26799793e-02f, 4.01662703e-02f, 3.77259838e-02f, 3.53619004e-02f, 3.30764424e-02f,
+        3.08716750e-02f, 2.87493096e-02f, 2.67107080e-02f, 2.47568888e-02f, 2.28885347e-02f, 2.11060019e-02f,
+        1.94093302e-02f, 1.77982545e-02f, 1.62722176e-02f, 1.48303840e-02f, 1.34716546e-02f, 1.21946818e-02f,
+        1.09978862e-02f, 9.87947322e-03f, 8.83745019e-03f, 7.86964435e-03f, 6.97372061e-03f, 6.14719971e-03f,
+        5.38747637e-03f, 4.69183741e-03f, 4.05747965e-03f, 3.48152768e-03f, 2.96105115e-03f, 2.49308168e-03f,
+        2.07462930e-03f, 1.70269821e-03f, 1.37430190e-03f, 1.08647757e-03f, 8.36299716e-04f, 6.20892874e-04f,
+    },
+    {
+        4.25535467e-03f, 5.33177005e-03f, 6.52519549e-03f, 7.83933109e-03f, 9.27739078e-03f, 1.08420576e-02f,
+        1.25354406e-02f, 1.43590343e-02f, 1.63136798e-02f, 1.83995297e-02f, 2.06160156e-02f, 2.29618187e-02f,
+        2.54348452e-02f, 2.80322048e-02f, 3.07501939e-02f, 3.35842834e-02f, 3.65291108e-02f, 3.95784782e-02f,
+        4.27253541e-02f, 4.59618815e-02f, 4.92793909e-02f, 5.26684181e-02f, 5.61187288e-02f, 5.96193466e-02f,
+        6.31585884e-02f, 6.67241030e-02f, 7.03029167e-02f, 7.38814821e-02f, 7.74457327e-02f, 8.09811418e-02f,
+        8.44727853e-02f, 8.79054087e-02f, 9.12634976e-02f, 9.45313511e-02f, 9.76931590e-02f, 1.00733080e-01f,
+        1.03635323e-01f, 1.06384229e-01f, 1.08964355e-01f, 1.11360559e-01f, 1.13558081e-01f, 1.15542630e-01f,
+        1.17300464e-01f, 1.18818472e-01f, 1.20084254e-01f, 1.21086195e-01f, 1.21813541e-01f, 1.22256469e-01f,
+        1.22406149e-01f, 1.22254812e-01f, 1.21795802e-01f, 1.21023629e-01f, 1.19934015e-01f, 1.18523934e-01f,
+        1.16791646e-01f, 1.14736722e-01f, 1.12360069e-01f, 1.09663939e-01f, 1.06651939e-01f, 1.03329026e-01f,
+        9.97015045e-02f, 9.57770056e-02f, 9.15644686e-02f, 8.70741098e-02f, 8.23173856e-02f, 7.73069493e-02f,
+        7.20566009e-02f, 6.65812303e-02f, 6.08967544e-02f, 5.50200491e-02f, 4.89688744e-02f, 4.27617962e-02f,
+        3.64181025e-02f, 2.99577156e-02f, 2.34011005e-02f, 1.67691713e-02f, 1.00831933e-02f, 3.36468459e-03f,
+        -3.36468459e-03f, -1.00831933e-02f, -1.67691713e-02f, -2.34011005e-02f, -2.99577156e-02f, -3.64181025e-02f,
+        -4.27617962e-02f, -4.89688744e-02f, -5.50200491e-02f, -6.08967544e-02f, -6.65812303e-02f, -7.20566009e-02f,
+        -7.73069493e-02f, -8.23173856e-02f, -8.70741098e-02f, -9.15644686e-02f, -9.57770056e-02f, -9.97015045e-02f,
+        -1.03329026e-01f, -1.06651939e-01f, -1.09663939e-01f, -1.12360069e-01f, -1.14736722e-01f, -1.16791646e-01f,
+        -1.18523934e-01f, -1.19934015e-01f, -1.21023629e-01f, -1.21795802e-01f, -1.22254812e-01f, -1.22406149e-01f,
+        -1.22256469e-01f, -1.21813541e-01f, -1.21086195e-01f, -1.20084254e-01f, -1.18818472e-01f, -1.17300464e-01f,
+        -1.15542630e-01f, -1.13558081e-01f, -1.11360559e-01f, -1.08964355e-01f, -1.06384229e-01f, -1.03635323e-01f,
+        -1.00733080e-01f, -9.76931590e-02f, -9.45313511e-02f, -9.12634976e-02f, -8.79054087e-02f, -8.44727853e-02f,
+        -8.09811418e-02f, -7.74457327e-02f, -7.38814821e-02f, -7.03029167e-02f, -6.67241030e-02f, -6.31585884e-02f,
+        -5.96193466e-02f, -5.61187288e-02f, -5.26684181e-02f, -4.92793909e-02f, -4.59618815e-02f, -4.27253541e-02f,
+        -3.95784782e-02f, -3.65291108e-02f, -3.35842834e-02f, -3.07501939e-02f, -2.80322048e-02f, -2.54348452e-02f,
+        -2.29618187e-02f, -2.06160156e-02f, -1.83995297e-02f, -1.63136798e-02f, -1.43590343e-02f, -1.25354406e-02f,
+        -1.08420576e-02f, -9.27739078e-03f, -7.83933109e-03f, -6.52519549e-03f, -5.33177005e-03f, -4.25535467e-03f,
+    },
+    {
+        1.90041103e-02f, 2.21808289e-02f, 2.55330595e-02f, 2.90513433e-02f, 3.27247054e-02f, 3.65406777e-02f,
+        4.04853348e-02f, 4.45433401e-02f, 4.86980040e-02f, 5.29313540e-02f, 5.72242145e-02f, 6.15562992e-02f,
+        6.59063123e-02f, 7.02520603e-02f, 7.45705726e-02f, 7.88382313e-02f, 8.30309076e-02f, 8.71241067e-02f,
+        9.10931169e-02f, 9.49131655e-02f, 9.85595775e-02f, 1.02007938e-01f, 1.05234256e-01f, 1.08215130e-01f,
+        1.10927910e-01f, 1.13350863e-01f, 1.15463332e-01f, 1.17245893e-01f, 1.18680503e-01f, 1.19750646e-01f,
+        1.20441474e-01f, 1.20739930e-01f, 1.20634870e-01f, 1.20117173e-01f, 1.19179836e-01f, 1.17818062e-01f,
+        1.16029327e-01f, 1.13813447e-01f, 1.11172612e-01f, 1.08111424e-01f, 1.04636904e-01f, 1.00758498e-01f,
+        9.64880527e-02f, 9.18397883e-02f, 8.68302467e-02f, 8.14782281e-02f, 7.58047123e-02f, 6.98327632e-02f,
+        6.35874206e-02f, 5.70955768e-02f, 5.03858409e-02f, 4.34883902e-02f, 3.64348098e-02f, 2.92579224e-02f,
+        2.19916078e-02f, 1.46706144e-02f, 7.33036321e-03f, 6.74619948e-06f, -7.26408029e-03f, -1.44459053e-02f,
+        -2.15026752e-02f, -2.83987056e-02f, -3.50988935e-02f, -4.15689258e-02f, -4.77754854e-02f, -5.36864517e-02f,
+        -5.92710943e-02f, -6.45002601e-02f, -6.93465504e-02f, -7.37844884e-02f, -7.77906749e-02f, -8.13439325e-02f,
+        -8.44254353e-02f, -8.70188253e-02f, -8.91103134e-02f, -9.06887643e-02f, -9.17457656e-02f, -9.22756800e-02f,
+        -9.22756800e-02f, -9.17457656e-02f, -9.06887643e-02f, -8.91103134e-02f, -8.70188253e-02f, -8.44254353e-02f,
+        -8.13439325e-02f, -7.77906749e-02f, -7.37844884e-02f, -6.93465504e-02f, -6.45002601e-02f, -5.92710943e-02f,
+        -5.36864517e-02f, -4.77754854e-02f, -4.15689258e-02f, -3.50988935e-02f, -2.83987056e-02f, -2.15026752e-02f,
+        -1.44459053e-02f, -7.26408029e-03f, 6.74619948e-06f, 7.33036321e-03f, 1.46706144e-02f, 2.19916078e-02f,
+        2.92579224e-02f, 3.64348098e-02f, 4.34883902e-02f, 5.03858409e-02f, 5.70955768e-02f, 6.35874206e-02f,
+        6.98327632e-02f, 7.58047123e-02f, 8.14782281e-02f, 8.68302467e-02f, 9.18397883e-02f, 9.64880527e-02f,
+        1.00758498e-01f, 1.04636904e-01f, 1.08111424e-01f, 1.11172612e-01f, 1.13813447e-01f, 1.16029327e-01f,
+        1.17818062e-01f, 1.19179836e-01f, 1.20117173e-01f, 1.20634870e-01f, 1.20739930e-01f, 1.20441474e-01f,
+        1.19750646e-01f, 1.18680503e-01f, 1.17245893e-01f, 1.15463332e-01f, 1.13350863e-01f, 1.10927910e-01f,
+        1.08215130e-01f, 1.05234256e-01f, 1.02007938e-01f, 9.85595775e-02f, 9.49131655e-02f, 9.10931169e-02f,
+        8.71241067e-02f, 8.30309076e-02f, 7.88382313e-02f, 7.45705726e-02f, 7.02520603e-02f, 6.59063123e-02f,
+        6.15562992e-02f, 5.72242145e-02f, 5.29313540e-02f, 4.86980040e-02f, 4.45433401e-02f, 4.04853348e-02f,
+        3.65406777e-02f, 3.27247054e-02f, 2.90513433e-02f, 2.55330595e-02f, 2.21808289e-02f, 1.90041103e-02f,
+    },
+    {
+        6.03900798e-02f, 6.59205401e-02f, 7.14078953e-02f, 7.68160997e-02f, 8.21087043e-02f, 8.72491215e-02f,
+        9.22008955e-02f, 9.69279764e-02f, 1.01394996e-01f, 1.05567544e-01f, 1.09412440e-01f, 1.12898003e-01f,
+        1.15994310e-01f, 1.18673451e-01f, 1.20909768e-01f, 1.22680082e-01f, 1.23963908e-01f, 1.24743643e-01f,
+        1.25004751e-01f, 1.24735911e-01f, 1.23929153e-01f, 1.22579969e-01f, 1.20687397e-01f, 1.18254081e-01f,
+        1.15286306e-01f, 1.11794002e-01f, 1.07790728e-01f, 1.03293621e-01f, 9.83233227e-02f, 9.29038759e-02f,
+        8.70625989e-02f, 8.08299293e-02f, 7.42392458e-02f, 6.73266650e-02f, 6.01308165e-02f, 5.26925967e-02f,
+        4.50549033e-02f, 3.72623527e-02f, 2.93609814e-02f, 2.13979353e-02f, 1.34211464e-02f, 5.47900217e-03f,
+        -2.37999178e-03f, -1.01075530e-02f, -1.76559641e-02f, -2.49784137e-02f, -3.20293331e-02f, -3.87647262e-02f,
+        -4.51424908e-02f, -5.11227276e-02f, -5.66680360e-02f, -6.17437926e-02f, -6.63184118e-02f, -7.03635860e-02f,
+        -7.38545024e-02f, -7.67700364e-02f, -7.90929184e-02f, -8.08098745e-02f, -8.19117371e-02f, -8.23935277e-02f,
+        -8.22545088e-02f, -8.14982051e-02f, -8.01323941e-02f, -7.81690660e-02f, -7.56243517e-02f, -7.25184220e-02f,
+        -6.88753560e-02f, -6.47229812e-02f, -6.00926860e-02f, -5.50192055e-02f, -4.95403831e-02f, -4.36969088e-02f,
+        -3.75320361e-02f, -3.10912804e-02f, -2.44221001e-02f, -1.75735634e-02f, -1.05960036e-02f, -3.54066378e-03f,
+        3.54066378e-03f, 1.05960036e-02f, 1.75735634e-02f, 2.44221001e-02f, 3.10912804e-02f, 3.75320361e-02f,
+        4.36969088e-02f, 4.95403831e-02f, 5.50192055e-02f, 6.00926860e-02f, 6.47229812e-02f, 6.88753560e-02f,
+        7.25184220e-02f, 7.56243517e-02f, 7.81690660e-02f, 8.01323941e-02f, 8.14982051e-02f, 8.22545088e-02f,
+        8.23935277e-02f, 8.19117371e-02f, 8.08098745e-02f, 7.90929184e-02f, 7.67700364e-02f, 7.38545024e-02f,
+        7.03635860e-02f, 6.63184118e-02f, 6.17437926e-02f, 5.66680360e-02f, 5.11227276e-02f, 4.51424908e-02f,
+        3.87647262e-02f, 3.20293331e-02f, 2.49784137e-02f, 1.76559641e-02f, 1.01075530e-02f, 2.37999178e-03f,
+        -5.47900217e-03f, -1.34211464e-02f, -2.13979353e-02f, -2.93609814e-02f, -3.72623527e-02f, -4.50549033e-02f,
+        -5.26925967e-02f, -6.01308165e-02f, -6.73266650e-02f, -7.42392458e-02f, -8.08299293e-02f, -8.70625989e-02f,
+        -9.29038759e-02f, -9.83233227e-02f, -1.03293621e-01f, -1.07790728e-01f, -1.11794002e-01f, -1.15286306e-01f,
+        -1.18254081e-01f, -1.20687397e-01f, -1.22579969e-01f, -1.23929153e-01f, -1.24735911e-01f, -1.25004751e-01f,
+        -1.24743643e-01f, -1.23963908e-01f, -1.22680082e-01f, -1.20909768e-01f, -1.18673451e-01f, -1.15994310e-01f,
+        -1.12898003e-01f, -1.09412440e-01f, -1.05567544e-01f, -1.01394996e-01f, -9.69279764e-02f, -9.22008955e-02f,
+        -8.72491215e-02f, -8.21087043e-02f, -7.68160997e-02f, -7.14078953e-02f, -6.59205401e-02f, -6.03900798e-02f,
+    },
+};
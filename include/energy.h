@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+
+// Energy accounting: active time per subsystem combined with a per-state
+// current model gives estimated charge (mAh) per subsystem. The core is
+// plain arithmetic on microsecond counters, so the same estimate can be
+// computed in host simulation from simulated residency times.
+
+enum EnergySubsystem : uint8_t {
+    ENERGY_I2C = 0,     // IMU bus transfers
+    ENERGY_DSP,         // spectral + gait analysis
+    ENERGY_UART,        // console bytes on the wire
+    ENERGY_RADIO,       // BLE air time (notifications sent, writes received)
+    ENERGY_SLEEP,       // WFI sleep
+    ENERGY_DEEP_SLEEP,  // stop-mode sleep
+    ENERGY_CPU_OTHER,   // remaining awake time (derived, never added to)
+    ENERGY_COUNT
+};
+
+// Current drawn in each state (mA). Each entry is the whole-board draw,
+// except UART and radio which overlap other states and are increments on top.
+struct EnergyModel {
+    float current_ma[ENERGY_COUNT];
+};
+
+struct EnergyReport {
+    float elapsed_h;
+    float mah[ENERGY_COUNT];           // charge since reset
+    float mah_per_hour[ENERGY_COUNT];  // average rate
+    float total_mah_per_hour;
+};
+
+// Datasheet-based defaults for the B-L475E-IOT01A at 80 MHz
+EnergyModel energy_default_model();
+
+void energy_init(const EnergyModel &model, uint32_t uart_baud);
+
+// Accumulate active time for one subsystem
+void energy_add_time(EnergySubsystem subsystem, uint32_t us);
+
+// Accumulate UART traffic; converted to line time at the configured baud
+void energy_add_uart_bytes(uint32_t bytes);
+
+// Sleep residency is reported by the RTOS as running totals
+void energy_set_sleep(uint64_t sleep_us, uint64_t deep_sleep_us);
+
+// Estimate for the live counters over `elapsed_us` of uptime
+EnergyReport energy_report(uint64_t elapsed_us);
+
+// Pure estimate from explicit residency times (host simulation).
+// active_us[ENERGY_CPU_OTHER] is ignored and derived from the rest.
+EnergyReport energy_estimate(const EnergyModel &model,
+                             const uint64_t active_us[ENERGY_COUNT],
+                             uint64_t elapsed_us);
@@ -0,0 +1,78 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Pre-trigger "flight recorder" for raw IMU samples.
+// Samples are delta-coded into fixed-size blocks kept in a ring that
+// always holds the last FLIGHT_RECORDER_PRE_SECONDS of data. A trigger
+// keeps recording for FLIGHT_RECORDER_POST_SECONDS, then freezes the ring
+// as a snapshot that is read out in small chunks. Recording resumes once
+// the snapshot has been fully read. All memory is static.
+//
+// Block encoding (per axis): int16 key sample, uint8 range:2|shift:4, then
+// BLOCK_SAMPLES-1 int8 deltas scaled by 2^shift. Deltas are taken against
+// the reconstructed value, so quantization error never accumulates. A block
+// stores all samples at the widest accelerometer range it contains; LSBs
+// scale to g with ACCEL_SENSITIVITY_AT(flight_recorder_block_range()).
+
+#ifndef FLIGHT_RECORDER_PRE_SECONDS
+#define FLIGHT_RECORDER_PRE_SECONDS   10
+#endif
+#ifndef FLIGHT_RECORDER_POST_SECONDS
+#define FLIGHT_RECORDER_POST_SECONDS  5
+#endif
+#ifndef FLIGHT_RECORDER_RATE_HZ
+#define FLIGHT_RECORDER_RATE_HZ       52
+#endif
+
+constexpr size_t FR_BLOCK_SAMPLES = 13;  // 0.25 s at 52 Hz
+constexpr size_t FR_BLOCK_BYTES   = 3 * (2 + 1 + (FR_BLOCK_SAMPLES - 1));
+constexpr size_t FR_POST_BLOCKS   =
+    (FLIGHT_RECORDER_POST_SECONDS * FLIGHT_RECORDER_RATE_HZ + FR_BLOCK_SAMPLES - 1) / FR_BLOCK_SAMPLES;
+constexpr size_t FR_PRE_BLOCKS    =
+    (FLIGHT_RECORDER_PRE_SECONDS * FLIGHT_RECORDER_RATE_HZ + FR_BLOCK_SAMPLES - 1) / FR_BLOCK_SAMPLES;
+constexpr size_t FR_TOTAL_BLOCKS  = FR_PRE_BLOCKS + FR_POST_BLOCKS;
+constexpr uint8_t FR_SHIFT_MASK   = 0x0F;
+constexpr uint8_t FR_RANGE_SHIFT  = 6;
+
+// Trigger reasons (bit mask)
+enum FlightTrigger : uint8_t {
+    FR_TRIGGER_TREMOR     = 0x01,
+    FR_TRIGGER_DYSKINESIA = 0x02,
+    FR_TRIGGER_FREEZING   = 0x04,
+    FR_TRIGGER_MANUAL     = 0x08,
+};
+
+// Snapshot header, followed by block_count encoded blocks oldest first
+struct FlightSnapshotHeader {
+    uint8_t  magic[2];        // 'F', 'R'
+    uint8_t  reason;          // FlightTrigger mask
+    uint8_t  block_samples;
+    uint16_t block_count;
+    uint16_t trigger_block;   // index (in snapshot order) of the trigger block
+    uint32_t sequence;        // snapshot number since boot
+};
+
+void flight_recorder_init();
+
+// O(1) per sample; ignored while a snapshot is waiting to be read.
+// range is the accelerometer full-scale step the raw LSBs were taken at.
+void flight_recorder_add_sample(int16_t x, int16_t y, int16_t z, uint8_t range);
+
+// Arm post-trigger capture. Returns false if a capture is already running
+// or a snapshot has not been read out yet.
+bool flight_recorder_trigger(uint8_t reason);
+
+// True when a frozen snapshot is waiting to be read
+bool flight_recorder_ready();
+
+// Copy the next part of the snapshot (header then blocks). Returns bytes
+// copied; 0 when nothing is ready. Reading the last byte releases the
+// snapshot and resumes recording.
+size_t flight_recorder_read(uint8_t *out, size_t capacity);
+
+// Decode one block into FR_BLOCK_SAMPLES x/y/z samples (host review)
+void flight_recorder_decode_block(const uint8_t *block, int16_t out[FR_BLOCK_SAMPLES][3]);
+
+// Accelerometer range the decoded LSBs of a block are at
+uint8_t flight_recorder_block_range(const uint8_t *block);
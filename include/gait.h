@@ -1,10 +1,11 @@
 #pragma once
 #include "sensors.h"
+#include "detect_core.h"
 
-// 0 = none, 1 = freeze start, 2 = sustained freeze
-struct GaitStatus {
-    uint8_t fog_state;
-};
-
+// Freeze and cadence detection on the firmware's sensor_data window;
+// the analysis itself is detect_gait() in detect_core.cpp
 void gait_init();
 GaitStatus gait_update(const SignalWindow &window);
+
+// Std-dev below which motion counts as frozen (default 0.15 g)
+void gait_set_rigid_threshold(float std_dev_g);
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "detect_core.h"
+#include "gateway/reorder.h"
+
+// Compact binary snapshot of one gateway stream, so a stream moved to
+// another process (shard.h) resumes analysis on its next batch:
+//   - the DetectStream state carried between windows: harmonic canceller
+//     phasor and weights, gait variance, activity filters and confirmation,
+//     learned baselines, last cadence, and the window count and previous
+//     result load shedding holds through skipped work (per-window scratch
+//     is not kept)
+//   - the ReorderBuffer position and every retained slot, so the open
+//     window keeps its samples and closed windows can still be revised
+// Without it the new owner starts with an empty window (a 3 s refill
+// gap) and re-learns canceller, activity and baselines from scratch.
+//
+// Layout (little endian):
+//   magic 'GWCK' | version u16 | slot count u16 | stream_id u32
+//   canceller: fs, band_low, band_high, ph_re, ph_im, rot_re, rot_im f32,
+//     renorm_count u16, enabled u8, active bits u8,
+//     w_re/w_im f32[HARMONIC_CANCELLER_MAX + 1] each
+//   gait prev_variance f32 | last_step_hz f32
+//   held: windows u32, tremor, dyskinesia, step_hz, std_dev,
+//     step_regularity, step_symmetry, tremor_coherence, tremor_linearity f32,
+//     fog_state u8, activity u8, detected u8 (bit0 tremor, bit1 dysk, bit2 FoG)
+//   activity: gravity_alpha, motion_alpha, gravity[3], motion_power f32,
+//     context u8, candidate u8, candidate_windows u8
+//   baselines: estimate f32, spread f32, count u32 per BaselineMetric
+//   reorder: window_samples u32, retain_windows u32, lateness_samples u32,
+//     started u8, high_seq i64, next_close i64, then per used slot:
+//     index u16, window i64, present u32, revision u32,
+//     flags u8 (bit0 emitted, bit1 dirty), presence bitmap u64[words],
+//     x/y/z f32 of each present sample in offset order
+//   crc32 u32 (over everything before it)
+
+constexpr uint16_t CHECKPOINT_VERSION = 3;
+
+// Number of bytes checkpoint_save() writes for this stream
+size_t checkpoint_size(const ReorderBuffer &reorder);
+
+// Serialize one stream. Returns bytes written, or 0 if capacity is too small.
+size_t checkpoint_save(const DetectStream &stream, const ReorderBuffer &reorder,
+                       uint8_t *out, size_t capacity);
+
+// Restore one stream (reorder.stream_id receives the recorded id). Returns
+// false and leaves both untouched on a bad magic, version, length or CRC.
+bool checkpoint_restore(const uint8_t *in, size_t length, DetectStream &stream,
+                        ReorderBuffer &reorder);
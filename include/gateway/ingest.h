@@ -0,0 +1,137 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "config.h"
+#include "gateway/reorder.h"
+#include "load_shed.h"
+#include "timer_wheel.h"
+
+// UDP ingest front end for the host gateway (Linux).
+// Each worker owns one socket; with reuseport several workers bind the
+// same port and the kernel spreads relays across them by address hash, so
+// a stream's buffer is only ever touched by one worker and needs no lock.
+// A poll receives up to `batch` datagrams with one recvmmsg(), decodes the
+// samples from the receive buffers straight into the per-stream reorder
+// buffers and answers every batch datagram with one sendmmsg() of acks.
+// Closed windows go to the worker's handler with the analysis tier its
+// LoadShedState picks for that stream; the handler's run time and the
+// receive backlog (consecutive polls that came back with a full batch)
+// drive the shedding.
+// Every stream has a hop deadline and a stall timer on the worker's
+// millisecond TimerWheel, as the device loop does: each batch pushes the
+// stall timer back SENSOR_STALL_MS and arms the hop deadline if it is
+// idle, each first emission of a window re-arms it HOP_PERIOD_MS +
+// HOP_DEADLINE_SLACK_MS ahead. A stalled stream stops counting hop misses
+// until its next batch.
+//
+// Datagram (little endian):
+//   u16 magic 'GW', u8 version, u8 kind, u32 stream_id, u32 first_seq,
+//   u16 count, u16 range, then count x/y/z int16 samples (kind 1). range
+//   is the LSM6DSL full scale the batch was read at, 0..2 = +-2/4/8 g
+//   (0 from relays that predate auto-ranging)
+// Ack: u16 magic, u8 version, u8 kind 0x81, u32 stream_id, u32 first_seq,
+//   u16 count, u16 reserved - one per batch received, so the relay can
+//   retire backfilled and live batches independently
+
+constexpr uint16_t INGEST_MAGIC = 0x5747;        // "GW"
+constexpr uint8_t  INGEST_VERSION = 1;
+constexpr uint8_t  INGEST_KIND_SAMPLES = 1;
+constexpr uint8_t  INGEST_KIND_ACK = 0x81;
+constexpr uint16_t INGEST_RANGE_COUNT = 3;      // ACCEL_RANGE_COUNT on the device
+constexpr size_t   INGEST_HEADER_BYTES = 16;
+constexpr size_t   INGEST_ACK_BYTES = 16;
+constexpr size_t   INGEST_MAX_DATAGRAM = 1472;   // one Ethernet MTU
+constexpr size_t   INGEST_MAX_SAMPLES = (INGEST_MAX_DATAGRAM - INGEST_HEADER_BYTES) / 6;
+
+struct IngestConfig {
+    uint16_t port;
+    unsigned batch;              // datagrams per recvmmsg()
+    bool     reuseport;          // share the port with other workers
+    bool     send_acks;
+    ReorderConfig reorder;       // per-stream window and lateness bounds
+    float    lsb_to_g;           // LSM6DSL at +-2 g: 0.061 mg/LSB, doubled per range step
+    LoadShedConfig load_shed;    // queue depths count full receive batches
+};
+
+IngestConfig ingest_default_config(uint16_t port);
+
+// Analyse one closed or revised window at the given tier
+typedef void (*IngestWindowFn)(void *context, const ReorderView &view, AnalysisTier tier);
+
+struct IngestStats {
+    uint64_t syscalls;
+    uint64_t datagrams;
+    uint64_t samples;
+    uint64_t malformed;
+    uint64_t acks_sent;
+    uint64_t hop_misses;     // windows that closed later than the deadline
+    uint64_t stalls;         // streams that went SENSOR_STALL_MS without a batch
+};
+
+struct IngestWorker;
+
+struct IngestStreamTimers {
+    TimerNode hop;
+    TimerNode stall;
+    IngestWorker *worker;
+    uint32_t stream_id;
+    bool stalled;
+};
+
+struct IngestWorker {
+    IngestConfig config;
+    int fd;
+    std::vector<uint8_t> rx_buffers;          // batch * INGEST_MAX_DATAGRAM
+    std::vector<uint8_t> ack_buffers;         // batch * INGEST_ACK_BYTES
+    std::vector<uint8_t> mmsg_storage;        // mmsghdr/iovec/sockaddr arrays
+    std::unordered_map<uint32_t, ReorderBuffer> streams;
+    std::unordered_map<uint32_t, IngestStreamTimers> stream_timers;
+    TimerWheel timers;           // 1 ms ticks; list heads point into the worker, so it must not move
+    uint32_t now_ms;
+    IngestWindowFn on_window;    // closed windows and late revisions
+    void *window_context;
+    LoadShedState load_shed;
+    uint32_t backlog;            // consecutive polls that filled the batch
+    IngestStats stats;
+};
+
+// Buffers and state without a socket, for datagrams that arrive some
+// other way and go straight to ingest_datagram()
+void ingest_init(IngestWorker &worker, const IngestConfig &config);
+
+// ingest_init(), socket and bind. Returns false with errno set on failure.
+bool ingest_open(IngestWorker &worker, const IngestConfig &config);
+void ingest_close(IngestWorker &worker);
+
+// One recvmmsg() batch (waits up to timeout_ms for the first datagram).
+// Advances the timers to the steady clock first. Returns datagrams
+// processed, or -1 on a socket error.
+int ingest_poll(IngestWorker &worker, int timeout_ms);
+
+// Set the worker's clock and run every hop/stall timer due by then.
+// ingest_poll() does this itself; callers feeding ingest_datagram()
+// directly drive the clock here.
+void ingest_advance(IngestWorker &worker, uint32_t now_ms);
+
+// Drop a stream's buffer and timers without emitting anything, e.g. once
+// its state has been checkpointed to another worker
+void ingest_forget(IngestWorker &worker, uint32_t stream_id);
+
+// Take over a stream restored from another worker's checkpoint. Its
+// timers start as if a batch had just arrived.
+void ingest_adopt(IngestWorker &worker, ReorderBuffer &&buffer);
+
+// Decode one datagram into its stream's reorder buffer. Returns false if
+// the datagram is malformed.
+bool ingest_datagram(IngestWorker &worker, const uint8_t *data, size_t length);
+
+ReorderBuffer *ingest_stream(IngestWorker &worker, uint32_t stream_id);
+
+// Relay side / load generator: encode a sample batch read at full scale
+// `range`. Returns bytes written.
+size_t ingest_encode_samples(uint8_t *out, size_t capacity, uint32_t stream_id,
+                             uint32_t first_seq, const int16_t (*xyz)[3], uint16_t count,
+                             uint16_t range);
@@ -0,0 +1,98 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Per-stream reorder/deduplication buffer for the gateway ingest path.
+// A reconnecting device backfills stored windows while live batches keep
+// arriving, so batches overlap and arrive out of order. Samples are placed
+// by sequence number into fixed analysis windows (seq / window_samples)
+// kept in a ring of retain_windows slots, with a presence bit per sample
+// so overlapping batches are deduplicated.
+//
+// A window is closed and emitted once the highest sequence seen is
+// lateness_samples past its end. A sample that lands in a closed window
+// whose slot has not been reused marks only that window for re-analysis.
+// It is re-emitted with revision + 1 (or emitted for the first time, if it
+// was empty when closed) as soon as it is complete, or as it stands when
+// its slot is reused or the stream is flushed, so a backfill trickling in
+// batch by batch costs one re-analysis per window rather than one per
+// batch. Anything older than the retained ring is dropped as too late.
+
+// Longest a backfilled sample may trail the newest sample of its stream
+// and still be placed: a relay replays up to a 60 s outage plus 10 s
+// already delivered, interleaved with live batches, with slack for replay
+// that arrives shuffled. reorder_default_config() sizes the ring from it.
+constexpr uint32_t REORDER_BACKFILL_HORIZON_S = 90;
+
+struct ReorderConfig {
+    uint32_t window_samples;     // 156 = the firmware's 3 s window at 52 Hz
+    uint32_t retain_windows;     // ring slots, bounds memory and lateness
+    uint32_t lateness_samples;   // grace before a window is first emitted
+};
+
+ReorderConfig reorder_default_config();
+
+struct ReorderView {
+    uint32_t stream_id;
+    int64_t window;              // window number, first sample = window * size
+    uint32_t present;            // samples received (missing ones read as 0)
+    uint32_t revision;           // 0 on first emission, +1 per re-analysis
+    const float *accel_x;
+    const float *accel_y;
+    const float *accel_z;
+    const float *accel_total;
+    uint32_t size;
+};
+
+typedef void (*ReorderEmitFn)(void *context, const ReorderView &view);
+
+struct ReorderSlot {
+    int64_t window;              // -1 when unused
+    uint32_t present;
+    uint32_t revision;
+    bool emitted;
+    bool dirty;                  // late samples since closing/last emission
+};
+
+struct ReorderStats {
+    uint64_t accepted;
+    uint64_t duplicates;
+    uint64_t too_late;
+    uint64_t late_accepted;      // filled into an already closed window
+    uint64_t windows_emitted;
+    uint64_t revisions_emitted;
+    uint64_t windows_skipped;    // closed with no samples at all
+};
+
+struct ReorderBuffer {
+    ReorderConfig config;
+    uint32_t stream_id;
+    std::vector<float> accel_x, accel_y, accel_z, accel_total;  // retain * size
+    std::vector<uint64_t> present_bits;                         // per slot bitmap
+    std::vector<ReorderSlot> slots;
+    uint32_t bitmap_words;       // uint64_t words per slot
+    bool started;
+    int64_t high_seq;            // highest sequence seen + 1
+    int64_t next_close;          // first window not yet emitted
+    ReorderStats stats;
+};
+
+void reorder_init(ReorderBuffer &buffer, const ReorderConfig &config, uint32_t stream_id);
+
+// Heap bytes held by one stream's buffer
+size_t reorder_memory_bytes(const ReorderBuffer &buffer);
+
+// Insert `count` wire-format samples (x/y/z int16 little endian) starting
+// at 32-bit sequence number first_seq. Sequence numbers are widened against
+// the stream's position, so they may wrap. The batch was captured at
+// accelerometer full scale `range` (0..2 = +-2/4/8 g); each step doubles
+// the +-2 g sensitivity lsb_to_g, as ACCEL_SENSITIVITY_AT() does on the
+// device. Closed and revised windows are passed to emit before returning.
+void reorder_insert(ReorderBuffer &buffer, uint32_t first_seq, const uint8_t *samples,
+                    uint32_t count, unsigned range, float lsb_to_g, ReorderEmitFn emit,
+                    void *context);
+
+// Emit pending revisions and close every open window, e.g. when a stream
+// disconnects for good
+void reorder_flush(ReorderBuffer &buffer, ReorderEmitFn emit, void *context);
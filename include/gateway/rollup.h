@@ -0,0 +1,112 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+// Incrementally maintained per-patient daily and weekly summaries for the
+// clinician dashboard. Every window result updates its patient-day and
+// week in place, so queries never scan results. A window reported again
+// (a late revision from the reorder buffer, or a duplicate) first has its
+// previous contribution taken back out, using a small ring of recent
+// window flags per patient. A result ROLLUP_RECENT_WINDOWS or more behind
+// the patient's newest window can no longer be matched against what it
+// replaces, so it is dropped and counted rather than added a second time.
+//
+// FoG episodes are runs of consecutive freezing windows, counted on the
+// day the run starts. A late window can split or join runs; the neighbours
+// are looked up in a sparse set of the patient's freezing windows, pruned
+// to the same correction horizon.
+
+#ifndef ROLLUP_RECENT_WINDOWS
+#define ROLLUP_RECENT_WINDOWS 256       // ~13 min of 3 s windows correctable
+#endif
+
+constexpr uint32_t ROLLUP_WINDOW_S = 3;
+
+// 12 bytes per patient-day; 28800 windows/day fits 16 bits
+struct DayRollup {
+    uint16_t windows;            // windows monitored
+    uint16_t tremor_windows;
+    uint16_t dyskinesia_windows;
+    uint16_t fog_windows;
+    uint16_t fog_episodes;
+    uint16_t reserved;
+};
+
+struct WeekRollup {
+    uint32_t windows;
+    uint32_t tremor_windows;
+    uint32_t dyskinesia_windows;
+    uint32_t fog_windows;
+    uint32_t fog_episodes;
+};
+
+struct RollupRecent {
+    int64_t window;              // -1 when unused
+    uint32_t revision;
+    uint8_t flags;
+};
+
+struct PatientRollup {
+    int32_t utc_offset_s;        // days follow the patient's local midnight
+    int32_t first_day;           // days since 1970-01-01, local
+    std::vector<DayRollup> days;
+    int32_t first_week;          // Monday-based weeks since 1970
+    std::vector<WeekRollup> weeks;
+    std::vector<RollupRecent> recent;
+    int64_t high_window;         // newest window seen, -1 before the first
+    std::set<int64_t> fog;       // freezing window numbers within the horizon
+};
+
+struct RollupStore {
+    std::unordered_map<uint32_t, PatientRollup> patients;
+    uint64_t updates;
+    uint64_t corrections;        // results that replaced an earlier one
+    uint64_t stale;              // older revisions ignored
+    uint64_t too_old;            // beyond the correction horizon, dropped
+};
+
+// One window result. `window` numbers a patient's windows consecutively
+// (stream sequence / window size) and start_s is its UTC start time.
+// revision comes from ReorderView; an older revision arriving after a
+// newer one is ignored, as is any result for a window at or before
+// high_window - ROLLUP_RECENT_WINDOWS.
+struct RollupWindow {
+    uint32_t patient;
+    int64_t window;
+    int64_t start_s;
+    uint32_t revision;
+    uint8_t flags;               // SessionFlags
+};
+
+void rollup_init(RollupStore &store);
+void rollup_set_utc_offset(RollupStore &store, uint32_t patient, int32_t utc_offset_s);
+
+// Add or replace one window result
+void rollup_update(RollupStore &store, const RollupWindow &result);
+
+int32_t rollup_day_of(const RollupStore &store, uint32_t patient, int64_t unix_s);
+int32_t rollup_week_of_day(int32_t day);
+
+// Zeroed record (and false) for days or weeks without data
+bool rollup_day(const RollupStore &store, uint32_t patient, int32_t day, DayRollup &out);
+bool rollup_week(const RollupStore &store, uint32_t patient, int32_t week, WeekRollup &out);
+
+// Dashboard trend: per-week rates for `weeks` weeks ending at last_week,
+// oldest first, and their least-squares slope per week
+struct RollupTrend {
+    unsigned weeks;
+    float tremor_minutes_per_day[8];
+    float fog_episodes_per_day[8];
+    float tremor_slope;
+    float fog_slope;
+};
+
+constexpr unsigned ROLLUP_TREND_WEEKS = 8;
+
+void rollup_trend(const RollupStore &store, uint32_t patient, int32_t last_week,
+                  unsigned weeks, RollupTrend &out);
+
+size_t rollup_memory_bytes(const RollupStore &store);
@@ -0,0 +1,28 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Consistent-hash assignment of device streams to gateway processes.
+// Each gateway node is placed on a 32-bit hash ring at several virtual
+// points; a stream belongs to the first point clockwise from its own hash.
+// Adding or removing a node only moves the streams adjacent to its points,
+// and those streams are handed over with checkpoint_save()/restore()
+// (gateway/checkpoint.h); tools/shard_handoff.cpp exercises both.
+
+struct ShardPoint {
+    uint32_t hash;
+    uint32_t node_id;
+};
+
+struct ShardRing {
+    std::vector<ShardPoint> points;  // sorted by hash
+    unsigned vnodes_per_node;
+};
+
+void shard_ring_init(ShardRing &ring, unsigned vnodes_per_node = 64);
+void shard_ring_add_node(ShardRing &ring, uint32_t node_id);
+void shard_ring_remove_node(ShardRing &ring, uint32_t node_id);
+
+// Owner of a stream. Returns false if the ring has no nodes.
+bool shard_ring_lookup(const ShardRing &ring, uint32_t stream_id, uint32_t &node_id);
@@ -0,0 +1,37 @@
+#pragma once
+
+// Adaptive cancellation of gait cadence harmonics.
+// While walking, harmonics of the step frequency (2x, 3x ... of ~1.8 Hz)
+// fall inside the tremor band. An LMS combiner fed with sin/cos references
+// at each harmonic that lands in the protected band subtracts them sample
+// by sample. References come from one rotating phasor and its powers, so
+// the cost is a few MACs per sample per harmonic with no trig calls.
+
+constexpr int HARMONIC_CANCELLER_MAX = 4;  // highest harmonic considered
+
+// Filter state; the firmware uses one static instance through the
+// functions below, host tools keep one per stream
+struct HarmonicCanceller {
+    float fs;
+    float band_low;
+    float band_high;
+    float ph_re, ph_im;          // fundamental phasor
+    float rot_re, rot_im;        // its per-sample rotation
+    int   renorm_count;
+    bool  active[HARMONIC_CANCELLER_MAX + 1];
+    float w_re[HARMONIC_CANCELLER_MAX + 1];
+    float w_im[HARMONIC_CANCELLER_MAX + 1];
+    bool  enabled;
+};
+
+void harmonic_canceller_reset(HarmonicCanceller &c, float fs_hz, float band_low_hz, float band_high_hz);
+void harmonic_canceller_retune(HarmonicCanceller &c, float step_hz);
+float harmonic_canceller_filter(HarmonicCanceller &c, float sample);
+
+void harmonic_canceller_init(float fs_hz, float band_low_hz, float band_high_hz);
+
+// Set the current step frequency; 0 disables cancellation (not walking)
+void harmonic_canceller_set_step_hz(float step_hz);
+
+// Filter one sample, returns the sample with gait harmonics removed
+float harmonic_canceller_process(float sample);
@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdint>
+
+// Overload-adaptive analysis tiers.
+// Each analysis worker owns a LoadShedState and reports its queue depth
+// and per-window analysis latency. Under sustained overload the shed
+// pressure rises and individual streams drop to cheaper tiers; when load
+// falls the pressure decays and streams climb back to full analysis.
+
+// Ordered by cost; tools/bench_backends.cpp measures each. Goertzel on the
+// band bins is not a tier: for both bands it costs ~3x the real FFT.
+enum AnalysisTier : uint8_t {
+    TIER_FULL = 0,           // FFT band analysis every window
+    TIER_LONG_HOP,           // FFT band analysis every other window
+    TIER_GATE_ONLY,          // motion gate only, spectral results held
+    TIER_COUNT
+};
+
+struct LoadShedConfig {
+    uint32_t latency_budget_us;  // per-window analysis budget
+    uint32_t queue_high;         // backlog that counts as overload
+    uint32_t queue_low;          // backlog that counts as recovered
+    uint16_t pressure_step;      // pressure change per observation (0-100 scale per tier)
+};
+
+struct LoadShedState {
+    LoadShedConfig config;
+    float    latency_ewma_us;
+    uint16_t pressure;           // 0 .. (TIER_COUNT-1)*100
+
+    // Metrics
+    uint32_t tier_windows[TIER_COUNT];
+    uint32_t windows_total;
+    uint32_t windows_shed;       // windows run below TIER_FULL
+};
+
+void load_shed_init(LoadShedState &state, const LoadShedConfig &config);
+
+// Feed one observation: current backlog and the latency of the last window
+void load_shed_observe(LoadShedState &state, uint32_t queue_depth, uint32_t latency_us);
+
+// Tier a stream should use for its next window. Streams are demoted in a
+// fixed pseudo-random order so the same streams shed first each time.
+AnalysisTier load_shed_tier(const LoadShedState &state, uint32_t stream_id);
+
+// Record that a window was analyzed at the given tier
+void load_shed_account(LoadShedState &state, AnalysisTier tier);
+
+// Percentage of windows analyzed below TIER_FULL since init
+float load_shed_rate(const LoadShedState &state);
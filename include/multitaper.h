@@ -0,0 +1,24 @@
+#pragma once
+#include "config.h"
+#include "detect_core.h"
+
+// Multitaper power spectrum: the average of DPSS_K Slepian-tapered
+// periodograms of one WINDOW_SAMPLES window, zero padded to FFT_SIZE
+// (tapers from dpss_tapers.h). Lower variance than the single Hann
+// periodogram for the same window, at DPSS_K transforms instead of one.
+// Enabled on the device with SPECTRAL_MULTITAPER.
+
+// Half spectrum (FFT_SIZE / 2 bins) of the window with its mean
+// (gravity) removed; all zero under MOTION_GATE_STD_G, like the spectral
+// backends. Transforms with the build's SpectralBackend; not reentrant
+// (static scratch).
+void multitaper_power_spectrum(const float *data, float *power);
+
+// The same, each taper through Backend::power_spectrum() in the caller's
+// scratch; instantiated for the three backends in spectral_backend.h
+template <typename Backend>
+void multitaper_power_spectrum_with(const float *data, float *power, SpectralScratch &scratch);
+
+// Share of the half spectrum in [freq_low, freq_high], in percent, with
+// the spectral backends' bin convention
+float band_energy_percent(const float *power, float freq_low, float freq_high);
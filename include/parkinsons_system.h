@@ -15,22 +15,113 @@
 #define CTRL1_XL            0x10
 #define CTRL2_G             0x11
 #define CTRL3_C             0x12
+#define FIFO_CTRL1          0x06
+#define FIFO_CTRL2          0x07
+#define FIFO_CTRL3          0x08
+#define FIFO_CTRL5          0x0A
+#define INT1_CTRL           0x0D
+#define FIFO_STATUS1        0x3A
+#define FIFO_DATA_OUT_L     0x3E
 #define OUTX_L_XL           0x28
 #define OUTY_L_XL           0x2A
 #define OUTZ_L_XL           0x2C
 
+// Accelerometer sensitivity at ±2 g full scale (0.061 mg/LSB)
+#define ACCEL_SENSITIVITY_G (0.061f / 1000.0f)
+
+// === Accelerometer Auto-ranging ===
+// Full scale steps ±2 -> ±4 -> ±8 g; each step doubles the LSB size, so
+// raw * ACCEL_SENSITIVITY_AT(range) is exact in float at every range
+#ifndef ACCEL_AUTORANGE
+#define ACCEL_AUTORANGE         1        // 0 = fixed ±2 g
+#endif
+#define ACCEL_RANGE_COUNT       3        // ±2, ±4, ±8 g
+#define ACCEL_SENSITIVITY_AT(range) (ACCEL_SENSITIVITY_G * (float)(1 << (range)))
+#define AUTORANGE_UP_LSB        29490    // |raw| >= 90% of full scale: widen
+#define AUTORANGE_DOWN_LSB      13107    // all |raw| < 40% of full scale ...
+#define AUTORANGE_DOWN_SAMPLES  312      // ... for 6 s: narrow
+
 // === Sampling and FFT Parameters ===
 #define SAMPLE_RATE         52.0f        // Hz
 #define SAMPLE_PERIOD_MS    19           // ms
 #define BUFFER_SIZE         156          // 3 seconds * 52Hz
 #define GAIT_FFT_SIZE       256          // Power of 2, zero-padded
 
+// === Multitaper Spectral Estimation ===
+// Tapers are generated into dpss_tapers.h by tools/gen_dpss.py at build time
+#ifndef SPECTRAL_MULTITAPER
+#define SPECTRAL_MULTITAPER 0            // 1 = multitaper instead of single Hann window
+#endif
+#define MULTITAPER_NW       2.5          // time-bandwidth product (±0.83 Hz at 3 s)
+#define MULTITAPER_TAPERS   4            // 2NW - 1; must be even (tapers run in pairs)
+
+// === Scheduling ===
+// HOP_PERIOD_MS, HOP_DEADLINE_SLACK_MS and SENSOR_STALL_MS live in
+// config.h, shared with the gateway workers
+
+// === Batched Acquisition ===
+#define IMU_INT1_PIN            PD_11        // LSM6DSL INT1 on B-L475E-IOT01A
+#define FIFO_BATCH_SAMPLES      26           // wake once per 0.5 s of samples
+#define FIFO_BATCH_TIMEOUT_MS   600          // wake anyway if the watermark IRQ is missed
+
+// === Event Loop ===
+// 1 = mbed bare-metal profile (env disco_l475vg_iot01a_bare_metal): no RTOS
+// kernel, main() sleeps between interrupts itself instead of in an
+// EventFlags wait. Acquisition and analysis are the same code either way.
+#ifndef BARE_METAL
+#define BARE_METAL              0
+#endif
+
+// === Session Log / BLE Bulk Offload ===
+#ifndef BLE_OFFLOAD_ENABLED
+#define BLE_OFFLOAD_ENABLED     0        // 1 = GATT offload service (needs the BLE feature)
+#endif
+#define OFFLOAD_ACK_RTT_EVENTS  2        // connection events from a notification to its ACK;
+                                         // the window is sized per link from it
+#define OFFLOAD_ACK_TIMEOUT_MS  2000     // resend from the last ACK after this long
+#define OFFLOAD_CONN_INTERVAL   12       // requested during transfers, 1.25 ms units (15 ms)
+#ifndef SESSION_LOG_STREAM
+#define SESSION_LOG_STREAM      0        // 1 = print each window's record ("SL") live
+#endif
+
+// === Flight Recorder ===
+#define FLIGHT_EXPORT_CHUNK_BYTES   48       // snapshot bytes sent per wakeup
+
+// === Spectrogram History ===
+#ifndef SPECTROGRAM_STREAM
+#define SPECTROGRAM_STREAM          0        // 1 = print each window's record ("SG") live
+#endif
+#define SPECTROGRAM_EXPORT_CHUNK_BYTES  96   // dump bytes per wakeup (>= one key record)
+
 // === Detection Frequency Bands ===
 #define TREMOR_LOW_HZ       3.0f
 #define TREMOR_HIGH_HZ      5.0f
 #define DYSKINESIA_LOW_HZ   5.0f
 #define DYSKINESIA_HIGH_HZ  7.0f
 
+// Tremor intensity source: 0 = windowed FFT band power,
+// 1 = per-sample WFLC tracker (tremor_tracker.cpp)
+#ifndef USE_WFLC_TREMOR
+#define USE_WFLC_TREMOR     0
+#endif
+
+// Gait-harmonic canceller ahead of the tremor band (harmonic_canceller.cpp);
+// 0 passes the raw magnitude through, to measure what it removes
+#ifndef HARMONIC_CANCELLER
+#define HARMONIC_CANCELLER  1
+#endif
+
+// === Per-patient Baselines ===
+#define GAIT_RIGID_STD_G        0.15f           // default frozen std-dev threshold
+#define BASELINE_KV_KEY         "/kv/baseline"
+#define BASELINE_SAVE_WINDOWS   200             // persist every ~10 min
+
+// === Load Shedding ===
+#define DEVICE_STREAM_ID            0
+#define ANALYSIS_BUDGET_US          15000   // must fit inside one sample period
+// MOTION_GATE_STD_G (config.h) is shared with the gateway's detection core
+#define METRICS_REPORT_WINDOWS      20      // metrics lines every 20 windows (~1 min)
+
 // === Sensor Data Structure ===
 struct SensorData {
     float accel_x[BUFFER_SIZE];
@@ -38,6 +129,7 @@ struct SensorData {
     float accel_z[BUFFER_SIZE];
     
     float accel_total[BUFFER_SIZE];
+    float accel_tremor[BUFFER_SIZE];   // accel_total with gait harmonics removed
     uint16_t index;
 };
 
@@ -49,6 +141,13 @@ struct DetectionResults {
     float dyskinesia_intensity;  // 0-100%
     bool freezing_detected;
     float freezing_confidence;   // 0-100%
+    float tremor_frequency_hz;   // from the per-sample tracker, 0 until it locks
+
+    // Cross-axis features in the tremor band (full analysis tier only;
+    // 0 when the band holds no more than sensor noise)
+    float tremor_coherence;      // mean pairwise x/y/z coherence, 0-1
+    float tremor_axis[3];        // dominant oscillation direction, unit vector
+    float tremor_linearity;      // band power share along tremor_axis, 1/3-1
 };
 
 // ===================================================
@@ -60,6 +159,7 @@ extern DigitalOut led1;
 extern DigitalOut led2;
 extern DigitalOut led3;
 extern InterruptIn button;
+extern InterruptIn imu_int1;
 
 // === External Global Data ===
 extern SensorData sensor_data;
@@ -80,20 +180,18 @@ int log2_custom(int n);
 // ===================================================
 void write_register(uint8_t reg, uint8_t value);
 bool read_register(uint8_t reg, uint8_t &value);
-int16_t read_int16(uint8_t reg_low);
+bool read_registers(uint8_t reg, uint8_t *buffer, int length);
 
 // ===================================================
 // Sensor Initialization and Data Collection
 // ===================================================
 bool initialize_sensor();
-void read_accelerometer(float &acc_x, float &acc_y, float &acc_z);
 void collect_data_sample(float acc_x, float acc_y, float acc_z);
 bool buffer_is_full();
 
 // ===================================================
 // FFT and Frequency Analysis
 // ===================================================
-void fft_complex(float *real, float *imag, int n);
 float analyze_frequency_band(float *data, float freq_low, float freq_high);
 
 // ===================================================
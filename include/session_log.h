@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Per-window detection records kept for bulk offload.
+// Records get consecutive sequence numbers from boot and live in a static
+// RAM ring of SESSION_LOG_RECORDS; when full the oldest are overwritten.
+// Readers address records by sequence number, so an offload can resume
+// where it stopped as long as the records are still in the ring.
+
+#ifndef SESSION_LOG_RECORDS
+#define SESSION_LOG_RECORDS 1024        // ~51 min of 3 s windows, 12 KB
+#endif
+
+constexpr size_t SESSION_RECORD_BYTES = 12;
+
+enum SessionFlags : uint8_t {
+    SESSION_TREMOR     = 0x01,
+    SESSION_DYSKINESIA = 0x02,
+    SESSION_FREEZING   = 0x04,
+};
+
+struct SessionRecord {
+    uint32_t seq;             // assigned by session_log_append()
+    uint32_t uptime_s;
+    uint8_t  tremor;          // intensity 0-100
+    uint8_t  dyskinesia;      // intensity 0-100
+    uint8_t  flags;           // SessionFlags
+    uint8_t  activity;        // ActivityContext
+};
+
+void session_log_init();
+
+// Store a record; returns its sequence number
+uint32_t session_log_append(const SessionRecord &record);
+
+// Records [first, end) are available
+uint32_t session_log_first_seq();
+uint32_t session_log_end_seq();
+
+// Encode up to max_records records starting at seq (SESSION_RECORD_BYTES
+// each, little endian). Returns the number copied; 0 if seq is not held.
+size_t session_log_read(uint32_t seq, uint8_t *out, size_t max_records);
+
+void session_record_encode(const SessionRecord &record, uint8_t *out);
+void session_record_decode(const uint8_t *in, SessionRecord &record);
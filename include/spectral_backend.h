@@ -0,0 +1,90 @@
+#pragma once
+#include <cstddef>
+
+#include "config.h"
+#include "detect_core.h"
+
+// Spectral backends: interchangeable ways to compute what every detector
+// band needs, the share of Hann-windowed window energy in
+// [freq_low, freq_high] (bins floor(f * FFT_SIZE / FS_HZ), total over
+// bins 0..FFT_SIZE/2-1). The window mean (gravity) is removed first, and
+// a window under MOTION_GATE_STD_G has no band share (0). Each backend is a policy class:
+//
+//   static const char *name();
+//   static constexpr bool FULL_SPECTRUM;   // band_percent() leaves the half
+//                                          // spectrum in scratch.power
+//   static float band_percent(const float *data, float freq_low, float freq_high,
+//                             SpectralScratch &scratch);
+//   static void power_spectrum(SpectralScratch &scratch);
+//
+// power_spectrum() is the hook for everything that needs the whole half
+// spectrum rather than one band share: gait periodicity, the multitaper
+// tapers and dsp_analyze_window(). It transforms the FFT_SIZE samples
+// already in scratch.fft_in (windowed and zero padded by the caller,
+// overwritten) and writes |X[k]|^2, k < FFT_SIZE/2, to scratch.power. A
+// backend without a full spectrum of its own (FULL_SPECTRUM false) must
+// still provide it, with whichever transform it considers cheapest.
+//
+// Pipelines take the backend as a template parameter
+// (detect_stream_window_with<Backend>, detect_gait_periodicity_with<Backend>,
+// multitaper_power_spectrum_with<Backend>); SPECTRAL_BACKEND picks the one
+// the build runs, and tools/bench_backends.cpp compares all three on
+// identical windows.
+
+#define SPECTRAL_BACKEND_RFFT         0  // spectral_kernels rfft (CMSIS arm_rfft_fast_f32 on the device)
+#define SPECTRAL_BACKEND_FFT_COMPLEX  1  // radix-2 complex FFT with a zero imaginary part
+#define SPECTRAL_BACKEND_GOERTZEL     2  // band bins only, total from Parseval
+
+#ifndef SPECTRAL_BACKEND
+#define SPECTRAL_BACKEND SPECTRAL_BACKEND_RFFT
+#endif
+
+// Hann window over WINDOW_SAMPLES, built on first use (thread safe)
+const float *spectral_hann_window();
+
+// The Hann-windowed window with its mean removed, zero padded to FFT_SIZE
+// in scratch.fft_in: the input band_percent() transforms. Returns false
+// under MOTION_GATE_STD_G.
+bool spectral_window(const float *data, SpectralScratch &scratch);
+
+// In-place radix-2 complex FFT, n a power of two
+void fft_complex(float *real, float *imag, int n);
+
+struct RfftBackend {
+    static const char *name() { return "rfft"; }
+    static constexpr bool FULL_SPECTRUM = true;
+    static float band_percent(const float *data, float freq_low, float freq_high,
+                              SpectralScratch &scratch);
+    static void power_spectrum(SpectralScratch &scratch);
+};
+
+// fft_in and fft_out hold the real and imaginary parts
+struct FftComplexBackend {
+    static const char *name() { return "fft_complex"; }
+    static constexpr bool FULL_SPECTRUM = true;
+    static float band_percent(const float *data, float freq_low, float freq_high,
+                              SpectralScratch &scratch);
+    static void power_spectrum(SpectralScratch &scratch);
+};
+
+// One Goertzel recurrence per band bin over the windowed samples in
+// fft_in; cheapest for narrow bands, but scratch.power is left as it was.
+// A whole spectrum by Goertzel would be O(N^2), so power_spectrum() is
+// the rfft kernel's.
+struct GoertzelBackend {
+    static const char *name() { return "goertzel"; }
+    static constexpr bool FULL_SPECTRUM = false;
+    static float band_percent(const float *data, float freq_low, float freq_high,
+                              SpectralScratch &scratch);
+    static void power_spectrum(SpectralScratch &scratch) { RfftBackend::power_spectrum(scratch); }
+};
+
+#if SPECTRAL_BACKEND == SPECTRAL_BACKEND_RFFT
+typedef RfftBackend SpectralBackend;
+#elif SPECTRAL_BACKEND == SPECTRAL_BACKEND_FFT_COMPLEX
+typedef FftComplexBackend SpectralBackend;
+#elif SPECTRAL_BACKEND == SPECTRAL_BACKEND_GOERTZEL
+typedef GoertzelBackend SpectralBackend;
+#else
+#error "unknown SPECTRAL_BACKEND"
+#endif
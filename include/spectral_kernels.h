@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+
+// Spectral kernels behind one dispatch table.
+// The firmware table wraps CMSIS-DSP. Host builds compile the same kernels
+// for several x86 ISA levels and pick the best one the CPU supports on first
+// use (SPECTRAL_ISA=scalar|sse4.2|avx2|avx512 in the environment overrides).
+
+#define SPECTRAL_MAX_FFT    1024     // largest supported transform (power of two)
+
+struct SpectralKernels {
+    const char *name;
+
+    // Real FFT of n points (32..SPECTRAL_MAX_FFT, power of two) in the
+    // arm_rfft_fast_f32 layout: out[0] = X[0], out[1] = X[n/2], then
+    // re/im pairs for bins 1..n/2-1. `in` may be overwritten.
+    void (*rfft)(float *in, float *out, int n);
+
+    // out[i] = a[i] * b[i] (window multiply)
+    void (*multiply)(const float *a, const float *b, float *out, int n);
+
+    // power[k] = |X[k]|^2 for k in [0, n/2) from a packed rfft output
+    void (*power)(const float *packed, float *power, int n);
+
+    // Sum of n values (band accumulation)
+    float (*sum)(const float *x, int n);
+};
+
+// Table selected for this CPU (selected once, thread safe)
+const SpectralKernels &spectral_kernels();
+
+// Every variant this CPU can run, best last; for benchmarks and cross-checks
+size_t spectral_kernel_variants(const SpectralKernels **out, size_t max);
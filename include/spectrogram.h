@@ -0,0 +1,81 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "config.h"
+
+// History of per-window magnitude spectra for trend review and a live
+// spectrogram display. Each 3 s window's power spectrum (the one the
+// dyskinesia band already computed) is cut to SPECTROGRAM_LOW_HZ..
+// SPECTROGRAM_HIGH_HZ, quantized to 8-bit log magnitude and appended to a
+// static byte ring of SPECTROGRAM_BYTES. When full, the oldest key frame
+// and its deltas are dropped together, so the ring always starts decodable.
+//
+// Records (little endian):
+//   key   : 'K' | window seq u16 | SPECTROGRAM_BINS levels
+//   delta : 'D' | length u8 (bytes that follow) | k u8 | bits, MSB first:
+//           per bin the step from the previous column, zigzagged
+//           (0, -1, 1, -2, ...) and Rice coded with parameter k (quotient
+//           in unary ones ended by a zero, then k low bits). Twelve ones
+//           instead mean an 8-bit absolute level follows.
+//   gap   : 'G'  (window analysed without a spectrum)
+// Deltas and gaps each advance the window seq by one. A key is written
+// every SPECTROGRAM_KEY_INTERVAL windows and after every gap.
+// Level q is power in 0.5 dB steps: dB = (q - SPECTROGRAM_LEVEL_OFFSET) / 2,
+// q = 0 at or below the floor.
+
+#ifndef SPECTROGRAM_BYTES
+#define SPECTROGRAM_BYTES        8192    // ~7 min at ~57 bytes per window
+#endif
+#ifndef SPECTROGRAM_KEY_INTERVAL
+#define SPECTROGRAM_KEY_INTERVAL 20      // windows (1 min)
+#endif
+
+constexpr float  SPECTROGRAM_LOW_HZ  = 0.5f;
+constexpr float  SPECTROGRAM_HIGH_HZ = 15.0f;
+// First bin at or above the low edge (bin 3, 0.61 Hz): bin 2 would sit
+// below 0.5 Hz, where gravity's window leakage dominates
+constexpr float  SPECTROGRAM_LOW_BIN_F = SPECTROGRAM_LOW_HZ * FFT_SIZE / FS_HZ;
+constexpr size_t SPECTROGRAM_BIN_LOW  = (size_t)SPECTROGRAM_LOW_BIN_F +
+                                        ((float)(size_t)SPECTROGRAM_LOW_BIN_F < SPECTROGRAM_LOW_BIN_F);
+constexpr size_t SPECTROGRAM_BIN_HIGH = (size_t)(SPECTROGRAM_HIGH_HZ * FFT_SIZE / FS_HZ);
+constexpr size_t SPECTROGRAM_BINS     = SPECTROGRAM_BIN_HIGH - SPECTROGRAM_BIN_LOW + 1;
+constexpr int    SPECTROGRAM_LEVEL_OFFSET = 144;
+constexpr size_t SPECTROGRAM_KEY_BYTES    = 3 + SPECTROGRAM_BINS;
+constexpr size_t SPECTROGRAM_RECORD_MAX   = SPECTROGRAM_KEY_BYTES;
+
+static_assert(SPECTROGRAM_BYTES >= 2 * SPECTROGRAM_KEY_BYTES, "spectrogram ring too small");
+
+enum SpectrogramRecord : uint8_t {
+    SPECTROGRAM_KEY   = 'K',
+    SPECTROGRAM_DELTA = 'D',
+    SPECTROGRAM_GAP   = 'G',
+};
+
+void spectrogram_init();
+
+// Append one window. power holds FFT_SIZE/2 power bins; only the
+// SPECTROGRAM_BINS band is read.
+void spectrogram_push(const float *power);
+
+// Append a window that has no spectrum (cheaper analysis tiers)
+void spectrogram_push_gap();
+
+// The record appended last, for live streaming. Returns its size; 0 before
+// the first window.
+size_t spectrogram_last_record(uint8_t *out, size_t capacity);
+
+// Start a dump of the whole history, read with spectrogram_dump_read().
+void spectrogram_dump_start();
+
+// Copy the next whole records of a dump. Returns bytes copied; 0 once the
+// dump has caught up with the newest record (which ends it). If the ring
+// overwrote the unread part, the dump resumes at the oldest key frame.
+size_t spectrogram_dump_read(uint8_t *out, size_t capacity);
+
+// Decode one record in place of column (the previous column for a delta).
+// Returns the record size, or 0 if it is malformed or truncated.
+size_t spectrogram_decode_record(const uint8_t *record, size_t length,
+                                 uint8_t column[SPECTROGRAM_BINS]);
+
+// Bytes held in the ring
+size_t spectrogram_used_bytes();
@@ -0,0 +1,43 @@
+#pragma once
+#include <cstdint>
+
+// Hierarchical timer wheel: O(1) schedule/cancel, amortized O(1) expiry.
+// Four levels of 64 slots cover 2^24 ticks; later deadlines are parked in
+// the top level and re-placed as the wheel turns. Timers are intrusive
+// nodes owned by the caller, so the wheel itself never allocates.
+
+constexpr int TIMER_WHEEL_LEVELS    = 4;
+constexpr int TIMER_WHEEL_SLOT_BITS = 6;
+constexpr int TIMER_WHEEL_SLOTS     = 1 << TIMER_WHEEL_SLOT_BITS;
+
+struct TimerNode;
+typedef void (*TimerCallback)(TimerNode &node);
+
+struct TimerNode {
+    TimerNode *next;
+    TimerNode *prev;
+    uint32_t expires;        // absolute tick
+    TimerCallback callback;  // runs from timer_wheel_advance()
+    void *context;           // owner data for the callback
+};
+
+struct TimerWheel {
+    TimerNode slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];  // list heads
+    uint32_t now;       // next tick to process
+    uint32_t pending;   // scheduled timers
+};
+
+void timer_wheel_init(TimerWheel &wheel, uint32_t now);
+
+// Prepare a node; must be called once before first schedule
+void timer_node_init(TimerNode &node, TimerCallback callback, void *context);
+bool timer_node_pending(const TimerNode &node);
+
+// (Re)arm a node to fire at an absolute tick. Deadlines already in the
+// past fire on the next advance.
+void timer_wheel_schedule(TimerWheel &wheel, TimerNode &node, uint32_t expires);
+void timer_wheel_cancel(TimerWheel &wheel, TimerNode &node);
+
+// Run every timer due at or before `now`. Callbacks may re-schedule or
+// cancel any node, including their own.
+void timer_wheel_advance(TimerWheel &wheel, uint32_t now);
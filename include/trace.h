@@ -0,0 +1,74 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Timeline tracing of pipeline stages.
+// Each begin/end is one 8-byte record (microsecond timestamp, stage, phase, arg)
+// in a static ring that overwrites the oldest records, so tracing can stay
+// on in field builds: recording is a counter read and two stores, and only
+// the main thread records (no locking). tools/trace2chrome.py turns a dump
+// into Chrome/Perfetto trace JSON.
+
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED 1
+#endif
+#ifndef TRACE_BUFFER_EVENTS
+#define TRACE_BUFFER_EVENTS 512          // 4 KB; must be a power of two
+#endif
+
+enum TraceStage : uint8_t {
+    TRACE_ACQUISITION = 0,   // FIFO drain
+    TRACE_I2C,               // one bus transaction (arg = bytes, 0xFFFF = error)
+    TRACE_SPECTRAL,          // band analysis
+    TRACE_GAIT,              // gait_update()
+    TRACE_OUTPUT,            // console / export output
+    TRACE_SLEEP,             // waiting for the next FIFO watermark
+    TRACE_STAGE_COUNT
+};
+
+enum TracePhase : uint8_t {
+    TRACE_PHASE_BEGIN = 'B',
+    TRACE_PHASE_END   = 'E',
+    TRACE_PHASE_MARK  = 'i',
+};
+
+struct TraceEvent {
+    uint32_t timestamp_us;   // wraps after ~71 min
+    uint8_t  stage;
+    uint8_t  phase;
+    uint16_t arg;
+};
+
+void trace_init();
+void trace_record(TraceStage stage, TracePhase phase, uint16_t arg);
+
+// Timestamp ticks per second (1 MHz on every build)
+uint32_t trace_clock_hz();
+
+// Re-anchor the device timestamp to the low-power ticker; call after any
+// sleep, since the cycle counter behind it stops in Stop mode
+void trace_resync();
+
+// Freeze recording while a dump is in progress
+void trace_pause(bool paused);
+
+// Move up to max_events records, oldest first, out of the ring.
+// Returns 0 once the ring is empty.
+size_t trace_drain(TraceEvent *out, size_t max_events);
+
+// Records lost to ring overwrite since the ring was last emptied
+uint32_t trace_dropped();
+
+#if TRACE_ENABLED
+#define TRACE_BEGIN(stage)        trace_record((stage), TRACE_PHASE_BEGIN, 0)
+#define TRACE_END(stage)          trace_record((stage), TRACE_PHASE_END, 0)
+#define TRACE_END_ARG(stage, arg) trace_record((stage), TRACE_PHASE_END, (uint16_t)(arg))
+#define TRACE_MARK(stage, arg)    trace_record((stage), TRACE_PHASE_MARK, (uint16_t)(arg))
+#define TRACE_RESYNC()            trace_resync()
+#else
+#define TRACE_BEGIN(stage)        ((void)0)
+#define TRACE_END(stage)          ((void)0)
+#define TRACE_END_ARG(stage, arg) ((void)0)
+#define TRACE_MARK(stage, arg)    ((void)0)
+#define TRACE_RESYNC()            ((void)0)
+#endif
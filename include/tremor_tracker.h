@@ -0,0 +1,25 @@
+#pragma once
+
+// Per-sample tremor tracker: weighted-frequency Fourier linear combiner
+// (WFLC). A band-pass pre-filter isolates the tremor range, then a single
+// adaptive sinusoid locks onto it, giving instantaneous frequency and
+// amplitude at O(1) cost per sample. Intensity is the share of the
+// (DC-removed) signal power the tracked sinusoid explains, in percent, so
+// it can stand in for analyze_frequency_band() on the tremor band.
+// The tracker is locked while the sinusoid explains most of the
+// band-passed power (residual against band power, with hysteresis); until
+// then there is no oscillation to report and the estimate is all zeros.
+
+struct TremorEstimate {
+    float frequency_hz;   // tracked oscillation frequency, 0 until locked
+    float amplitude_g;    // tracked oscillation amplitude, 0 until locked
+    float intensity;      // 0-100 %, 0 when unlocked or outside the band
+    bool locked;
+};
+
+void tremor_tracker_init(float fs_hz, float band_low_hz, float band_high_hz);
+
+// Feed one acceleration magnitude sample (g)
+void tremor_tracker_update(float sample);
+
+TremorEstimate tremor_tracker_estimate();
@@ -0,0 +1,229 @@
+// CPython extension exposing the firmware's window detection core
+// (detect_core.cpp, the same code analyze_frequency_band() and
+// gait_update() run on the device) to NumPy with zero-copy batch APIs.
+//
+//   pip install ./python            (or: python python/setup.py build_ext --inplace)
+//
+//   import numpy as np, gaitmate_core
+//   samples = np.ascontiguousarray(acc, dtype=np.float32)   # (streams, T, 3) in g
+//   out = gaitmate_core.analyze(samples, threads=8)
+//   tremor = np.asarray(out["tremor"])                      # (streams, T // 156)
+//
+// Input is read in place through the buffer protocol, so any C-contiguous
+// float32 array works without a copy. The GIL is released while streams are
+// processed in parallel; every stream carries its own canceller, gait,
+// activity context and learned baselines from window to window, so the
+// detectors and thresholds follow the same policy detect_symptoms() does
+// on the device. Results are returned as
+// memoryviews over freshly allocated buffers; np.asarray() wraps them
+// without copying.
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include "detect_core.h"
+#include "spectral_kernels.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+static bool is_float32(const char *format) {
+    if (format == nullptr) return false;
+    if (format[0] == '<' || format[0] == '=' || format[0] == '@') format++;
+    return strcmp(format, "f") == 0;
+}
+
+struct Output {
+    const char *name;
+    const char *format;
+    size_t item;
+    PyObject *bytes;     // bytearray owning the data
+    char *data;
+};
+
+// memoryview of `bytes` cast to (streams, windows) with the given format
+static PyObject *shaped_view(PyObject *bytes, const char *format, Py_ssize_t streams,
+                             Py_ssize_t windows) {
+    PyObject *view = PyMemoryView_FromObject(bytes);
+    if (view == nullptr) return nullptr;
+    PyObject *shape = Py_BuildValue("(nn)", streams, windows);
+    PyObject *cast = shape ? PyObject_CallMethod(view, "cast", "sO", format, shape) : nullptr;
+    Py_XDECREF(shape);
+    Py_DECREF(view);
+    return cast;
+}
+
+static PyObject *analyze(PyObject *, PyObject *args, PyObject *kwargs) {
+    static const char *keywords[] = {"samples", "threads", nullptr};
+    PyObject *samples = nullptr;
+    int threads = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|i", (char **)keywords, &samples, &threads)) {
+        return nullptr;
+    }
+
+    Py_buffer view;
+    if (PyObject_GetBuffer(samples, &view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0) {
+        PyErr_SetString(PyExc_TypeError,
+                        "samples must be a C-contiguous float32 array (np.ascontiguousarray)");
+        return nullptr;
+    }
+    if (!is_float32(view.format) || view.ndim != 3 || view.shape[2] != 3) {
+        PyBuffer_Release(&view);
+        PyErr_SetString(PyExc_ValueError, "samples must be float32 with shape (streams, T, 3)");
+        return nullptr;
+    }
+    const Py_ssize_t streams = view.shape[0];
+    const Py_ssize_t windows = view.shape[1] / (Py_ssize_t)WINDOW_SAMPLES;
+    const Py_ssize_t stride = view.shape[1] * 3;    // floats per stream
+    const float *base = (const float *)view.buf;
+
+    Output outputs[] = {
+        {"tremor", "f", sizeof(float), nullptr, nullptr},
+        {"dyskinesia", "f", sizeof(float), nullptr, nullptr},
+        {"step_hz", "f", sizeof(float), nullptr, nullptr},
+        {"std_dev", "f", sizeof(float), nullptr, nullptr},
+        {"step_regularity", "f", sizeof(float), nullptr, nullptr},
+        {"step_symmetry", "f", sizeof(float), nullptr, nullptr},
+        {"tremor_coherence", "f", sizeof(float), nullptr, nullptr},
+        {"tremor_linearity", "f", sizeof(float), nullptr, nullptr},
+        {"fog_state", "B", 1, nullptr, nullptr},
+        {"activity", "B", 1, nullptr, nullptr},
+        {"tremor_detected", "?", 1, nullptr, nullptr},
+        {"dyskinesia_detected", "?", 1, nullptr, nullptr},
+        {"freezing_detected", "?", 1, nullptr, nullptr},
+    };
+    const size_t n_outputs = sizeof(outputs) / sizeof(outputs[0]);
+    const Py_ssize_t cells = streams * windows;
+    for (size_t i = 0; i < n_outputs; i++) {
+        outputs[i].bytes = PyByteArray_FromStringAndSize(nullptr, cells * outputs[i].item);
+        if (outputs[i].bytes == nullptr) {
+            for (size_t j = 0; j < i; j++) Py_DECREF(outputs[j].bytes);
+            PyBuffer_Release(&view);
+            return nullptr;
+        }
+        outputs[i].data = PyByteArray_AS_STRING(outputs[i].bytes);
+    }
+
+    float *tremor = (float *)outputs[0].data;
+    float *dyskinesia = (float *)outputs[1].data;
+    float *step_hz = (float *)outputs[2].data;
+    float *std_dev = (float *)outputs[3].data;
+    float *step_regularity = (float *)outputs[4].data;
+    float *step_symmetry = (float *)outputs[5].data;
+    float *tremor_coherence = (float *)outputs[6].data;
+    float *tremor_linearity = (float *)outputs[7].data;
+    uint8_t *fog_state = (uint8_t *)outputs[8].data;
+    uint8_t *activity = (uint8_t *)outputs[9].data;
+    bool *tremor_detected = (bool *)outputs[10].data;
+    bool *dyskinesia_detected = (bool *)outputs[11].data;
+    bool *freezing_detected = (bool *)outputs[12].data;
+
+    unsigned workers = threads > 0 ? (unsigned)threads : std::thread::hardware_concurrency();
+    if (workers == 0) workers = 1;
+    if ((Py_ssize_t)workers > streams) workers = streams > 0 ? (unsigned)streams : 1;
+
+    // Resolve the kernel table before the workers race for it
+    spectral_kernels();
+
+    Py_BEGIN_ALLOW_THREADS
+    std::atomic<Py_ssize_t> next_stream(0);
+    auto work = [&]() {
+        std::unique_ptr<DetectStream> state(new DetectStream);
+        for (;;) {
+            Py_ssize_t s = next_stream.fetch_add(1);
+            if (s >= streams) break;
+            detect_stream_init(*state);
+            const float *xyz = base + s * stride;
+            for (Py_ssize_t w = 0; w < windows; w++, xyz += WINDOW_SAMPLES * 3) {
+                DetectWindowResult r = detect_stream_window(*state, xyz, TIER_FULL);
+                Py_ssize_t k = s * windows + w;
+                tremor[k] = r.tremor_intensity;
+                dyskinesia[k] = r.dyskinesia_intensity;
+                step_hz[k] = r.step_hz;
+                std_dev[k] = r.std_dev;
+                step_regularity[k] = r.step_regularity;
+                step_symmetry[k] = r.step_symmetry;
+                tremor_coherence[k] = r.tremor_coherence;
+                tremor_linearity[k] = r.tremor_linearity;
+                fog_state[k] = r.fog_state;
+                activity[k] = r.activity;
+                tremor_detected[k] = r.tremor_detected;
+                dyskinesia_detected[k] = r.dyskinesia_detected;
+                freezing_detected[k] = r.freezing_detected;
+            }
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned i = 1; i < workers; i++) pool.emplace_back(work);
+    work();
+    for (auto &t : pool) t.join();
+    Py_END_ALLOW_THREADS
+
+    PyBuffer_Release(&view);
+
+    PyObject *result = PyDict_New();
+    bool ok = result != nullptr;
+    for (size_t i = 0; i < n_outputs; i++) {
+        if (ok) {
+            PyObject *mv = shaped_view(outputs[i].bytes, outputs[i].format, streams, windows);
+            ok = mv != nullptr && PyDict_SetItemString(result, outputs[i].name, mv) == 0;
+            Py_XDECREF(mv);
+        }
+        Py_DECREF(outputs[i].bytes);
+    }
+    if (!ok) {
+        Py_XDECREF(result);
+        return nullptr;
+    }
+    return result;
+}
+
+static PyObject *band_percent(PyObject *, PyObject *args) {
+    PyObject *data = nullptr;
+    float freq_low, freq_high;
+    if (!PyArg_ParseTuple(args, "Off", &data, &freq_low, &freq_high)) return nullptr;
+
+    Py_buffer view;
+    if (PyObject_GetBuffer(data, &view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0) return nullptr;
+    if (!is_float32(view.format) || view.len != (Py_ssize_t)(WINDOW_SAMPLES * sizeof(float))) {
+        PyBuffer_Release(&view);
+        PyErr_Format(PyExc_ValueError, "window must be %d contiguous float32 values",
+                     (int)WINDOW_SAMPLES);
+        return nullptr;
+    }
+    SpectralScratch scratch;
+    float percent = detect_band_percent((const float *)view.buf, freq_low, freq_high, scratch);
+    PyBuffer_Release(&view);
+    return PyFloat_FromDouble(percent);
+}
+
+static PyMethodDef methods[] = {
+    {"analyze", (PyCFunction)(void (*)(void))analyze, METH_VARARGS | METH_KEYWORDS,
+     "analyze(samples, threads=0) -> dict of (streams, windows) arrays\n\n"
+     "samples: float32 (streams, T, 3) acceleration in g at 52 Hz. Each stream\n"
+     "is cut into T // 156 consecutive 3 s windows and run through the\n"
+     "firmware detection core with per-stream state: activity context\n"
+     "(\"activity\": 0 lying, 1 sitting, 2 standing, 3 walking) and\n"
+     "thresholds learned from the stream's own baselines."},
+    {"band_percent", band_percent, METH_VARARGS,
+     "band_percent(window, freq_low, freq_high) -> float\n\n"
+     "analyze_frequency_band() on one 156-sample float32 window."},
+    {nullptr, nullptr, 0, nullptr}};
+
+static struct PyModuleDef module = {
+    PyModuleDef_HEAD_INIT, "gaitmate_core",
+    "GaitMate firmware detection core for batch analysis", -1, methods,
+    nullptr, nullptr, nullptr, nullptr};
+
+PyMODINIT_FUNC PyInit_gaitmate_core(void) {
+    PyObject *m = PyModule_Create(&module);
+    if (m == nullptr) return nullptr;
+    PyModule_AddIntConstant(m, "WINDOW_SAMPLES", (long)WINDOW_SAMPLES);
+    PyModule_AddObject(m, "SAMPLE_RATE", PyFloat_FromDouble(FS_HZ));
+    PyModule_AddStringConstant(m, "KERNEL", spectral_kernels().name);
+    return m;
+}
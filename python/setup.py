@@ -0,0 +1,29 @@
+# Build: pip install ./python   or   cd python && python setup.py build_ext --inplace
+import os
+
+from setuptools import Extension, setup
+
+# Firmware sources are shared with the device build, one level up
+os.chdir(os.path.dirname(os.path.abspath(__file__)))
+
+setup(
+    name="gaitmate_core",
+    version="0.1",
+    ext_modules=[
+        Extension(
+            "gaitmate_core",
+            sources=[
+                "gaitmate_core.cpp",
+                "../src/activity.cpp",
+                "../src/baseline.cpp",
+                "../src/detect_core.cpp",
+                "../src/harmonic_canceller.cpp",
+                "../src/spectral_backend.cpp",
+                "../src/spectral_kernels.cpp",
+            ],
+            include_dirs=["../include"],
+            extra_compile_args=["-std=gnu++14", "-O2"],
+            extra_link_args=["-pthread"],
+        )
+    ],
+)
@@ -0,0 +1,51 @@
+#pragma once
+// Host stand-in for the CMSIS-DSP functions the firmware uses.
+// Same output packing as arm_rfft_fast_f32: out[0] = X[0], out[1] = X[N/2],
+// then re/im pairs for bins 1..N/2-1.
+
+#include <cmath>
+#include <cstdint>
+
+typedef float float32_t;
+
+typedef enum {
+    ARM_MATH_SUCCESS = 0,
+    ARM_MATH_ARGUMENT_ERROR = -1,
+} arm_status;
+
+struct arm_rfft_fast_instance_f32 {
+    uint16_t fftLenRFFT;
+};
+
+inline arm_status arm_rfft_fast_init_f32(arm_rfft_fast_instance_f32 *s, uint16_t fft_len) {
+    if (fft_len < 32 || (fft_len & (fft_len - 1)) != 0) return ARM_MATH_ARGUMENT_ERROR;
+    s->fftLenRFFT = fft_len;
+    return ARM_MATH_SUCCESS;
+}
+
+// Direct DFT: exact and small enough for the window sizes used here
+inline void arm_rfft_fast_f32(const arm_rfft_fast_instance_f32 *s, float32_t *in,
+                              float32_t *out, uint8_t ifft_flag) {
+    const int n = s->fftLenRFFT;
+    const double w = 2.0 * M_PI / n;
+    if (!ifft_flag) {
+        for (int k = 0; k <= n / 2; k++) {
+            double re = 0.0, im = 0.0;
+            for (int t = 0; t < n; t++) {
+                re += in[t] * cos(w * k * t);
+                im -= in[t] * sin(w * k * t);
+            }
+            if (k == 0) out[0] = (float32_t)re;
+            else if (k == n / 2) out[1] = (float32_t)re;
+            else { out[2 * k] = (float32_t)re; out[2 * k + 1] = (float32_t)im; }
+        }
+    } else {
+        for (int t = 0; t < n; t++) {
+            double acc = in[0] + in[1] * ((t & 1) ? -1.0 : 1.0);
+            for (int k = 1; k < n / 2; k++) {
+                acc += 2.0 * (in[2 * k] * cos(w * k * t) - in[2 * k + 1] * sin(w * k * t));
+            }
+            out[t] = (float32_t)(acc / n);
+        }
+    }
+}
@@ -0,0 +1,13 @@
+#pragma once
+// In-memory KVStore for the host simulator (contents last one run)
+
+#include <cstddef>
+#include <cstdint>
+
+#define MBED_SUCCESS                0
+#define MBED_ERROR_ITEM_NOT_FOUND   (-311)
+#define MBED_ERROR_INVALID_SIZE     (-324)
+
+int kv_set(const char *full_name_key, const void *buffer, size_t size, uint32_t create_flags);
+int kv_get(const char *full_name_key, void *buffer, size_t buffer_size, size_t *actual_size);
+int kv_remove(const char *full_name_key);
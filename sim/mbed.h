@@ -0,0 +1,220 @@
+#pragma once
+// Host stand-in for the parts of mbed-os the firmware uses, driven by the
+// virtual clock in sim.h. Only the native_sim environment puts sim/ on the
+// include path.
+
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <sys/types.h>
+
+#include "sim.h"
+
+enum PinName {
+    NC = -1,
+    PB_10 = 0x1A, PB_11 = 0x1B,
+    PD_11 = 0x3B,
+    USBTX = 0x100, USBRX, LED1, LED2, LED3, BUTTON1,
+};
+
+uint32_t us_ticker_read();
+void wait_us(int us);
+
+struct mbed_stats_cpu_t {
+    uint64_t uptime;
+    uint64_t idle_time;
+    uint64_t sleep_time;
+    uint64_t deep_sleep_time;
+};
+void mbed_stats_cpu_get(mbed_stats_cpu_t *stats);
+
+// Bare-metal idle: sleep until the next interrupt. Interrupts only run
+// inside stand-in calls, so critical sections have nothing to mask.
+void sleep();
+inline void core_util_critical_section_enter() {}
+inline void core_util_critical_section_exit() {}
+
+namespace mbed {
+
+template <typename Signature> class Callback;
+template <typename R, typename... Args>
+class Callback<R(Args...)> : public std::function<R(Args...)> {
+public:
+    using std::function<R(Args...)>::function;
+};
+
+class FileHandle {
+public:
+    virtual ~FileHandle() {}
+    virtual ssize_t read(void *buffer, size_t size) = 0;
+    virtual ssize_t write(const void *buffer, size_t size) = 0;
+    virtual off_t seek(off_t offset, int whence = SEEK_SET) = 0;
+    virtual int close() = 0;
+    virtual int sync() { return 0; }
+    virtual int isatty() { return 0; }
+    virtual off_t tell() { return seek(0, SEEK_CUR); }
+    virtual void rewind() { seek(0, SEEK_SET); }
+    virtual off_t size() { return -EINVAL; }
+    virtual int set_blocking(bool blocking) { return blocking ? 0 : -ENOTTY; }
+    virtual bool is_blocking() const { return true; }
+};
+
+FileHandle *mbed_override_console(int fd);
+
+class I2C {
+public:
+    I2C(PinName sda, PinName scl);
+    void frequency(int hz);
+    int write(int address, const char *data, int length, bool repeated = false);
+    int read(int address, char *data, int length, bool repeated = false);
+
+private:
+    uint64_t transfer_us(int length) const;
+    int hz_;
+};
+
+class BufferedSerial : public FileHandle {
+public:
+    BufferedSerial(PinName tx, PinName rx, int baud = 9600);
+    ~BufferedSerial() override;
+    ssize_t read(void *buffer, size_t size) override;
+    ssize_t write(const void *buffer, size_t size) override;
+    off_t seek(off_t offset, int whence = SEEK_SET) override;
+    int close() override;
+    int isatty() override;
+    int sync() override;
+    void set_baud(int baud);
+    int enable_input(bool enabled);
+    int enable_output(bool enabled);
+
+private:
+    uint64_t byte_us() const;
+    uint32_t backlog(uint64_t now) const;
+    int baud_;
+    bool input_ = true;
+    bool output_ = true;
+    uint64_t tx_empty_at_ = 0;   // virtual time the TX ring drains
+};
+
+class DigitalOut {
+public:
+    DigitalOut(PinName pin, int value = 0) : pin_(pin), value_(value) {}
+    void write(int value) { value_ = value ? 1 : 0; }
+    int read() { return value_; }
+    DigitalOut &operator=(int value) { write(value); return *this; }
+    DigitalOut &operator=(DigitalOut &rhs) { write(rhs.read()); return *this; }
+    operator int() { return read(); }
+
+private:
+    PinName pin_;
+    int value_;
+};
+
+class InterruptIn {
+public:
+    InterruptIn(PinName pin);
+    void rise(Callback<void()> func);
+    void fall(Callback<void()> func);
+    void enable_irq() { enabled_ = true; }
+    void disable_irq() { enabled_ = false; }
+
+private:
+    void bind();
+    PinName pin_;
+    bool enabled_ = true;
+    Callback<void()> rise_;
+    Callback<void()> fall_;
+};
+
+class Ticker {
+public:
+    ~Ticker();
+    void attach(Callback<void()> func, std::chrono::microseconds period);
+    void attach(Callback<void()> func, float seconds) {
+        attach(func, std::chrono::microseconds((int64_t)(seconds * 1e6f)));
+    }
+    void attach_us(Callback<void()> func, uint32_t us) {
+        attach(func, std::chrono::microseconds(us));
+    }
+    void detach();
+
+private:
+    void arm(uint64_t at);
+    Callback<void()> func_;
+    uint64_t period_us_ = 0;
+    std::shared_ptr<bool> alive_;
+};
+
+// One-shot; like the low-power ticker it holds no deep-sleep lock
+class LowPowerTimeout {
+public:
+    ~LowPowerTimeout();
+    void attach(Callback<void()> func, std::chrono::microseconds delay);
+    void detach();
+
+private:
+    Callback<void()> func_;
+    std::shared_ptr<bool> alive_;
+};
+
+class Timer {
+public:
+    void start();
+    void stop();
+    void reset();
+    std::chrono::microseconds elapsed_time() const;
+    int read_us() const { return (int)elapsed_time().count(); }
+    int read_ms() const { return (int)(elapsed_time().count() / 1000); }
+
+private:
+    bool running_ = false;
+    uint64_t start_us_ = 0;
+    uint64_t accumulated_us_ = 0;
+};
+
+} // namespace mbed
+
+namespace rtos {
+
+namespace Kernel {
+struct Clock {
+    using duration = std::chrono::milliseconds;
+    using rep = duration::rep;
+    using period = duration::period;
+    using time_point = std::chrono::time_point<Clock>;
+    static constexpr bool is_steady = true;
+    static time_point now();
+};
+} // namespace Kernel
+
+namespace ThisThread {
+void sleep_for(std::chrono::microseconds duration);
+inline void sleep_for(uint32_t ms) { sleep_for(std::chrono::milliseconds(ms)); }
+} // namespace ThisThread
+
+static constexpr uint32_t osFlagsError = 0x80000000u;
+static constexpr uint32_t osFlagsErrorTimeout = 0xFFFFFFFEu;
+
+class EventFlags {
+public:
+    uint32_t set(uint32_t flags);
+    uint32_t clear(uint32_t flags = 0x7FFFFFFF);
+    uint32_t get() const { return flags_; }
+    uint32_t wait_any_for(uint32_t flags, std::chrono::microseconds timeout, bool clear = true);
+    uint32_t wait_any(uint32_t flags, bool clear = true);
+
+private:
+    uint32_t flags_ = 0;
+};
+
+} // namespace rtos
+
+using namespace mbed;
+using namespace rtos;
+using namespace std;
+using namespace std::chrono_literals;
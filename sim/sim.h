@@ -0,0 +1,112 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Discrete-event core of the host simulator.
+// Virtual time only moves when the firmware calls into the mbed stand-in:
+// blocking calls (sleep, event-flag waits, UART backpressure) jump to the
+// next event, bus transfers advance by their modelled latency, and host CPU
+// time spent in firmware code between calls is charged scaled by cpu_scale.
+
+struct SimConfig {
+    double   duration_s = 3600.0;        // virtual run time
+    double   cpu_scale = 25.0;           // device time per host time in firmware code
+    uint32_t i2c_overhead_us = 20;       // per-transfer setup on top of bit time
+    double   i2c_error_rate = 0.0;       // NACK probability per transfer
+    double   odr_error_ppm = 0.0;        // sensor clock error vs. nominal ODR
+    double   motion_scale = 1.0;         // wearer movement gain (gravity unscaled)
+    double   walk_hz = 1.8;              // walking phase cadence (steps/s)
+    double   walk_harmonic_g = 0.10;     // vertical 2nd-harmonic amplitude while walking
+    uint32_t uart_tx_buffer = 256;       // BufferedSerial TX ring size
+    uint32_t seed = 1;
+    bool     quiet = false;              // drop firmware console output
+    bool     strict = false;             // non-zero exit on timing violations
+    std::vector<double> button_presses;  // virtual seconds
+};
+
+struct SimStats {
+    // Throughput
+    uint64_t samples_generated = 0;
+    uint64_t samples_lost = 0;           // overwritten in the sensor FIFO
+    uint64_t i2c_transfers = 0;
+    uint64_t i2c_errors = 0;
+    uint64_t i2c_busy_us = 0;
+    uint64_t uart_bytes = 0;
+    // Timing
+    uint64_t uart_blocked_us = 0;
+    uint64_t uart_blocked_max_us = 0;
+    uint64_t watermark_irqs = 0;
+    uint64_t watermark_late = 0;         // serviced after the next batch was due
+    uint64_t watermark_latency_max_us = 0;
+    uint64_t compute_max_us = 0;         // longest charged stretch of firmware code
+    uint64_t firmware_warnings = 0;      // "WARN" lines on the console
+    std::vector<std::string> first_warnings;
+    // Power
+    uint64_t sleep_us = 0;
+    uint64_t deep_sleep_us = 0;
+};
+
+typedef uint64_t SimEventId;
+
+void sim_init(const SimConfig &config);
+const SimConfig &sim_config();
+SimStats &sim_stats();
+uint64_t sim_now_us();
+
+// Run fn at virtual time at_us (interrupt context: must not block)
+SimEventId sim_schedule(uint64_t at_us, std::function<void()> fn);
+void sim_cancel(SimEventId id);
+
+// Every stand-in API brackets its work with these. On entry from thread
+// context the host CPU time spent in firmware code since the last call is
+// charged (scaled by cpu_scale); interrupt handlers are not charged.
+void sim_enter();
+void sim_exit();
+
+struct SimCall {
+    SimCall() { sim_enter(); }
+    ~SimCall() { sim_exit(); }
+};
+
+// Firmware is busy (e.g. a blocking bus transfer) for duration_us;
+// interrupts due meanwhile still run
+void sim_busy(uint64_t duration_us);
+
+// Firmware is idle until ready() or the timeout; the time counts as sleep,
+// deep sleep unless a driver holds the deep-sleep lock. Returns ready().
+bool sim_idle(uint64_t timeout_us, const std::function<bool()> &ready);
+
+// Firmware is idle until the next scheduled event (WFI)
+void sim_sleep();
+
+// Deep-sleep locks held by drivers (active tickers, UART RX/TX)
+void sim_deep_sleep_lock();
+void sim_deep_sleep_unlock();
+// Time until which an in-flight UART transmission keeps the lock
+void sim_set_uart_busy_until(uint64_t t_us);
+
+// Pins: InterruptIn registers edge handlers, models drive levels
+typedef int SimPin;
+void sim_pin_set_handlers(SimPin pin, std::function<void()> rise, std::function<void()> fall);
+void sim_pin_write(SimPin pin, int level);
+
+// I2C bus: devices answer by 8-bit address. Return 0 on ACK.
+struct SimI2CDevice {
+    virtual ~SimI2CDevice() {}
+    virtual int write(const uint8_t *data, int length) = 0;
+    virtual int read(uint8_t *data, int length) = 0;
+};
+void sim_i2c_attach(int address, SimI2CDevice *device);
+SimI2CDevice *sim_i2c_device(int address);
+double sim_random();     // uniform [0,1), seeded
+
+// Console bytes leaving the UART (after modelled transmission)
+void sim_console_output(const char *data, size_t length);
+
+// Device models
+void sim_lsm6dsl_start(SimPin int1_pin);
+
+// Print the report and exit; called when virtual time reaches the end
+[[noreturn]] void sim_finish();
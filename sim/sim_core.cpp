@@ -0,0 +1,246 @@
+#include "sim.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <queue>
+#include <unordered_set>
+#include <unistd.h>
+
+using HostClock = std::chrono::steady_clock;
+
+namespace {
+
+struct Event {
+    uint64_t time_us;
+    SimEventId id;
+    std::function<void()> fn;
+};
+
+struct EventLater {
+    bool operator()(const Event &a, const Event &b) const {
+        return a.time_us != b.time_us ? a.time_us > b.time_us : a.id > b.id;
+    }
+};
+
+struct PinState {
+    int level = 0;
+    std::function<void()> rise;
+    std::function<void()> fall;
+};
+
+SimConfig config;
+SimStats stats;
+uint64_t now_us = 0;
+uint64_t end_us = 0;
+SimEventId next_id = 1;
+std::priority_queue<Event, std::vector<Event>, EventLater> queue;
+std::unordered_set<SimEventId> cancelled;
+
+int call_depth = 0;
+int isr_depth = 0;
+HostClock::time_point host_mark;
+HostClock::time_point host_start;
+
+int deep_sleep_locks = 0;
+uint64_t uart_busy_until = 0;
+
+uint64_t rng_state = 1;
+
+std::string console_line;
+FILE *host_console = nullptr;   // the real stdout; firmware stdout goes via the UART
+
+// Function-local so drivers constructed during static init can register
+std::map<SimPin, PinState> &pins() {
+    static std::map<SimPin, PinState> table;
+    return table;
+}
+
+std::map<int, SimI2CDevice *> &i2c_devices() {
+    static std::map<int, SimI2CDevice *> table;
+    return table;
+}
+
+// Run every event due at or before t (clamped to the end of the run)
+void run_until(uint64_t t) {
+    uint64_t limit = std::min(t, end_us);
+    while (!queue.empty() && queue.top().time_us <= limit) {
+        Event ev = queue.top();
+        queue.pop();
+        if (cancelled.erase(ev.id)) continue;
+        now_us = std::max(now_us, ev.time_us);
+        isr_depth++;
+        ev.fn();
+        isr_depth--;
+    }
+    now_us = std::max(now_us, limit);
+    if (now_us >= end_us) sim_finish();
+}
+
+void account_sleep(uint64_t from, uint64_t to) {
+    if (to <= from) return;
+    uint64_t light_until = from;
+    if (deep_sleep_locks > 0) {
+        light_until = to;
+    } else if (uart_busy_until > from) {
+        light_until = std::min(uart_busy_until, to);
+    }
+    stats.sleep_us += light_until - from;
+    stats.deep_sleep_us += to - light_until;
+}
+
+} // namespace
+
+void sim_init(const SimConfig &c) {
+    config = c;
+    end_us = (uint64_t)(c.duration_s * 1e6);
+    rng_state = c.seed ? c.seed : 1;
+    host_start = host_mark = HostClock::now();
+    host_console = fdopen(dup(STDOUT_FILENO), "w");
+}
+
+const SimConfig &sim_config() { return config; }
+SimStats &sim_stats() { return stats; }
+uint64_t sim_now_us() { return now_us; }
+
+SimEventId sim_schedule(uint64_t at_us, std::function<void()> fn) {
+    SimEventId id = next_id++;
+    queue.push(Event{std::max(at_us, now_us), id, std::move(fn)});
+    return id;
+}
+
+void sim_cancel(SimEventId id) {
+    cancelled.insert(id);
+}
+
+void sim_enter() {
+    if (call_depth++ > 0 || isr_depth > 0) return;
+    double host_us = std::chrono::duration<double, std::micro>(HostClock::now() - host_mark).count();
+    uint64_t charged = (uint64_t)(host_us * config.cpu_scale);
+    stats.compute_max_us = std::max(stats.compute_max_us, charged);
+    if (charged > 0) run_until(now_us + charged);
+}
+
+void sim_exit() {
+    if (--call_depth == 0 && isr_depth == 0) host_mark = HostClock::now();
+}
+
+void sim_busy(uint64_t duration_us) {
+    run_until(now_us + duration_us);
+}
+
+bool sim_idle(uint64_t timeout_us, const std::function<bool()> &ready) {
+    const uint64_t deadline = now_us + timeout_us;
+    while (!ready()) {
+        if (now_us >= deadline) return false;
+        uint64_t next = deadline;
+        if (!queue.empty()) next = std::min(next, queue.top().time_us);
+        account_sleep(now_us, std::min(next, end_us));
+        run_until(next);
+    }
+    return true;
+}
+
+void sim_sleep() {
+    uint64_t next = end_us;
+    if (!queue.empty()) next = std::min(next, queue.top().time_us);
+    account_sleep(now_us, next);
+    run_until(next);
+}
+
+void sim_deep_sleep_lock() { deep_sleep_locks++; }
+void sim_deep_sleep_unlock() { if (deep_sleep_locks > 0) deep_sleep_locks--; }
+void sim_set_uart_busy_until(uint64_t t_us) { uart_busy_until = std::max(uart_busy_until, t_us); }
+
+void sim_pin_set_handlers(SimPin pin, std::function<void()> rise, std::function<void()> fall) {
+    PinState &p = pins()[pin];
+    p.rise = std::move(rise);
+    p.fall = std::move(fall);
+}
+
+void sim_pin_write(SimPin pin, int level) {
+    PinState &p = pins()[pin];
+    level = level ? 1 : 0;
+    if (level == p.level) return;
+    p.level = level;
+    const std::function<void()> &handler = level ? p.rise : p.fall;
+    if (handler) {
+        isr_depth++;
+        handler();
+        isr_depth--;
+    }
+}
+
+void sim_i2c_attach(int address, SimI2CDevice *device) {
+    i2c_devices()[address] = device;
+}
+
+SimI2CDevice *sim_i2c_device(int address) {
+    auto it = i2c_devices().find(address);
+    return it == i2c_devices().end() ? nullptr : it->second;
+}
+
+double sim_random() {
+    // xorshift64*: reproducible for a given seed
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return (double)((rng_state * 2685821657736338717ULL) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+void sim_console_output(const char *data, size_t length) {
+    if (!config.quiet && host_console) fwrite(data, 1, length, host_console);
+    for (size_t i = 0; i < length; i++) {
+        char c = data[i];
+        if (c == '\n') {
+            if (console_line.find("WARN") != std::string::npos) {
+                stats.firmware_warnings++;
+                if (stats.first_warnings.size() < 5) {
+                    stats.first_warnings.push_back(console_line);
+                }
+            }
+            console_line.clear();
+        } else if (c != '\r') {
+            console_line += c;
+        }
+    }
+}
+
+void sim_finish() {
+    const double virtual_s = now_us / 1e6;
+    const double host_s = std::chrono::duration<double>(HostClock::now() - host_start).count();
+    const uint64_t violations = stats.samples_lost + stats.watermark_late + stats.firmware_warnings;
+
+    fflush(stdout);
+    if (host_console) fflush(host_console);
+    FILE *out = stderr;
+    fprintf(out, "\n=== Simulation report ===\n");
+    fprintf(out, "virtual time  %.1f s in %.2f s host (%.0fx)\n",
+            virtual_s, host_s, host_s > 0 ? virtual_s / host_s : 0.0);
+    fprintf(out, "samples       %llu generated, %llu lost to FIFO overwrite\n",
+            (unsigned long long)stats.samples_generated, (unsigned long long)stats.samples_lost);
+    fprintf(out, "watermark     %llu IRQs, %llu serviced late, max latency %.1f ms\n",
+            (unsigned long long)stats.watermark_irqs, (unsigned long long)stats.watermark_late,
+            stats.watermark_latency_max_us / 1e3);
+    fprintf(out, "i2c           %llu transfers, %llu errors, bus busy %.2f%%\n",
+            (unsigned long long)stats.i2c_transfers, (unsigned long long)stats.i2c_errors,
+            virtual_s > 0 ? 100.0 * stats.i2c_busy_us / now_us : 0.0);
+    fprintf(out, "uart          %llu bytes (%.1f B/s), blocked %.1f ms total, %.1f ms max\n",
+            (unsigned long long)stats.uart_bytes, virtual_s > 0 ? stats.uart_bytes / virtual_s : 0.0,
+            stats.uart_blocked_us / 1e3, stats.uart_blocked_max_us / 1e3);
+    fprintf(out, "compute       longest stretch %.2f ms (cpu scale %.1f)\n",
+            stats.compute_max_us / 1e3, config.cpu_scale);
+    fprintf(out, "sleep         light %.1f%%, deep %.1f%%\n",
+            now_us ? 100.0 * stats.sleep_us / now_us : 0.0,
+            now_us ? 100.0 * stats.deep_sleep_us / now_us : 0.0);
+    fprintf(out, "warnings      %llu firmware WARN lines\n", (unsigned long long)stats.firmware_warnings);
+    for (const std::string &w : stats.first_warnings) {
+        fprintf(out, "              %s\n", w.c_str());
+    }
+    fprintf(out, "violations    %llu\n", (unsigned long long)violations);
+    fflush(out);
+
+    _Exit(config.strict && violations > 0 ? 2 : 0);
+}
@@ -0,0 +1,243 @@
+// LSM6DSL accelerometer model: register file, FIFO with watermark on INT1,
+// and a synthetic wearer cycling through rest, tremor, walking and
+// dyskinesia. Walking cadence and its 2nd harmonic are configurable. Only the accelerometer path the firmware uses is modelled;
+// the FIFO is assumed to run at the accelerometer ODR.
+
+#include "sim.h"
+
+#include <cmath>
+#include <cstring>
+#include <deque>
+
+namespace {
+
+constexpr int      ADDRESS = 0x6A << 1;
+constexpr uint8_t  REG_WHO_AM_I = 0x0F;
+constexpr uint8_t  REG_CTRL1_XL = 0x10;
+constexpr uint8_t  REG_CTRL3_C = 0x12;
+constexpr uint8_t  REG_FIFO_CTRL1 = 0x06;
+constexpr uint8_t  REG_FIFO_CTRL2 = 0x07;
+constexpr uint8_t  REG_FIFO_CTRL3 = 0x08;
+constexpr uint8_t  REG_FIFO_CTRL5 = 0x0A;
+constexpr uint8_t  REG_INT1_CTRL = 0x0D;
+constexpr uint8_t  REG_OUTX_L_XL = 0x28;
+constexpr uint8_t  REG_FIFO_STATUS1 = 0x3A;
+constexpr uint8_t  REG_FIFO_STATUS2 = 0x3B;
+constexpr uint8_t  REG_FIFO_DATA_OUT_L = 0x3E;
+constexpr uint8_t  REG_FIFO_DATA_OUT_H = 0x3F;
+constexpr size_t   FIFO_WORDS = 2048;          // 4 KB
+constexpr double   PHASE_S = 120.0;           // length of each scenario phase
+
+const float ODR_HZ[16] = {0, 12.5f, 26, 52, 104, 208, 416, 833, 1666, 3332, 6664, 1.6f, 0, 0, 0, 0};
+const float MG_PER_LSB[4] = {0.061f, 0.488f, 0.122f, 0.244f};   // FS_XL 2/16/4/8 g
+
+class Lsm6dsl : public SimI2CDevice {
+public:
+    explicit Lsm6dsl(SimPin int1) : int1_(int1) {
+        memset(regs_, 0, sizeof(regs_));
+        regs_[REG_WHO_AM_I] = 0x6A;
+        regs_[REG_CTRL3_C] = 0x04;     // IF_INC
+    }
+
+    int write(const uint8_t *data, int length) override {
+        if (length < 1) return 0;
+        pointer_ = data[0];
+        for (int i = 1; i < length; i++) {
+            write_register(pointer_, data[i]);
+            advance();
+        }
+        return 0;
+    }
+
+    int read(uint8_t *data, int length) override {
+        for (int i = 0; i < length; i++) {
+            data[i] = read_register(pointer_);
+            advance();
+        }
+        return 0;
+    }
+
+private:
+    void advance() {
+        if (pointer_ == REG_FIFO_DATA_OUT_H) pointer_ = REG_FIFO_DATA_OUT_L;   // FIFO reads roll over
+        else if (regs_[REG_CTRL3_C] & 0x04) pointer_++;
+    }
+
+    void write_register(uint8_t reg, uint8_t value) {
+        regs_[reg & 0x7F] = value;
+        if (reg == REG_FIFO_CTRL5 && (value & 0x07) == 0) {
+            fifo_.clear();         // bypass mode flushes
+            head_word_ = 0;
+            overrun_ = false;
+        }
+        if (reg == REG_CTRL1_XL) reschedule();
+        update_int1();
+    }
+
+    uint8_t read_register(uint8_t reg) {
+        reg &= 0x7F;
+        const uint16_t words = (uint16_t)fifo_.size();
+        switch (reg) {
+        case REG_FIFO_STATUS1:
+            return words & 0xFF;
+        case REG_FIFO_STATUS2: {
+            uint8_t v = (words >> 8) & 0x07;
+            if (words >= watermark() && watermark() > 0) v |= 0x80;
+            if (overrun_) v |= 0x40;
+            if (words + 3u > FIFO_WORDS) v |= 0x20;
+            if (words == 0) v |= 0x10;
+            overrun_ = false;
+            return v;
+        }
+        case REG_FIFO_STATUS1 + 2:
+            return head_word_ & 0xFF;
+        case REG_FIFO_STATUS1 + 3:
+            return 0;
+        case REG_FIFO_DATA_OUT_L:
+            return fifo_.empty() ? 0 : (uint8_t)(fifo_.front() & 0xFF);
+        case REG_FIFO_DATA_OUT_H: {
+            if (fifo_.empty()) return 0;
+            uint8_t v = (uint8_t)((uint16_t)fifo_.front() >> 8);
+            pop_word();
+            update_int1();
+            return v;
+        }
+        default:
+            return regs_[reg];
+        }
+    }
+
+    uint16_t watermark() const {
+        return regs_[REG_FIFO_CTRL1] | ((regs_[REG_FIFO_CTRL2] & 0x07) << 8);
+    }
+
+    bool fifo_enabled() const {
+        uint8_t mode = regs_[REG_FIFO_CTRL5] & 0x07;
+        return mode != 0 && (regs_[REG_FIFO_CTRL5] >> 3) != 0 && (regs_[REG_FIFO_CTRL3] & 0x07) != 0;
+    }
+
+    void pop_word() {
+        fifo_.pop_front();
+        head_word_ = (head_word_ + 1) % 3;
+    }
+
+    void reschedule() {
+        float odr = ODR_HZ[regs_[REG_CTRL1_XL] >> 4];
+        if (odr == period_hz_) return;
+        period_hz_ = odr;
+        generation_++;
+        if (odr <= 0) return;
+        period_us_ = 1e6 / odr * (1.0 + sim_config().odr_error_ppm * 1e-6);
+        next_us_ = (double)sim_now_us() + period_us_;
+        schedule_next(generation_);
+    }
+
+    void schedule_next(uint32_t generation) {
+        sim_schedule((uint64_t)next_us_, [this, generation] {
+            if (generation != generation_) return;
+            sample();
+            next_us_ += period_us_;
+            schedule_next(generation);
+        });
+    }
+
+    void sample() {
+        float g[3];
+        wearer(sim_now_us() / 1e6, g);
+        const float lsb = MG_PER_LSB[(regs_[REG_CTRL1_XL] >> 2) & 0x03] / 1000.0f;
+        int16_t raw[3];
+        for (int i = 0; i < 3; i++) {
+            float v = g[i] / lsb;
+            raw[i] = (int16_t)(v > 32767.0f ? 32767 : v < -32768.0f ? -32768 : lroundf(v));
+            regs_[REG_OUTX_L_XL + 2 * i] = raw[i] & 0xFF;
+            regs_[REG_OUTX_L_XL + 2 * i + 1] = (uint16_t)raw[i] >> 8;
+        }
+        SimStats &s = sim_stats();
+        s.samples_generated++;
+        if (!fifo_enabled()) return;
+
+        const bool stop_when_full = (regs_[REG_FIFO_CTRL5] & 0x07) == 1;
+        if (fifo_.size() + 3 > FIFO_WORDS) {
+            overrun_ = true;
+            s.samples_lost++;
+            if (stop_when_full) return;
+            for (int i = 0; i < 3; i++) pop_word();
+        }
+        for (int i = 0; i < 3; i++) fifo_.push_back(raw[i]);
+        update_int1();
+    }
+
+    // INT1 follows the watermark flag; the time it stays high is how long
+    // the firmware took to service the batch
+    void update_int1() {
+        bool level = (regs_[REG_INT1_CTRL] & 0x08) && watermark() > 0 &&
+                     fifo_.size() >= watermark();
+        if (level == int1_level_) return;
+        int1_level_ = level;
+        SimStats &s = sim_stats();
+        if (level) {
+            int1_rise_us_ = sim_now_us();
+            s.watermark_irqs++;
+        } else if (period_hz_ > 0) {
+            uint64_t latency = sim_now_us() - int1_rise_us_;
+            uint64_t batch_us = (uint64_t)(watermark() / 3 * 1e6 / period_hz_);
+            if (latency > s.watermark_latency_max_us) s.watermark_latency_max_us = latency;
+            if (latency > batch_us) s.watermark_late++;
+        }
+        sim_pin_write(int1_, level);
+    }
+
+    // Gravity on z plus the activity of the current scenario phase (g)
+    void wearer(double t, float g[3]) {
+        const double w = 2.0 * M_PI;
+        double x = 0.0, y = 0.0, z = 0.0;
+        switch ((int)(t / PHASE_S) % 4) {
+        case 0:                                   // resting
+            break;
+        case 1:                                   // 4.5 Hz rest tremor
+            x += 0.12 * sin(w * 4.5 * t);
+            y += 0.05 * sin(w * 4.5 * t + 1.0);
+            break;
+        case 2: {                                 // walking, 1.8 steps/s by default
+            double ph = w * sim_config().walk_hz * t;
+            z += 0.30 * sin(ph) + sim_config().walk_harmonic_g * sin(2 * ph + 0.5);
+            x += 0.15 * sin(ph / 2);
+            break;
+        }
+        case 3:                                   // dyskinesia: irregular 5.5-6.5 Hz
+            x += 0.20 * sin(w * (6.0 + 0.5 * sin(w * 0.2 * t)) * t);
+            z += 0.10 * sin(w * 5.7 * t + 0.3);
+            break;
+        }
+        const double k = sim_config().motion_scale;
+        g[0] = (float)(k * x + noise());
+        g[1] = (float)(k * y + noise());
+        g[2] = (float)(1.0 + k * z + noise());
+    }
+
+    double noise() {
+        // Box-Muller, ~5 mg RMS
+        double u1 = sim_random() + 1e-12, u2 = sim_random();
+        return 0.005 * sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+    }
+
+    SimPin int1_;
+    uint8_t regs_[128];
+    uint8_t pointer_ = 0;
+    std::deque<int16_t> fifo_;
+    uint8_t head_word_ = 0;      // pattern position of the oldest word (0 = x)
+    bool overrun_ = false;
+    bool int1_level_ = false;
+    uint64_t int1_rise_us_ = 0;
+    float period_hz_ = 0.0f;
+    double period_us_ = 0.0;
+    double next_us_ = 0.0;
+    uint32_t generation_ = 0;
+};
+
+} // namespace
+
+void sim_lsm6dsl_start(SimPin int1_pin) {
+    static Lsm6dsl device(int1_pin);
+    sim_i2c_attach(ADDRESS, &device);
+}
@@ -0,0 +1,75 @@
+// Host entry point: runs the unmodified firmware main() (built as
+// firmware_main by the native_sim environment) against the virtual clock.
+//
+//   sim [--duration=S] [--cpu-scale=X] [--i2c-overhead-us=N]
+//       [--i2c-error-rate=P] [--odr-error-ppm=N] [--motion-scale=X] [--uart-tx-buffer=N]
+//       [--walk-hz=F] [--walk-harmonic=G]
+//       [--button=S]... [--seed=N] [--quiet] [--strict]
+
+#include "parkinsons_system.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <stdio.h>
+#include <unistd.h>
+
+#undef main
+int firmware_main();
+
+// stdout is re-pointed at the firmware console so printf pays the UART cost
+static ssize_t console_write(void *cookie, const char *buffer, size_t size) {
+    ssize_t n = static_cast<FileHandle *>(cookie)->write(buffer, size);
+    return n < 0 ? 0 : n;
+}
+
+static bool parse_option(const char *arg, const char *name, const char **value) {
+    size_t n = strlen(name);
+    if (strncmp(arg, name, n) != 0 || arg[n] != '=') return false;
+    *value = arg + n + 1;
+    return true;
+}
+
+int main(int argc, char **argv) {
+    SimConfig config;
+    for (int i = 1; i < argc; i++) {
+        const char *v;
+        if (parse_option(argv[i], "--duration", &v))             config.duration_s = atof(v);
+        else if (parse_option(argv[i], "--cpu-scale", &v))       config.cpu_scale = atof(v);
+        else if (parse_option(argv[i], "--i2c-overhead-us", &v)) config.i2c_overhead_us = (uint32_t)atoi(v);
+        else if (parse_option(argv[i], "--i2c-error-rate", &v))  config.i2c_error_rate = atof(v);
+        else if (parse_option(argv[i], "--odr-error-ppm", &v))   config.odr_error_ppm = atof(v);
+        else if (parse_option(argv[i], "--motion-scale", &v))    config.motion_scale = atof(v);
+        else if (parse_option(argv[i], "--walk-hz", &v))         config.walk_hz = atof(v);
+        else if (parse_option(argv[i], "--walk-harmonic", &v))   config.walk_harmonic_g = atof(v);
+        else if (parse_option(argv[i], "--uart-tx-buffer", &v))  config.uart_tx_buffer = (uint32_t)atoi(v);
+        else if (parse_option(argv[i], "--button", &v))          config.button_presses.push_back(atof(v));
+        else if (parse_option(argv[i], "--seed", &v))            config.seed = (uint32_t)atoi(v);
+        else if (strcmp(argv[i], "--quiet") == 0)                config.quiet = true;
+        else if (strcmp(argv[i], "--strict") == 0)               config.strict = true;
+        else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    sim_init(config);
+    sim_lsm6dsl_start(IMU_INT1_PIN);
+
+    // 50 ms presses on the user button
+    for (double t : config.button_presses) {
+        uint64_t at = (uint64_t)(t * 1e6);
+        sim_schedule(at, [] { sim_pin_write(BUTTON1, 0); });
+        sim_schedule(at + 50000, [] { sim_pin_write(BUTTON1, 1); });
+    }
+
+    FileHandle *console = mbed::mbed_override_console(STDOUT_FILENO);
+    if (console) {
+        cookie_io_functions_t io = {nullptr, console_write, nullptr, nullptr};
+        FILE *f = fopencookie(console, "w", io);
+        setvbuf(f, nullptr, _IOLBF, 256);
+        stdout = f;
+    }
+
+    firmware_main();
+    sim_finish();
+}
@@ -0,0 +1,346 @@
+// mbed-os API stand-in on the virtual clock (see sim.h)
+
+#include "mbed.h"
+#include "kvstore_global_api.h"
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+uint32_t us_ticker_read() {
+    SimCall call;
+    return (uint32_t)sim_now_us();
+}
+
+void wait_us(int us) {
+    SimCall call;
+    sim_busy(us > 0 ? (uint64_t)us : 0);
+}
+
+void mbed_stats_cpu_get(mbed_stats_cpu_t *stats) {
+    SimCall call;
+    const SimStats &s = sim_stats();
+    stats->uptime = sim_now_us();
+    stats->idle_time = s.sleep_us + s.deep_sleep_us;
+    stats->sleep_time = s.sleep_us;
+    stats->deep_sleep_time = s.deep_sleep_us;
+}
+
+namespace mbed {
+
+__attribute__((weak)) FileHandle *mbed_override_console(int) {
+    return nullptr;
+}
+
+// ---------------------------------------------------------------- I2C
+I2C::I2C(PinName, PinName) : hz_(100000) {}
+
+void I2C::frequency(int hz) {
+    hz_ = hz > 0 ? hz : 100000;
+}
+
+// Address byte plus data, 9 clocks each, plus driver/start/stop overhead
+uint64_t I2C::transfer_us(int length) const {
+    return sim_config().i2c_overhead_us + (uint64_t)(length + 1) * 9 * 1000000 / hz_;
+}
+
+int I2C::write(int address, const char *data, int length, bool repeated) {
+    (void)repeated;
+    SimCall call;
+    SimStats &s = sim_stats();
+    SimI2CDevice *dev = sim_i2c_device(address);
+    bool nack = dev == nullptr || sim_random() < sim_config().i2c_error_rate;
+    uint64_t cost = transfer_us(nack ? 0 : length);
+    s.i2c_transfers++;
+    s.i2c_busy_us += cost;
+    sim_busy(cost);
+    if (nack || dev->write((const uint8_t *)data, length) != 0) {
+        s.i2c_errors++;
+        return -1;
+    }
+    return 0;
+}
+
+int I2C::read(int address, char *data, int length, bool repeated) {
+    (void)repeated;
+    SimCall call;
+    SimStats &s = sim_stats();
+    SimI2CDevice *dev = sim_i2c_device(address);
+    bool nack = dev == nullptr || sim_random() < sim_config().i2c_error_rate;
+    uint64_t cost = transfer_us(nack ? 0 : length);
+    s.i2c_transfers++;
+    s.i2c_busy_us += cost;
+    sim_busy(cost);
+    if (nack || dev->read((uint8_t *)data, length) != 0) {
+        s.i2c_errors++;
+        return -1;
+    }
+    return 0;
+}
+
+// ------------------------------------------------------ BufferedSerial
+BufferedSerial::BufferedSerial(PinName, PinName, int baud) : baud_(baud) {
+    sim_deep_sleep_lock();     // RX enabled by default
+}
+
+BufferedSerial::~BufferedSerial() {
+    if (input_) sim_deep_sleep_unlock();
+}
+
+uint64_t BufferedSerial::byte_us() const {
+    return (10ULL * 1000000 + baud_ - 1) / baud_;   // 8N1
+}
+
+// Writes return once the remainder fits the TX ring; the ring drains at the
+// line rate, so output beyond its size blocks the caller
+ssize_t BufferedSerial::write(const void *buffer, size_t size) {
+    SimCall call;
+    if (!output_ || size == 0) return (ssize_t)size;
+
+    SimStats &s = sim_stats();
+    const uint64_t now = sim_now_us();
+    const uint64_t per_byte = byte_us();
+    tx_empty_at_ = std::max(now, tx_empty_at_) + size * per_byte;
+    sim_set_uart_busy_until(tx_empty_at_);
+    s.uart_bytes += size;
+    sim_console_output((const char *)buffer, size);
+
+    const uint64_t ring_us = (uint64_t)sim_config().uart_tx_buffer * per_byte;
+    if (tx_empty_at_ > now + ring_us) {
+        uint64_t blocked = tx_empty_at_ - ring_us - now;
+        s.uart_blocked_us += blocked;
+        s.uart_blocked_max_us = std::max(s.uart_blocked_max_us, blocked);
+        sim_idle(blocked, [] { return false; });
+    }
+    return (ssize_t)size;
+}
+
+ssize_t BufferedSerial::read(void *, size_t) {
+    return -EAGAIN;    // no host input is modelled
+}
+
+off_t BufferedSerial::seek(off_t, int) {
+    return -ESPIPE;
+}
+
+int BufferedSerial::close() {
+    return 0;
+}
+
+int BufferedSerial::isatty() {
+    return 1;
+}
+
+int BufferedSerial::sync() {
+    SimCall call;
+    uint64_t now = sim_now_us();
+    if (tx_empty_at_ > now) sim_idle(tx_empty_at_ - now, [] { return false; });
+    return 0;
+}
+
+void BufferedSerial::set_baud(int baud) {
+    baud_ = baud;
+}
+
+int BufferedSerial::enable_input(bool enabled) {
+    if (enabled != input_) {
+        if (enabled) sim_deep_sleep_lock();
+        else sim_deep_sleep_unlock();
+        input_ = enabled;
+    }
+    return 0;
+}
+
+int BufferedSerial::enable_output(bool enabled) {
+    output_ = enabled;
+    return 0;
+}
+
+// --------------------------------------------------------- InterruptIn
+InterruptIn::InterruptIn(PinName pin) : pin_(pin) {
+    // Button is pulled up; other inputs idle low
+    if (pin == BUTTON1) sim_pin_write(pin, 1);
+}
+
+void InterruptIn::bind() {
+    sim_pin_set_handlers(pin_,
+                         [this] { if (enabled_ && rise_) rise_(); },
+                         [this] { if (enabled_ && fall_) fall_(); });
+}
+
+void InterruptIn::rise(Callback<void()> func) {
+    rise_ = func;
+    bind();
+}
+
+void InterruptIn::fall(Callback<void()> func) {
+    fall_ = func;
+    bind();
+}
+
+// -------------------------------------------------------------- Ticker
+Ticker::~Ticker() {
+    detach();
+}
+
+// The microsecond ticker keeps the high-frequency clock running
+void Ticker::attach(Callback<void()> func, std::chrono::microseconds period) {
+    detach();
+    func_ = func;
+    period_us_ = std::max<int64_t>(1, period.count());
+    alive_ = std::make_shared<bool>(true);
+    sim_deep_sleep_lock();
+    arm(sim_now_us() + period_us_);
+}
+
+void Ticker::arm(uint64_t at) {
+    std::shared_ptr<bool> alive = alive_;
+    sim_schedule(at, [this, alive, at] {
+        if (!*alive) return;
+        func_();
+        if (*alive) arm(at + period_us_);
+    });
+}
+
+void Ticker::detach() {
+    if (alive_) {
+        *alive_ = false;
+        alive_.reset();
+        sim_deep_sleep_unlock();
+    }
+}
+
+// ------------------------------------------------------ LowPowerTimeout
+LowPowerTimeout::~LowPowerTimeout() {
+    detach();
+}
+
+void LowPowerTimeout::attach(Callback<void()> func, std::chrono::microseconds delay) {
+    SimCall call;
+    detach();
+    func_ = func;
+    alive_ = std::make_shared<bool>(true);
+    std::shared_ptr<bool> alive = alive_;
+    sim_schedule(sim_now_us() + std::max<int64_t>(0, delay.count()), [this, alive] {
+        if (!*alive) return;
+        *alive = false;
+        func_();
+    });
+}
+
+void LowPowerTimeout::detach() {
+    if (alive_) {
+        *alive_ = false;
+        alive_.reset();
+    }
+}
+
+// --------------------------------------------------------------- Timer
+void Timer::start() {
+    SimCall call;
+    if (!running_) {
+        running_ = true;
+        start_us_ = sim_now_us();
+    }
+}
+
+void Timer::stop() {
+    SimCall call;
+    if (running_) {
+        accumulated_us_ += sim_now_us() - start_us_;
+        running_ = false;
+    }
+}
+
+void Timer::reset() {
+    SimCall call;
+    accumulated_us_ = 0;
+    start_us_ = sim_now_us();
+}
+
+std::chrono::microseconds Timer::elapsed_time() const {
+    SimCall call;
+    uint64_t us = accumulated_us_ + (running_ ? sim_now_us() - start_us_ : 0);
+    return std::chrono::microseconds(us);
+}
+
+} // namespace mbed
+
+void sleep() {
+    SimCall call;
+    sim_sleep();
+}
+
+// ----------------------------------------------------------------- RTOS
+namespace rtos {
+
+Kernel::Clock::time_point Kernel::Clock::now() {
+    SimCall call;
+    return time_point(duration(sim_now_us() / 1000));
+}
+
+void ThisThread::sleep_for(std::chrono::microseconds duration) {
+    SimCall call;
+    sim_idle(duration.count() > 0 ? duration.count() : 0, [] { return false; });
+}
+
+uint32_t EventFlags::set(uint32_t flags) {
+    flags_ |= flags;
+    return flags_;
+}
+
+uint32_t EventFlags::clear(uint32_t flags) {
+    uint32_t before = flags_;
+    flags_ &= ~flags;
+    return before;
+}
+
+uint32_t EventFlags::wait_any_for(uint32_t flags, std::chrono::microseconds timeout, bool clear) {
+    SimCall call;
+    if (!sim_idle(timeout.count() > 0 ? timeout.count() : 0,
+                  [this, flags] { return (flags_ & flags) != 0; })) {
+        return osFlagsErrorTimeout;
+    }
+    uint32_t result = flags_;
+    if (clear) flags_ &= ~flags;
+    return result;
+}
+
+uint32_t EventFlags::wait_any(uint32_t flags, bool clear) {
+    return wait_any_for(flags, std::chrono::microseconds(UINT32_MAX) * 1000, clear);
+}
+
+} // namespace rtos
+
+// ------------------------------------------------------------- KVStore
+// Flash programming time is charged as busy time
+static constexpr uint64_t KV_SET_US = 2000;
+
+static std::map<std::string, std::vector<uint8_t>> &kv_table() {
+    static std::map<std::string, std::vector<uint8_t>> table;
+    return table;
+}
+
+int kv_set(const char *key, const void *buffer, size_t size, uint32_t) {
+    SimCall call;
+    const uint8_t *p = (const uint8_t *)buffer;
+    kv_table()[key] = std::vector<uint8_t>(p, p + size);
+    sim_busy(KV_SET_US);
+    return MBED_SUCCESS;
+}
+
+int kv_get(const char *key, void *buffer, size_t buffer_size, size_t *actual_size) {
+    SimCall call;
+    auto it = kv_table().find(key);
+    if (it == kv_table().end()) return MBED_ERROR_ITEM_NOT_FOUND;
+    size_t n = std::min(buffer_size, it->second.size());
+    memcpy(buffer, it->second.data(), n);
+    if (actual_size) *actual_size = n;
+    return MBED_SUCCESS;
+}
+
+int kv_remove(const char *key) {
+    SimCall call;
+    return kv_table().erase(key) ? MBED_SUCCESS : MBED_ERROR_ITEM_NOT_FOUND;
+}
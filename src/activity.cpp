@@ -0,0 +1,123 @@
+#include "activity.h"
+#include <cmath>
+
+// Tilt of the up axis from vertical (cosine thresholds)
+static const float COS_UPRIGHT = 0.866f;   // within 30 deg = upright
+static const float COS_LYING   = 0.5f;     // beyond 60 deg = lying
+
+// Dynamic acceleration RMS (g) above which an upright subject is moving
+static const float WALK_MOTION_RMS = 0.08f;
+
+static const int CONFIRM_WINDOWS = 2;
+
+static const DetectorPolicy POLICIES[ACTIVITY_COUNT] = {
+    // tremor, axes,  dysk,  fog,   tremor thr, dysk thr
+    {  true,   true,  true,  false, 20.0f,      20.0f },   // lying: rest tremor matters, no gait
+    {  true,   true,  true,  false, 20.0f,      20.0f },   // sitting
+    {  true,   true,  true,  true,  20.0f,      20.0f },   // standing
+    // walking: tremor on the canceller output only. The raw axes and the
+    // 5-7 Hz band carry the 3rd/4th step harmonics, which the canceller
+    // does not remove, so axis coherence and dyskinesia are off.
+    {  true,   false, false, true,  30.0f,      25.0f },
+};
+
+static const char *NAMES[ACTIVITY_COUNT] = {"lying", "sitting", "standing", "walking"};
+
+static ActivityState state;
+
+static uint32_t windows[ACTIVITY_COUNT];
+static uint64_t cpu_us[ACTIVITY_COUNT];
+
+void activity_state_reset(ActivityState &s, float fs_hz) {
+    // ~1 s gravity low-pass, ~2 s motion energy average
+    s.gravity_alpha = 1.0f / fs_hz;
+    s.motion_alpha = 0.5f / fs_hz;
+    s.gravity[0] = s.gravity[1] = 0.0f;
+    s.gravity[2] = 1.0f;
+    s.motion_power = 0.0f;
+    s.context = s.candidate = ACTIVITY_STANDING;
+    s.candidate_windows = 0;
+}
+
+void activity_state_update(ActivityState &s, float ax, float ay, float az) {
+    s.gravity[0] += s.gravity_alpha * (ax - s.gravity[0]);
+    s.gravity[1] += s.gravity_alpha * (ay - s.gravity[1]);
+    s.gravity[2] += s.gravity_alpha * (az - s.gravity[2]);
+
+    float dx = ax - s.gravity[0];
+    float dy = ay - s.gravity[1];
+    float dz = az - s.gravity[2];
+    s.motion_power += s.motion_alpha * (dx * dx + dy * dy + dz * dz - s.motion_power);
+}
+
+ActivityContext activity_state_classify(ActivityState &s, float step_hz) {
+    const float *g = s.gravity;
+    float g_norm = sqrtf(g[0] * g[0] + g[1] * g[1] + g[2] * g[2]);
+    float cos_tilt = g_norm > 1e-3f ? fabsf(g[ACTIVITY_UP_AXIS]) / g_norm : 1.0f;
+
+    ActivityContext now;
+    if (cos_tilt < COS_LYING) {
+        now = ACTIVITY_LYING;
+    } else if (cos_tilt < COS_UPRIGHT) {
+        now = ACTIVITY_SITTING;
+    } else if (sqrtf(s.motion_power) > WALK_MOTION_RMS && step_hz > 0.0f) {
+        now = ACTIVITY_WALKING;
+    } else {
+        now = ACTIVITY_STANDING;
+    }
+
+    if (now == s.context) {
+        s.candidate_windows = 0;
+    } else if (now == s.candidate) {
+        if (++s.candidate_windows >= CONFIRM_WINDOWS) {
+            s.context = now;
+            s.candidate_windows = 0;
+        }
+    } else {
+        s.candidate = now;
+        s.candidate_windows = 1;
+    }
+    return s.context;
+}
+
+void activity_init(float fs_hz) {
+    activity_state_reset(state, fs_hz);
+    for (int i = 0; i < ACTIVITY_COUNT; i++) {
+        windows[i] = 0;
+        cpu_us[i] = 0;
+    }
+}
+
+void activity_update(float ax, float ay, float az) {
+    activity_state_update(state, ax, ay, az);
+}
+
+ActivityContext activity_classify(float step_hz) {
+    return activity_state_classify(state, step_hz);
+}
+
+ActivityContext activity_context() {
+    return state.context;
+}
+
+const DetectorPolicy &activity_policy(ActivityContext c) {
+    return POLICIES[c < ACTIVITY_COUNT ? c : ACTIVITY_STANDING];
+}
+
+const char *activity_name(ActivityContext c) {
+    return c < ACTIVITY_COUNT ? NAMES[c] : "?";
+}
+
+void activity_account(ActivityContext c, uint32_t analysis_us) {
+    if (c >= ACTIVITY_COUNT) return;
+    windows[c]++;
+    cpu_us[c] += analysis_us;
+}
+
+uint32_t activity_windows(ActivityContext c) {
+    return c < ACTIVITY_COUNT ? windows[c] : 0;
+}
+
+uint64_t activity_cpu_us(ActivityContext c) {
+    return c < ACTIVITY_COUNT ? cpu_us[c] : 0;
+}
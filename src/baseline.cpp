@@ -0,0 +1,105 @@
+#include "baseline.h"
+#include <cmath>
+#include <cstring>
+
+struct MetricConfig {
+    float quantile;     // tracked quantile (0-1)
+    float margin;       // threshold = margin x quantile
+    float clamp_low;    // limits relative to the default threshold
+    float clamp_high;
+};
+
+static const MetricConfig CONFIG[BASELINE_COUNT] = {
+    // q      margin  low    high
+    {  0.90f, 1.5f,   0.5f,  2.0f },   // tremor: well above the usual 90th pct
+    {  0.90f, 1.5f,   0.5f,  2.0f },   // dyskinesia
+    {  0.10f, 3.0f,   0.5f,  2.0f },   // gait std: a few times the quiet floor
+};
+
+static const uint32_t WARMUP_WINDOWS = 100;   // ~5 min of windows
+static const float    RATE = 0.01f;           // quantile step per unit spread
+static const float    SPREAD_ALPHA = 0.01f;
+
+static const uint8_t  BLOB_MAGIC[4] = {'G', 'W', 'B', 'L'};
+static const uint16_t BLOB_VERSION = 1;
+
+static BaselineState state;
+
+void baseline_state_reset(BaselineState &s) {
+    for (int i = 0; i < BASELINE_COUNT; i++) {
+        s.metrics[i] = BaselineEstimate{0.0f, 0.0f, 0};
+    }
+}
+
+void baseline_state_observe(BaselineState &s, BaselineMetric metric, float value) {
+    if (metric >= BASELINE_COUNT || !std::isfinite(value)) return;
+    BaselineEstimate &m = s.metrics[metric];
+    const float q = CONFIG[metric].quantile;
+
+    if (m.count == 0) {
+        m.estimate = value;
+        m.spread = fabsf(value) * 0.1f + 1e-3f;
+    } else {
+        m.spread += SPREAD_ALPHA * (fabsf(value - m.estimate) - m.spread);
+        // Move up by q or down by (1 - q): settles where P(x < est) = q
+        float step = RATE * m.spread;
+        m.estimate += value > m.estimate ? step * q : -step * (1.0f - q);
+    }
+    if (m.count < UINT32_MAX) m.count++;
+}
+
+float baseline_state_threshold(const BaselineState &s, BaselineMetric metric,
+                               float default_threshold) {
+    if (metric >= BASELINE_COUNT) return default_threshold;
+    const BaselineEstimate &m = s.metrics[metric];
+    if (m.count < WARMUP_WINDOWS) return default_threshold;
+
+    const MetricConfig &c = CONFIG[metric];
+    float t = c.margin * m.estimate;
+    float lo = c.clamp_low * default_threshold;
+    float hi = c.clamp_high * default_threshold;
+    if (t < lo) t = lo;
+    if (t > hi) t = hi;
+    return t;
+}
+
+void baseline_init() {
+    baseline_state_reset(state);
+}
+
+void baseline_observe(BaselineMetric metric, float value) {
+    baseline_state_observe(state, metric, value);
+}
+
+float baseline_threshold(BaselineMetric metric, float default_threshold) {
+    return baseline_state_threshold(state, metric, default_threshold);
+}
+
+size_t baseline_save(uint8_t *out, size_t capacity) {
+    const size_t size = sizeof(BLOB_MAGIC) + sizeof(BLOB_VERSION) + sizeof(state.metrics);
+    if (out == nullptr || capacity < size) return 0;
+    uint8_t *p = out;
+    memcpy(p, BLOB_MAGIC, sizeof(BLOB_MAGIC));
+    p += sizeof(BLOB_MAGIC);
+    memcpy(p, &BLOB_VERSION, sizeof(BLOB_VERSION));
+    p += sizeof(BLOB_VERSION);
+    memcpy(p, state.metrics, sizeof(state.metrics));
+    return size;
+}
+
+bool baseline_load(const uint8_t *in, size_t length) {
+    const size_t size = sizeof(BLOB_MAGIC) + sizeof(BLOB_VERSION) + sizeof(state.metrics);
+    if (in == nullptr || length != size) return false;
+    if (memcmp(in, BLOB_MAGIC, sizeof(BLOB_MAGIC)) != 0) return false;
+    uint16_t version;
+    memcpy(&version, in + sizeof(BLOB_MAGIC), sizeof(version));
+    if (version != BLOB_VERSION) return false;
+
+    BaselineEstimate loaded[BASELINE_COUNT];
+    memcpy(loaded, in + sizeof(BLOB_MAGIC) + sizeof(BLOB_VERSION), sizeof(loaded));
+    for (int i = 0; i < BASELINE_COUNT; i++) {
+        if (!std::isfinite(loaded[i].estimate) || !std::isfinite(loaded[i].spread)) return false;
+    }
+    memcpy(state.metrics, loaded, sizeof(state.metrics));
+    return true;
+}
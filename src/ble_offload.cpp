@@ -0,0 +1,230 @@
+#include "ble_offload.h"
+
+#include <cmath>
+
+static uint32_t get_u32(const uint8_t *p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+uint16_t ble_offload_records_per_frame(const BleLinkParams &link, uint16_t record_bytes) {
+    int payload = (int)link.att_mtu - (int)ATT_NOTIFY_HEADER - (int)OFFLOAD_FRAME_HEADER;
+    int n = payload / record_bytes;
+    if (n < 1) n = 1;
+    if (n > 255) n = 255;
+    return (uint16_t)n;
+}
+
+void ble_offload_init(OffloadSender &sender, const OffloadSource &source,
+                      uint8_t ack_rtt_events, uint32_t ack_timeout_ms) {
+    sender = OffloadSender{};
+    sender.source = source;
+    sender.ack_rtt_events = ack_rtt_events ? ack_rtt_events : 1;
+    sender.window_frames = 2;
+    sender.ack_timeout_ms = ack_timeout_ms;
+    sender.records_per_frame = 1;
+}
+
+void ble_offload_set_link(OffloadSender &sender, const BleLinkParams &link) {
+    sender.records_per_frame = ble_offload_records_per_frame(link, sender.source.record_bytes);
+    sender.window_frames = ble_offload_window_frames(link, sender.source.record_bytes,
+                                                     sender.ack_rtt_events);
+}
+
+static void account_active(OffloadSender &sender, uint32_t now_ms) {
+    if (sender.active && sender.linked) {
+        sender.stats.active_ms += now_ms - sender.active_since_ms;
+    }
+    sender.active_since_ms = now_ms;
+}
+
+// Records the source dropped before they were delivered are skipped
+static void clamp_to_source(OffloadSender &sender) {
+    uint32_t first = sender.source.first_seq();
+    if (sender.base_seq < first) {
+        sender.stats.records_skipped += first - sender.base_seq;
+        sender.base_seq = first;
+    }
+    if (sender.next_seq < sender.base_seq) {
+        sender.next_seq = sender.base_seq;
+    }
+}
+
+void ble_offload_start(OffloadSender &sender, uint32_t from_seq, uint32_t now_ms) {
+    account_active(sender, now_ms);
+    if (sender.started && !sender.stats.complete) {
+        sender.stats.resumes++;
+    } else {
+        sender.stats = OffloadStats{};
+    }
+    sender.started = true;
+    sender.active = true;
+    sender.linked = true;
+    sender.base_seq = from_seq;
+    sender.next_seq = from_seq;
+    sender.end_seq = sender.source.end_seq();
+    sender.last_progress_ms = now_ms;
+    sender.active_since_ms = now_ms;
+    clamp_to_source(sender);
+    if (sender.base_seq >= sender.end_seq) {
+        sender.stats.complete = true;
+        sender.active = false;
+    }
+}
+
+void ble_offload_ack(OffloadSender &sender, uint32_t next_seq, uint32_t now_ms) {
+    if (!sender.active || next_seq <= sender.base_seq || next_seq > sender.next_seq) return;
+
+    sender.stats.bytes_acked += (next_seq - sender.base_seq) * sender.source.record_bytes;
+    sender.base_seq = next_seq;
+    sender.last_progress_ms = now_ms;
+
+    if (sender.base_seq >= sender.end_seq) {
+        account_active(sender, now_ms);
+        sender.active = false;
+        sender.stats.complete = true;
+    }
+}
+
+void ble_offload_stop(OffloadSender &sender, uint32_t now_ms) {
+    account_active(sender, now_ms);
+    sender.active = false;
+}
+
+void ble_offload_link_lost(OffloadSender &sender, uint32_t now_ms) {
+    account_active(sender, now_ms);
+    sender.linked = false;
+    if (sender.next_seq > sender.base_seq) {
+        sender.stats.records_retransmitted += sender.next_seq - sender.base_seq;
+        sender.next_seq = sender.base_seq;
+    }
+}
+
+bool ble_offload_control(OffloadSender &sender, const uint8_t *data, size_t length, uint32_t now_ms) {
+    if (length < OFFLOAD_CONTROL_BYTES) return false;
+    uint32_t seq = get_u32(data + 1);
+    switch (data[0]) {
+    case OFFLOAD_CMD_START:
+        ble_offload_start(sender, seq, now_ms);
+        return true;
+    case OFFLOAD_CMD_ACK:
+        ble_offload_ack(sender, seq, now_ms);
+        return true;
+    case OFFLOAD_CMD_STOP:
+        ble_offload_stop(sender, now_ms);
+        return true;
+    default:
+        return false;
+    }
+}
+
+void ble_offload_poll(OffloadSender &sender, uint32_t now_ms) {
+    if (!sender.active || !sender.linked || sender.next_seq == sender.base_seq) return;
+    if (now_ms - sender.last_progress_ms < sender.ack_timeout_ms) return;
+
+    sender.stats.timeouts++;
+    sender.stats.records_retransmitted += sender.next_seq - sender.base_seq;
+    sender.next_seq = sender.base_seq;
+    sender.last_progress_ms = now_ms;
+}
+
+size_t ble_offload_frame(OffloadSender &sender, uint8_t *frame, size_t capacity) {
+    if (!sender.active || !sender.linked) return 0;
+    clamp_to_source(sender);
+    if (sender.next_seq >= sender.end_seq) return 0;
+
+    const uint32_t window_records = (uint32_t)sender.window_frames * sender.records_per_frame;
+    const uint32_t in_flight = sender.next_seq - sender.base_seq;
+    if (in_flight >= window_records) return 0;
+
+    if (capacity < OFFLOAD_FRAME_HEADER + sender.source.record_bytes) return 0;
+    const size_t room = (capacity - OFFLOAD_FRAME_HEADER) / sender.source.record_bytes;
+
+    size_t count = sender.records_per_frame;
+    if (count > sender.end_seq - sender.next_seq) count = sender.end_seq - sender.next_seq;
+    if (count > window_records - in_flight) count = window_records - in_flight;
+    if (count > room) count = room;
+
+    count = sender.source.read(sender.next_seq, frame + OFFLOAD_FRAME_HEADER, count);
+    if (count == 0) return 0;
+
+    put_u32(frame, sender.next_seq);
+    frame[4] = (uint8_t)count;
+    frame[5] = (sender.next_seq + count == sender.end_seq) ? OFFLOAD_FRAME_LAST : 0;
+    return OFFLOAD_FRAME_HEADER + count * sender.source.record_bytes;
+}
+
+void ble_offload_frame_sent(OffloadSender &sender, const uint8_t *frame, uint32_t now_ms) {
+    uint32_t first = get_u32(frame);
+    uint32_t count = frame[4];
+    if (first != sender.next_seq) return;
+
+    // The ack timer runs from the oldest outstanding frame
+    if (sender.next_seq == sender.base_seq) sender.last_progress_ms = now_ms;
+    sender.next_seq += count;
+    sender.stats.bytes_sent += count * sender.source.record_bytes;
+}
+
+uint32_t ble_offload_throughput_bps(const OffloadStats &stats) {
+    if (stats.active_ms == 0) return 0;
+    return (uint32_t)((uint64_t)stats.bytes_acked * 8 * 1000 / stats.active_ms);
+}
+
+// Air time of one L2CAP SDU fragmented into LL PDUs, each followed by the
+// peer's empty PDU and two inter-frame spaces
+static uint32_t sdu_air_us(const BleLinkParams &link, uint32_t sdu_bytes, uint32_t *pdus) {
+    const uint32_t bits_per_us = link.phy_2m ? 2 : 1;
+    const uint32_t preamble = link.phy_2m ? 2 : 1;
+    const uint32_t overhead = preamble + 4 + 2 + 3;       // preamble, access address, header, CRC
+    const uint32_t t_ifs_us = 150;
+    const uint32_t empty_us = overhead * 8 / bits_per_us;  // peer's ack PDU
+
+    uint32_t remaining = sdu_bytes;
+    uint32_t air_us = 0;
+    *pdus = 0;
+    while (remaining > 0) {
+        uint32_t chunk = remaining < link.ll_octets ? remaining : link.ll_octets;
+        air_us += (overhead + chunk) * 8 / bits_per_us + t_ifs_us + empty_us + t_ifs_us;
+        remaining -= chunk;
+        (*pdus)++;
+    }
+    return air_us;
+}
+
+uint32_t ble_att_air_us(const BleLinkParams &link, size_t value_bytes) {
+    uint32_t pdus;
+    return sdu_air_us(link, (uint32_t)(L2CAP_HEADER + ATT_NOTIFY_HEADER + value_bytes), &pdus);
+}
+
+// Full notifications per connection event: air time and the controller limit
+static double notifications_per_event(const BleLinkParams &link, uint16_t record_bytes) {
+    const uint16_t records = ble_offload_records_per_frame(link, record_bytes);
+    uint32_t pdus;
+    uint32_t air_us = sdu_air_us(link, L2CAP_HEADER + ATT_NOTIFY_HEADER + OFFLOAD_FRAME_HEADER +
+                                       records * record_bytes, &pdus);
+
+    double per_event = (double)link.conn_interval_us / air_us;
+    double by_limit = (double)link.max_pdus_per_event / pdus;
+    return by_limit < per_event ? by_limit : per_event;
+}
+
+uint32_t ble_link_capacity_bps(const BleLinkParams &link, uint16_t record_bytes) {
+    const uint16_t records = ble_offload_records_per_frame(link, record_bytes);
+    double notifications_per_s = notifications_per_event(link, record_bytes) * 1e6 / link.conn_interval_us;
+    return (uint32_t)(notifications_per_s * records * record_bytes * 8);
+}
+
+uint8_t ble_offload_window_frames(const BleLinkParams &link, uint16_t record_bytes,
+                                  uint8_t ack_rtt_events) {
+    double in_flight = notifications_per_event(link, record_bytes) * ack_rtt_events;
+    uint32_t frames = 2 * (uint32_t)ceil(in_flight);
+    if (frames < 2) frames = 2;
+    if (frames > 255) frames = 255;
+    return (uint8_t)frames;
+}
@@ -1,18 +1,288 @@
 #include "ble_service.h"
+#include "parkinsons_system.h"
 
-// BLE Service Module - Currently not in use
-// Detection results are transmitted via UART serial output instead
-// To enable BLE functionality in the future:
-// 1. Include mbed BLE headers (mbed_ble.h)
-// 2. Define BLE service and characteristics for Tremor, Dyskinesia, Freezing
-// 3. Implement ble_service_init() to initialize and start advertising
-// 4. Implement ble_service_update() to write values to characteristics
-// 5. Call ble_service_init() from main() and ble_service_update() from detect_symptoms()
+// BLE Service Module
+// Live detection results are transmitted via UART serial output. With
+// BLE_OFFLOAD_ENABLED the stored session log is offloaded in bulk over a
+// GATT service (see ble_offload.h for the protocol):
+//   - data characteristic: notifications, one frame each
+//   - control characteristic: START / ACK / STOP writes from the central
+//   - telemetry characteristic: energy totals (see ble_service_energy())
+// Air time of every notification sent and control write received is
+// charged to ENERGY_RADIO.
+// The link is tuned for throughput once connected: 2M PHY is requested,
+// the connection interval is shortened during a transfer, and frames are
+// sized to the ATT MTU the central negotiates. Enabling requires the BLE
+// feature and a controller driver in mbed_app.json, e.g.
+//   "target.features_add": ["BLE"], "target.components_add": ["BlueNRG_MS"],
+//   "cordio.desired-att-mtu": 247, "cordio.rx-acl-buffer-size": 251
+// A controller without DLE or 2M PHY (the B-L475E-IOT01A's SPBTLE-RF is
+// Bluetooth 4.1) keeps working on 27-byte PDUs and the 1M PHY.
 
-bool ble_service_init() {
+#if BLE_OFFLOAD_ENABLED
+#include "ble/BLE.h"
+#include "ble_offload.h"
+#include "session_log.h"
+
+static const UUID OFFLOAD_SERVICE_UUID("a3c10001-5e2b-4c8d-9f61-2b7e4d9a0c15");
+static const UUID OFFLOAD_DATA_UUID("a3c10002-5e2b-4c8d-9f61-2b7e4d9a0c15");
+static const UUID OFFLOAD_CONTROL_UUID("a3c10003-5e2b-4c8d-9f61-2b7e4d9a0c15");
+static const UUID TELEMETRY_UUID("a3c10004-5e2b-4c8d-9f61-2b7e4d9a0c15");
+
+static constexpr BleLinkParams DEFAULT_LINK = {23, 27, false, 50000, 4};
+static constexpr size_t MAX_FRAME_BYTES = 247 - ATT_NOTIFY_HEADER;
+static constexpr size_t TELEMETRY_BYTES = 4 + 4 * ENERGY_COUNT;
+
+static uint8_t data_value[MAX_FRAME_BYTES];
+static uint8_t control_value[OFFLOAD_CONTROL_BYTES];
+static uint8_t telemetry_value[TELEMETRY_BYTES];
+
+static GattCharacteristic data_char(
+    OFFLOAD_DATA_UUID, data_value, 0, sizeof(data_value),
+    GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_NOTIFY, nullptr, 0, true);
+static GattCharacteristic control_char(
+    OFFLOAD_CONTROL_UUID, control_value, sizeof(control_value), sizeof(control_value),
+    GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_WRITE |
+    GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_WRITE_WITHOUT_RESPONSE, nullptr, 0, false);
+static GattCharacteristic telemetry_char(
+    TELEMETRY_UUID, telemetry_value, sizeof(telemetry_value), sizeof(telemetry_value),
+    GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_READ |
+    GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_NOTIFY, nullptr, 0, false);
+
+static OffloadSender offload;
+static BleLinkParams link = DEFAULT_LINK;
+static void (*notify_main)() = nullptr;
+static volatile bool events_pending = false;
+static bool connected = false;
+static bool telemetry_subscribed = false;
+static bool reported = true;
+static ble::connection_handle_t connection;
+static uint32_t current_ms = 0;
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static void start_advertising() {
+    Gap &gap = BLE::Instance().gap();
+    uint8_t adv_buffer[ble::LEGACY_ADVERTISING_MAX_SIZE];
+    ble::AdvertisingDataBuilder builder(adv_buffer);
+    builder.setFlags();
+    builder.setName("GaitWave");
+
+    gap.setAdvertisingParameters(
+        ble::LEGACY_ADVERTISING_HANDLE,
+        ble::AdvertisingParameters(ble::advertising_type_t::CONNECTABLE_UNDIRECTED,
+                                   ble::adv_interval_t(ble::millisecond_t(200))));
+    gap.setAdvertisingPayload(ble::LEGACY_ADVERTISING_HANDLE, builder.getAdvertisingData());
+    gap.startAdvertising(ble::LEGACY_ADVERTISING_HANDLE);
+}
+
+static void update_link() {
+    ble_offload_set_link(offload, link);
+}
+
+// Hand frames to the stack until its buffers or the offload window are full
+static void pump() {
+    if (!connected) return;
+    uint16_t capacity = link.att_mtu - ATT_NOTIFY_HEADER;
+    if (capacity > MAX_FRAME_BYTES) capacity = MAX_FRAME_BYTES;
+
+    uint8_t frame[MAX_FRAME_BYTES];
+    size_t n;
+    while ((n = ble_offload_frame(offload, frame, capacity)) > 0) {
+        if (BLE::Instance().gattServer().write(data_char.getValueHandle(), frame, n) != BLE_ERROR_NONE) {
+            break;   // retried from onDataSent()
+        }
+        ble_offload_frame_sent(offload, frame, current_ms);
+        energy_add_time(ENERGY_RADIO, ble_att_air_us(link, n));
+    }
+}
+
+class OffloadEvents : public ble::Gap::EventHandler, public GattServer::EventHandler {
+public:
+    void onConnectionComplete(const ble::ConnectionCompleteEvent &event) override {
+        if (event.getStatus() != BLE_ERROR_NONE) {
+            start_advertising();
+            return;
+        }
+        connected = true;
+        connection = event.getConnectionHandle();
+        link = DEFAULT_LINK;
+        link.conn_interval_us = event.getConnectionInterval().valueInUs();
+        update_link();
+
+        ble::phy_set_t phys(false, true, false);
+        BLE::Instance().gap().setPhy(connection, &phys, &phys, ble::coded_symbol_per_bit_t::UNDEFINED);
+    }
+
+    void onDisconnectionComplete(const ble::DisconnectionCompleteEvent &event) override {
+        (void)event;
+        connected = false;
+        telemetry_subscribed = false;
+        ble_offload_link_lost(offload, current_ms);
+        start_advertising();
+    }
+
+    void onConnectionParametersUpdateComplete(const ble::ConnectionParametersUpdateCompleteEvent &event) override {
+        if (event.getStatus() == BLE_ERROR_NONE) {
+            link.conn_interval_us = event.getConnectionInterval().valueInUs();
+            update_link();
+        }
+    }
+
+    void onPhyUpdateComplete(ble_error_t status, ble::connection_handle_t handle,
+                             ble::phy_t tx_phy, ble::phy_t rx_phy) override {
+        (void)handle;
+        (void)rx_phy;
+        if (status == BLE_ERROR_NONE) {
+            link.phy_2m = (tx_phy == ble::phy_t::LE_2M);
+            update_link();
+        }
+    }
+
+    void onDataLengthChange(ble::connection_handle_t handle, uint16_t tx_size, uint16_t rx_size) override {
+        (void)handle;
+        (void)rx_size;
+        link.ll_octets = tx_size;
+        update_link();
+    }
+
+    void onAttMtuChange(ble::connection_handle_t handle, uint16_t mtu) override {
+        (void)handle;
+        link.att_mtu = mtu;
+        update_link();
+    }
+
+    void onDataWritten(const GattWriteCallbackParams &params) override {
+        if (params.handle != control_char.getValueHandle()) return;
+        energy_add_time(ENERGY_RADIO, ble_att_air_us(link, params.len));
+        bool was_active = offload.active;
+        ble_offload_control(offload, params.data, params.len, current_ms);
+        if (offload.active && !was_active) {
+            // Short interval while streaming; the central may refuse
+            BLE::Instance().gap().updateConnectionParameters(
+                connection, ble::conn_interval_t(OFFLOAD_CONN_INTERVAL),
+                ble::conn_interval_t(OFFLOAD_CONN_INTERVAL), ble::slave_latency_t(0),
+                ble::supervision_timeout_t(ble::millisecond_t(4000)));
+            reported = false;
+        }
+        pump();
+    }
+
+    void onUpdatesEnabled(const GattUpdatesEnabledCallbackParams &params) override {
+        if (params.attHandle == telemetry_char.getValueHandle()) telemetry_subscribed = true;
+    }
+
+    void onUpdatesDisabled(const GattUpdatesDisabledCallbackParams &params) override {
+        if (params.attHandle == telemetry_char.getValueHandle()) telemetry_subscribed = false;
+    }
+
+    void onDataSent(const GattDataSentCallbackParams &params) override {
+        (void)params;
+        pump();
+    }
+};
+
+static OffloadEvents events;
+
+static void on_events_to_process(BLE::OnEventsToProcessCallbackContext *context) {
+    (void)context;
+    events_pending = true;
+    if (notify_main) notify_main();
+}
+
+static void on_init_complete(BLE::InitializationCompleteCallbackContext *context) {
+    if (context->error != BLE_ERROR_NONE) {
+        printf("WARN: BLE init failed (%d)\r\n", (int)context->error);
+        return;
+    }
+    BLE &ble = BLE::Instance();
+    ble.gap().setEventHandler(&events);
+    ble.gattServer().setEventHandler(&events);
+
+    GattCharacteristic *characteristics[] = {&data_char, &control_char, &telemetry_char};
+    GattService service(OFFLOAD_SERVICE_UUID, characteristics, 3);
+    ble.gattServer().addService(service);
+
+    ble::phy_set_t phys(false, true, false);
+    ble.gap().setPreferredPhys(&phys, &phys);
+    start_advertising();
+}
+
+bool ble_service_init(void (*on_events)()) {
+    notify_main = on_events;
+    ble_offload_init(offload,
+                     OffloadSource{session_log_first_seq, session_log_end_seq,
+                                   session_log_read, SESSION_RECORD_BYTES},
+                     OFFLOAD_ACK_RTT_EVENTS, OFFLOAD_ACK_TIMEOUT_MS);
+    update_link();
+
+    BLE &ble = BLE::Instance();
+    ble.onEventsToProcess(on_events_to_process);
+    return ble.init(on_init_complete) == BLE_ERROR_NONE;
+}
+
+void ble_service_process(uint32_t now_ms) {
+    current_ms = now_ms;
+    if (events_pending) {
+        events_pending = false;
+        BLE::Instance().processEvents();
+    }
+    ble_offload_poll(offload, now_ms);
+    pump();
+
+    // Measured against the link's theoretical capacity, once per transfer
+    if (!reported && offload.stats.complete) {
+        reported = true;
+        printf("[BLE] offload %lu B in %lu ms: %lu bps (link cap %lu bps, mtu %u, ll %u, %s) retx:%lu resumes:%lu skipped:%lu\r\n",
+               (unsigned long)offload.stats.bytes_acked, (unsigned long)offload.stats.active_ms,
+               (unsigned long)ble_offload_throughput_bps(offload.stats),
+               (unsigned long)ble_link_capacity_bps(link, SESSION_RECORD_BYTES),
+               link.att_mtu, link.ll_octets, link.phy_2m ? "2M" : "1M",
+               (unsigned long)offload.stats.records_retransmitted,
+               (unsigned long)offload.stats.resumes,
+               (unsigned long)offload.stats.records_skipped);
+    }
+}
+
+void ble_service_energy(const EnergyReport &report, uint32_t uptime_s) {
+    uint8_t *p = telemetry_value;
+    put_u32(p, uptime_s);
+    for (int i = 0; i < ENERGY_COUNT; i++) {
+        put_u32(p + 4 + 4 * i, (uint32_t)(report.mah[i] * 1000.0f));
+    }
+
+    // A notification longer than the MTU allows would be truncated; the
+    // central reads the full value instead
+    const bool notify = connected && telemetry_subscribed &&
+                        link.att_mtu - ATT_NOTIFY_HEADER >= TELEMETRY_BYTES;
+    BLE::Instance().gattServer().write(telemetry_char.getValueHandle(), telemetry_value,
+                                       TELEMETRY_BYTES, !notify);
+    if (notify) energy_add_time(ENERGY_RADIO, ble_att_air_us(link, TELEMETRY_BYTES));
+}
+
+#else
+
+bool ble_service_init(void (*on_events)()) {
+    (void)on_events;
     return true;
 }
 
+void ble_service_process(uint32_t now_ms) {
+    (void)now_ms;
+}
+
+void ble_service_energy(const EnergyReport &report, uint32_t uptime_s) {
+    (void)report;
+    (void)uptime_s;
+}
+
+#endif
+
 void ble_service_update(const MovementAnalysis &m, const GaitStatus &g) {
     (void)m;
     (void)g;
@@ -0,0 +1,496 @@
+#include "detect_core.h"
+#include "spectral_backend.h"
+#include "spectral_kernels.h"
+
+#include <cmath>
+
+float detect_band_percent(const float *data, float freq_low, float freq_high,
+                          SpectralScratch &scratch) {
+    return SpectralBackend::band_percent(data, freq_low, freq_high, scratch);
+}
+
+GaitStatus detect_gait(const float *accel_x, const float *accel_y, const float *accel_z,
+                       float rigid_threshold, GaitState &state) {
+    GaitStatus status{};
+
+    // Calculate magnitude for each sample
+    float magnitude_sum = 0.0f;
+    float magnitude[WINDOW_SAMPLES];
+
+    for (size_t i = 0; i < WINDOW_SAMPLES; i++) {
+        magnitude[i] = sqrtf(
+            accel_x[i] * accel_x[i] +
+            accel_y[i] * accel_y[i] +
+            accel_z[i] * accel_z[i]
+        );
+        magnitude_sum += magnitude[i];
+    }
+
+    float mean_magnitude = magnitude_sum / WINDOW_SAMPLES;
+
+    // Calculate variance (motion regularity)
+    float variance = 0.0f;
+    for (size_t i = 0; i < WINDOW_SAMPLES; i++) {
+        float diff = magnitude[i] - mean_magnitude;
+        variance += diff * diff;
+    }
+    variance /= WINDOW_SAMPLES;
+    float std_dev = sqrtf(variance);
+
+    // Cadence: each step is one oscillation of the magnitude about its mean.
+    // Time the upward mean crossings (after dipping below a small hysteresis
+    // band) with linear interpolation; cycles / span gives the step rate.
+    const float crossing_band = 0.05f;
+    int crossings = 0;
+    float first_crossing = 0.0f;
+    float last_crossing = 0.0f;
+    bool armed = false;
+    for (size_t i = 1; i < WINDOW_SAMPLES; i++) {
+        float prev = magnitude[i - 1] - mean_magnitude;
+        float diff = magnitude[i] - mean_magnitude;
+        if (diff < -crossing_band) {
+            armed = true;
+        } else if (armed && prev < 0.0f && diff >= 0.0f) {
+            float t = (i - 1) + prev / (prev - diff);
+            if (crossings == 0) first_crossing = t;
+            last_crossing = t;
+            crossings++;
+            armed = false;
+        }
+    }
+    float step_hz = 0.0f;
+    if (crossings >= 2 && last_crossing > first_crossing) {
+        step_hz = (crossings - 1) * FS_HZ / (last_crossing - first_crossing);
+    }
+    bool walking = std_dev >= 0.15f && step_hz >= 0.8f && step_hz <= 2.5f;
+    status.step_hz = walking ? step_hz : 0.0f;
+    status.std_dev = std_dev;
+
+    // FOG Detection Logic based on variance and mean magnitude
+    // Low variance + low acceleration = freezing of gait
+    // Normal gait: acceleration magnitude 0.8-1.5g with high variance
+    // FOG state: acceleration magnitude < 0.8g with very low variance
+
+    // Thresholds tuned for Parkinson's freezing detection
+    float low_motion_threshold = 0.8f;    // Below normal gravity + gait
+    float variance_threshold_low = 0.25f; // Very rigid motion
+    float variance_threshold_high = rigid_threshold; // Extremely rigid (frozen)
+
+    // Condition 1: Very low motion with very low variance = FREEZE
+    if (mean_magnitude < low_motion_threshold && std_dev < variance_threshold_high) {
+        if (state.prev_variance > variance_threshold_low) {
+            status.fog_state = 1;  // Freeze start (sudden drop to stillness)
+        } else {
+            status.fog_state = 2;  // Sustained freeze
+        }
+    }
+    // Condition 2: Some motion but extremely rigid = FREEZE (tremor/rigidity)
+    else if (std_dev < variance_threshold_high) {
+        status.fog_state = 2;  // Rigid tremorous movement
+    }
+    else {
+        status.fog_state = 0;  // Normal gait
+    }
+
+    state.prev_variance = std_dev;
+    return status;
+}
+
+// Usable autocorrelation lags: circular wrap-around starts beyond this
+static const int ACF_MAX_LAG = (int)(FFT_SIZE - WINDOW_SAMPLES);
+static const int ACF_MIN_STEP_LAG = (int)(FS_HZ / 2.5f);     // 2.5 steps/s
+static const int ACF_MAX_STEP_LAG = (int)(FS_HZ / 0.8f);     // 0.8 steps/s
+static const int ACF_LOWCUT_BINS = 3;                        // < 0.6 Hz: gravity leakage
+
+// Autocorrelation of the Hann window itself, to undo its taper on lags.
+// Built once at first use (the only O(N^2) work, never per window).
+struct HannAcf {
+    float r[ACF_MAX_LAG + 1];
+    HannAcf() {
+        const float *hann = spectral_hann_window();
+        for (int k = 0; k <= ACF_MAX_LAG; k++) {
+            float sum = 0.0f;
+            for (int i = 0; i + k < (int)WINDOW_SAMPLES; i++) sum += hann[i] * hann[i + k];
+            r[k] = sum;
+        }
+    }
+};
+
+// Highest local maximum of acf in [lo, hi], refined by a parabola through
+// its neighbours. Returns false if there is none.
+static bool acf_peak(const float *acf, int lo, int hi, float &lag, float &height) {
+    int best = -1;
+    for (int k = lo; k <= hi; k++) {
+        if (acf[k] >= acf[k - 1] && acf[k] >= acf[k + 1] && (best < 0 || acf[k] > acf[best])) {
+            best = k;
+        }
+    }
+    if (best < 0 || acf[best] <= 0.0f) return false;
+    float a = acf[best - 1], b = acf[best], c = acf[best + 1];
+    float den = a - 2.0f * b + c;
+    float delta = den < 0.0f ? 0.5f * (a - c) / den : 0.0f;
+    lag = best + delta;
+    // Undoing the taper can overshoot 1 at long lags with few samples
+    height = fminf(b - 0.25f * (a - c) * delta, 1.0f);
+    return true;
+}
+
+template <typename Backend>
+void detect_gait_periodicity_with(const float *magnitude, bool have_power,
+                                  SpectralScratch &scratch, GaitStatus &status) {
+    static const HannAcf window_acf;
+    const SpectralKernels &kernels = spectral_kernels();
+
+    status.acf_step_hz = 0.0f;
+    status.step_regularity = 0.0f;
+    status.stride_regularity = 0.0f;
+    status.step_symmetry = 0.0f;
+
+    if (!have_power) {
+        spectral_window(magnitude, scratch);
+        Backend::power_spectrum(scratch);
+    }
+
+    // |X|^2 is real and even, so its inverse transform is the real part of
+    // a forward one over the mirrored spectrum. Bins under the low cut hold
+    // gravity and its window leakage and are dropped.
+    const int n = (int)FFT_SIZE;
+    float *even = scratch.fft_in;
+    for (int k = 0; k < ACF_LOWCUT_BINS; k++) even[k] = 0.0f;
+    for (int k = ACF_LOWCUT_BINS; k < n / 2; k++) even[k] = scratch.power[k];
+    even[n / 2] = 0.0f;
+    for (int k = 1; k < n / 2; k++) even[n - k] = even[k];
+    kernels.rfft(even, scratch.fft_out, n);
+
+    // Real parts of bins 0..ACF_MAX_LAG+1, unbiased for the window taper
+    float acf[ACF_MAX_LAG + 2];
+    const float r0 = scratch.fft_out[0];
+    if (r0 <= 1e-9f) return;
+    for (int k = 0; k <= ACF_MAX_LAG; k++) {
+        float r = k == 0 ? r0 : scratch.fft_out[2 * k];
+        acf[k] = (r / window_acf.r[k]) / (r0 / window_acf.r[0]);
+    }
+    acf[ACF_MAX_LAG + 1] = acf[ACF_MAX_LAG];
+
+    float step_lag, step_height;
+    if (!acf_peak(acf, ACF_MIN_STEP_LAG, ACF_MAX_STEP_LAG, step_lag, step_height)) return;
+
+    // The stride peak is often the highest; a clear peak at half its lag
+    // is the step
+    float half_lag, half_height;
+    int half_lo = (int)(0.4f * step_lag), half_hi = (int)(0.6f * step_lag);
+    if (half_lo < ACF_MIN_STEP_LAG) half_lo = ACF_MIN_STEP_LAG;
+    if (half_lo <= half_hi && acf_peak(acf, half_lo, half_hi, half_lag, half_height) &&
+        half_height >= 0.5f * step_height) {
+        step_lag = half_lag;
+        step_height = half_height;
+    }
+    status.acf_step_hz = FS_HZ / step_lag;
+    status.step_regularity = step_height;
+
+    // Stride = two steps; only when it stays inside the wrap-free range
+    int lo = (int)(1.6f * step_lag);
+    int hi = (int)(2.4f * step_lag);
+    if (hi > ACF_MAX_LAG) hi = ACF_MAX_LAG;
+    float stride_lag, stride_height;
+    if (lo < hi && acf_peak(acf, lo, hi, stride_lag, stride_height)) {
+        status.stride_regularity = stride_height;
+        status.step_symmetry = step_height / stride_height;
+    }
+}
+
+template void detect_gait_periodicity_with<RfftBackend>(const float *, bool, SpectralScratch &,
+                                                        GaitStatus &);
+template void detect_gait_periodicity_with<FftComplexBackend>(const float *, bool,
+                                                              SpectralScratch &, GaitStatus &);
+template void detect_gait_periodicity_with<GoertzelBackend>(const float *, bool,
+                                                            SpectralScratch &, GaitStatus &);
+
+void detect_gait_periodicity(const float *magnitude, bool have_power, SpectralScratch &scratch,
+                             GaitStatus &status) {
+    detect_gait_periodicity_with<SpectralBackend>(magnitude, have_power, scratch, status);
+}
+
+// Four interleaved slots of FFT_SIZE/4 samples; x, y, z and one spare
+static const size_t AXIS_SLOTS = 4;
+static const size_t AXIS_BINS = FFT_SIZE / AXIS_SLOTS;
+static const float AXIS_MIN_AMPLITUDE_G = 0.02f;
+
+// W^-n for the slot phase of bins below AXIS_BINS / 2 (n = slot * bin < AXIS_BINS)
+struct SlotTwiddles {
+    float re[AXIS_BINS], im[AXIS_BINS];
+    SlotTwiddles() {
+        const float PI = 3.14159265359f;
+        for (size_t n = 0; n < AXIS_BINS; n++) {
+            re[n] = cosf(2.0f * PI * n / FFT_SIZE);
+            im[n] = sinf(2.0f * PI * n / FFT_SIZE);
+        }
+    }
+};
+
+// Bin m (0..FFT_SIZE-1) of the full spectrum of a real input from its
+// packed rfft output (upper half by conjugate symmetry)
+static void packed_bin(const float *packed, size_t m, float &re, float &im) {
+    const size_t half = FFT_SIZE / 2;
+    if (m == 0 || m == half) {
+        re = packed[m == 0 ? 0 : 1];
+        im = 0.0f;
+    } else if (m < half) {
+        re = packed[2 * m];
+        im = packed[2 * m + 1];
+    } else {
+        re = packed[2 * (FFT_SIZE - m)];
+        im = -packed[2 * (FFT_SIZE - m) + 1];
+    }
+}
+
+AxisCoherence detect_axis_coherence(const float *accel_x, const float *accel_y,
+                                    const float *accel_z, float freq_low, float freq_high,
+                                    SpectralScratch &scratch) {
+    static const SlotTwiddles twiddle;
+    const float *hann = spectral_hann_window();
+    const SpectralKernels &kernels = spectral_kernels();
+    AxisCoherence c{};
+
+    // Sample i of axis a lands in slot a at position i mod AXIS_BINS
+    float *in = scratch.fft_in;
+    for (size_t i = 0; i < FFT_SIZE; i++) in[i] = 0.0f;
+    const float *axes[3] = {accel_x, accel_y, accel_z};
+    for (size_t a = 0; a < 3; a++) {
+        const float *data = axes[a];
+        float mean = kernels.sum(data, WINDOW_SAMPLES) / WINDOW_SAMPLES;
+        for (size_t start = 0; start < WINDOW_SAMPLES; start += AXIS_BINS) {
+            size_t end = start + AXIS_BINS < WINDOW_SAMPLES ? start + AXIS_BINS : WINDOW_SAMPLES;
+            float *slot = in + a;
+            for (size_t i = start; i < end; i++, slot += AXIS_SLOTS) {
+                *slot += (data[i] - mean) * hann[i];
+            }
+        }
+    }
+    kernels.rfft(in, scratch.fft_out, FFT_SIZE);
+
+    int bin_low = (int)(freq_low * AXIS_BINS / FS_HZ);
+    int bin_high = (int)(freq_high * AXIS_BINS / FS_HZ);
+    if (bin_low < 1) bin_low = 1;
+    if (bin_high > (int)AXIS_BINS / 2 - 1) bin_high = AXIS_BINS / 2 - 1;
+
+    // V[k + 64m] = sum_j (-i)^(jm) W^(jk) S_j[k], W = e^(-2 pi i / FFT_SIZE):
+    // an inverse 4-point DFT over m recovers each slot's bin k
+    float s_re[3][3] = {}, s_im[3][3] = {};
+    for (int k = bin_low; k <= bin_high; k++) {
+        float v_re[AXIS_SLOTS], v_im[AXIS_SLOTS];
+        for (size_t m = 0; m < AXIS_SLOTS; m++) packed_bin(scratch.fft_out, k + AXIS_BINS * m, v_re[m], v_im[m]);
+
+        float x_re[3], x_im[3];
+        for (size_t j = 0; j < 3; j++) {
+            // sum_m i^(jm) V_m; i^(jm) cycles through 1, i, -1, -i
+            float t_re = 0.0f, t_im = 0.0f;
+            for (size_t m = 0; m < AXIS_SLOTS; m++) {
+                switch ((j * m) & 3) {
+                case 0: t_re += v_re[m]; t_im += v_im[m]; break;
+                case 1: t_re -= v_im[m]; t_im += v_re[m]; break;
+                case 2: t_re -= v_re[m]; t_im -= v_im[m]; break;
+                default: t_re += v_im[m]; t_im -= v_re[m]; break;
+                }
+            }
+            float cs = twiddle.re[j * k], sn = twiddle.im[j * k];   // undo W^(jk)
+            x_re[j] = 0.25f * (t_re * cs - t_im * sn);
+            x_im[j] = 0.25f * (t_re * sn + t_im * cs);
+        }
+        for (size_t a = 0; a < 3; a++) {
+            for (size_t b = a; b < 3; b++) {
+                s_re[a][b] += x_re[a] * x_re[b] + x_im[a] * x_im[b];
+                s_im[a][b] += x_im[a] * x_re[b] - x_re[a] * x_im[b];
+            }
+        }
+    }
+
+    // A sinusoid of amplitude A peaks at A * sum(w) / 2 = A * (N - 1) / 4
+    float trace = s_re[0][0] + s_re[1][1] + s_re[2][2];
+    c.amplitude_g = sqrtf(trace) / (0.25f * (WINDOW_SAMPLES - 1));
+    if (c.amplitude_g < AXIS_MIN_AMPLITUDE_G) return c;
+    c.valid = true;
+
+    // An axis with almost none of the band power has no meaningful phase
+    const float floor = 1e-3f * trace;
+    auto coherence = [&](int a, int b) {
+        if (s_re[a][a] <= floor || s_re[b][b] <= floor) return 0.0f;
+        return (s_re[a][b] * s_re[a][b] + s_im[a][b] * s_im[a][b]) / (s_re[a][a] * s_re[b][b]);
+    };
+    c.coherence_xy = coherence(0, 1);
+    c.coherence_xz = coherence(0, 2);
+    c.coherence_yz = coherence(1, 2);
+
+    // Principal axis of the real (in-phase) part by power iteration,
+    // starting from the strongest axis
+    float p[3][3];
+    for (int a = 0; a < 3; a++) {
+        for (int b = 0; b < 3; b++) p[a][b] = a <= b ? s_re[a][b] : s_re[b][a];
+    }
+    float v[3] = {0.0f, 0.0f, 0.0f};
+    int strongest = 0;
+    for (int a = 1; a < 3; a++) {
+        if (p[a][a] > p[strongest][strongest]) strongest = a;
+    }
+    v[strongest] = 1.0f;
+    float lambda = 0.0f;
+    for (int iter = 0; iter < 16; iter++) {
+        float w[3];
+        for (int a = 0; a < 3; a++) w[a] = p[a][0] * v[0] + p[a][1] * v[1] + p[a][2] * v[2];
+        float norm = sqrtf(w[0] * w[0] + w[1] * w[1] + w[2] * w[2]);
+        if (norm <= 0.0f) break;
+        for (int a = 0; a < 3; a++) v[a] = w[a] / norm;
+        lambda = norm;
+    }
+    int largest = 0;
+    for (int a = 1; a < 3; a++) {
+        if (fabsf(v[a]) > fabsf(v[largest])) largest = a;
+    }
+    float sign = v[largest] < 0.0f ? -1.0f : 1.0f;
+    for (int a = 0; a < 3; a++) c.direction[a] = sign * v[a];
+    c.linearity = lambda / trace;
+    return c;
+}
+
+float detect_motion_std(const float *magnitude) {
+    float sum = 0.0f;
+    float sum_sq = 0.0f;
+    for (size_t i = 0; i < WINDOW_SAMPLES; i++) {
+        sum += magnitude[i];
+        sum_sq += magnitude[i] * magnitude[i];
+    }
+    float mean = sum / WINDOW_SAMPLES;
+    float variance = sum_sq / WINDOW_SAMPLES - mean * mean;
+    return variance > 0.0f ? sqrtf(variance) : 0.0f;
+}
+
+void detect_stream_init(DetectStream &stream) {
+    harmonic_canceller_reset(stream.canceller, FS_HZ, TREMOR_F_LOW, TREMOR_F_HIGH);
+    stream.gait.prev_variance = 0.0f;
+    activity_state_reset(stream.activity, FS_HZ);
+    baseline_state_reset(stream.baseline);
+    stream.last_step_hz = 0.0f;
+    stream.windows = 0;
+    stream.previous = DetectWindowResult{};
+}
+
+template <typename Backend>
+DetectWindowResult detect_stream_window_with(DetectStream &stream, const float *xyz,
+                                             AnalysisTier tier) {
+    for (size_t i = 0; i < WINDOW_SAMPLES; i++, xyz += 3) {
+        float x = xyz[0], y = xyz[1], z = xyz[2];
+        stream.accel_x[i] = x;
+        stream.accel_y[i] = y;
+        stream.accel_z[i] = z;
+        stream.accel_total[i] = sqrtf(x * x + y * y + z * z);
+        stream.accel_tremor[i] = harmonic_canceller_filter(stream.canceller, stream.accel_total[i]);
+        activity_state_update(stream.activity, x, y, z);
+    }
+
+    // Activity context decides which detectors run and their thresholds
+    DetectWindowResult r = {};
+    r.activity = activity_state_classify(stream.activity, stream.last_step_hz);
+    const DetectorPolicy &policy = activity_policy(r.activity);
+
+    // Shed tiers skip the transforms and hold what they would have produced
+    const DetectWindowResult &held = stream.previous;
+    const bool spectral = tier == TIER_FULL || (tier == TIER_LONG_HOP && (stream.windows & 1) == 0);
+    const bool gait = tier != TIER_GATE_ONLY;
+    stream.windows++;
+
+    if (spectral) {
+        if (policy.run_tremor) {
+            r.tremor_intensity = Backend::band_percent(stream.accel_tremor, TREMOR_F_LOW,
+                                                       TREMOR_F_HIGH, stream.scratch);
+        }
+        if (policy.run_tremor && policy.run_tremor_axes) {
+            AxisCoherence axes = detect_axis_coherence(stream.accel_x, stream.accel_y,
+                                                       stream.accel_z, TREMOR_F_LOW,
+                                                       TREMOR_F_HIGH, stream.scratch);
+            r.tremor_coherence = (axes.coherence_xy + axes.coherence_xz + axes.coherence_yz) / 3.0f;
+            r.tremor_linearity = axes.linearity;
+        }
+        if (policy.run_dyskinesia) {
+            r.dyskinesia_intensity = Backend::band_percent(stream.accel_total, DYSK_F_LOW,
+                                                           DYSK_F_HIGH, stream.scratch);
+        }
+    } else {
+        if (policy.run_tremor) r.tremor_intensity = held.tremor_intensity;
+        if (policy.run_tremor && policy.run_tremor_axes) {
+            r.tremor_coherence = held.tremor_coherence;
+            r.tremor_linearity = held.tremor_linearity;
+        }
+        if (policy.run_dyskinesia) r.dyskinesia_intensity = held.dyskinesia_intensity;
+        // Gate only: a still limb has neither, whatever was held
+        if (!gait && detect_motion_std(stream.accel_total) < MOTION_GATE_STD_G) {
+            r.tremor_intensity = 0.0f;
+            r.dyskinesia_intensity = 0.0f;
+        }
+    }
+
+    // Thresholds are relative to this stream's learned baselines
+    BaselineState &baseline = stream.baseline;
+    r.tremor_detected = r.tremor_intensity >
+                        baseline_state_threshold(baseline, BASELINE_TREMOR, policy.tremor_threshold);
+    r.dyskinesia_detected = r.dyskinesia_intensity >
+                            baseline_state_threshold(baseline, BASELINE_DYSKINESIA,
+                                                     policy.dyskinesia_threshold);
+    if (spectral && policy.run_tremor) {
+        baseline_state_observe(baseline, BASELINE_TREMOR, r.tremor_intensity);
+    }
+    if (spectral && policy.run_dyskinesia) {
+        baseline_state_observe(baseline, BASELINE_DYSKINESIA, r.dyskinesia_intensity);
+    }
+
+    stream.last_step_hz = 0.0f;
+    if (policy.run_fog && gait) {
+        GaitStatus status = detect_gait(stream.accel_x, stream.accel_y, stream.accel_z,
+                                        baseline_state_threshold(baseline, BASELINE_GAIT_STD,
+                                                                 DETECT_RIGID_STD_G),
+                                        stream.gait);
+        if (spectral) {
+            // A full-spectrum backend left the magnitude spectrum in scratch
+            detect_gait_periodicity_with<Backend>(stream.accel_total,
+                                                  Backend::FULL_SPECTRUM && policy.run_dyskinesia,
+                                                  stream.scratch, status);
+        } else {
+            status.step_regularity = held.step_regularity;
+            status.step_symmetry = held.step_symmetry;
+        }
+        baseline_state_observe(baseline, BASELINE_GAIT_STD, status.std_dev);
+        r.step_hz = status.step_hz;
+        r.std_dev = status.std_dev;
+        r.step_regularity = status.step_regularity;
+        r.step_symmetry = status.step_symmetry;
+        r.fog_state = status.fog_state;
+        r.freezing_detected = status.fog_state > 0;
+        stream.last_step_hz = status.step_hz;
+    } else if (policy.run_fog) {
+        // Gate only: cadence and freeze state carry over
+        r.step_hz = held.step_hz;
+        r.std_dev = held.std_dev;
+        r.step_regularity = held.step_regularity;
+        r.step_symmetry = held.step_symmetry;
+        r.fog_state = held.fog_state;
+        r.freezing_detected = held.freezing_detected;
+        stream.last_step_hz = held.step_hz;
+    }
+
+    // Cadence from this window keys the gait-harmonic canceller for the next
+    harmonic_canceller_retune(stream.canceller, stream.last_step_hz);
+    stream.previous = r;
+    return r;
+}
+
+template DetectWindowResult detect_stream_window_with<RfftBackend>(DetectStream &, const float *,
+                                                                   AnalysisTier);
+template DetectWindowResult detect_stream_window_with<FftComplexBackend>(DetectStream &,
+                                                                         const float *,
+                                                                         AnalysisTier);
+template DetectWindowResult detect_stream_window_with<GoertzelBackend>(DetectStream &,
+                                                                       const float *,
+                                                                       AnalysisTier);
+
+DetectWindowResult detect_stream_window(DetectStream &stream, const float *xyz, AnalysisTier tier) {
+    return detect_stream_window_with<SpectralBackend>(stream, xyz, tier);
+}
@@ -1,8 +1,6 @@
 #include "dsp.h"
-#include "arm_math.h"          // CMSIS-DSP
-
-
-static arm_rfft_fast_instance_f32 rfft_instance;
+#include "spectral_backend.h"
+#include "spectral_kernels.h"  // CMSIS-DSP rfft on the device
 
 // Utility: map [value, max_value] to 0–100 (clamped)
 static uint8_t scale_to_100(float value, float max_value) {
@@ -13,8 +11,9 @@ static uint8_t scale_to_100(float value, float max_value) {
     return static_cast<uint8_t>(r * 100.0f + 0.5f);
 }
 
+// The rfft instance is set up by spectral_kernels() on first use
 void dsp_init() {
-    arm_rfft_fast_init_f32(&rfft_instance, FFT_SIZE);
+    spectral_kernels();
 }
 
 // Compute sum of magnitude spectrum in [f_low, f_high]
@@ -36,28 +35,25 @@ MovementAnalysis dsp_analyze_window(const SignalWindow &window) {
     MovementAnalysis result{0, 0};
 
     // 1. Prepare FFT input with zero-padding
-    static float fft_in[FFT_SIZE];
-    static float fft_out[FFT_SIZE]; // complex output interleaved
+    static SpectralScratch scratch;
 
     for (size_t i = 0; i < FFT_SIZE; ++i) {
         if (i < window.length) {
             // Optionally apply a window (Hann, etc.) here
-            fft_in[i] = window.data[i];
+            scratch.fft_in[i] = window.data[i];
         } else {
-            fft_in[i] = 0.0f;
+            scratch.fft_in[i] = 0.0f;
         }
     }
 
-    // 2. Run real FFT
-    arm_rfft_fast_f32(&rfft_instance, fft_in, fft_out, 0);
+    // 2. Power spectrum from the build's spectral backend
+    SpectralBackend::power_spectrum(scratch);
 
-    // 3. Convert to magnitude spectrum (bins 0..FFT_SIZE/2)
-    static float mag[FFT_SIZE/2 + 1];
-    mag[0] = fabsf(fft_out[0]); // DC component
-    for (size_t k = 1; k <= FFT_SIZE/2; ++k) {
-        float re = fft_out[2*k];
-        float im = fft_out[2*k + 1];
-        mag[k] = sqrtf(re * re + im * im);
+    // 3. Convert to magnitude spectrum (bins 0..FFT_SIZE/2-1; band_power
+    //    never reaches Nyquist)
+    static float mag[FFT_SIZE/2];
+    for (size_t k = 0; k < FFT_SIZE/2; ++k) {
+        mag[k] = sqrtf(scratch.power[k]);
     }
 
     // 4. Compute band powers
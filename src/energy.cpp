@@ -0,0 +1,68 @@
+#include "energy.h"
+
+static EnergyModel model;
+static uint64_t active_us[ENERGY_COUNT];
+static uint32_t uart_baud = 115200;
+
+EnergyModel energy_default_model() {
+    EnergyModel m{};
+    m.current_ma[ENERGY_I2C]        = 10.5f;   // run mode + I2C + LSM6DSL active
+    m.current_ma[ENERGY_DSP]        = 10.0f;   // run mode, FPU busy
+    m.current_ma[ENERGY_UART]       = 3.0f;    // USART + ST-LINK VCP, on top of CPU state
+    m.current_ma[ENERGY_RADIO]      = 8.0f;    // SPBTLE-RF TX/RX air time, on top of CPU state
+    m.current_ma[ENERGY_SLEEP]      = 2.5f;    // sleep mode (WFI), clocks on
+    m.current_ma[ENERGY_DEEP_SLEEP] = 0.3f;    // stop 2 + IMU low-power
+    m.current_ma[ENERGY_CPU_OTHER]  = 9.0f;    // run mode, no peripheral work
+    return m;
+}
+
+void energy_init(const EnergyModel &m, uint32_t baud) {
+    model = m;
+    uart_baud = baud > 0 ? baud : 115200;
+    for (int i = 0; i < ENERGY_COUNT; i++) active_us[i] = 0;
+}
+
+void energy_add_time(EnergySubsystem subsystem, uint32_t us) {
+    if (subsystem >= ENERGY_CPU_OTHER) return;  // derived
+    active_us[subsystem] += us;
+}
+
+void energy_add_uart_bytes(uint32_t bytes) {
+    // 8N1: 10 bit times per byte
+    active_us[ENERGY_UART] += (uint64_t)bytes * 10u * 1000000u / uart_baud;
+}
+
+void energy_set_sleep(uint64_t sleep_us, uint64_t deep_sleep_us) {
+    active_us[ENERGY_SLEEP] = sleep_us;
+    active_us[ENERGY_DEEP_SLEEP] = deep_sleep_us;
+}
+
+EnergyReport energy_report(uint64_t elapsed_us) {
+    return energy_estimate(model, active_us, elapsed_us);
+}
+
+EnergyReport energy_estimate(const EnergyModel &m,
+                             const uint64_t us[ENERGY_COUNT],
+                             uint64_t elapsed_us) {
+    EnergyReport report{};
+    if (elapsed_us == 0) return report;
+
+    // UART transmits from a buffer and the radio module runs its own link
+    // layer while the CPU does other things, so both overlap the other
+    // states and are not subtracted from awake time
+    uint64_t accounted = 0;
+    for (int i = 0; i < ENERGY_CPU_OTHER; i++) {
+        if (i != ENERGY_UART && i != ENERGY_RADIO) accounted += us[i];
+    }
+    uint64_t other_us = elapsed_us > accounted ? elapsed_us - accounted : 0;
+
+    const float US_PER_HOUR = 3600.0f * 1e6f;
+    report.elapsed_h = (float)elapsed_us / US_PER_HOUR;
+    for (int i = 0; i < ENERGY_COUNT; i++) {
+        uint64_t t = (i == ENERGY_CPU_OTHER) ? other_us : us[i];
+        report.mah[i] = m.current_ma[i] * ((float)t / US_PER_HOUR);
+        report.mah_per_hour[i] = report.mah[i] / report.elapsed_h;
+        report.total_mah_per_hour += report.mah_per_hour[i];
+    }
+    return report;
+}
@@ -0,0 +1,179 @@
+#include "flight_recorder.h"
+#include <cstring>
+
+enum RecorderState : uint8_t {
+    FR_RECORDING,      // ring overwrites continuously
+    FR_POST_TRIGGER,   // filling the post-trigger blocks
+    FR_FROZEN,         // snapshot waiting to be read
+};
+
+static uint8_t blocks[FR_TOTAL_BLOCKS][FR_BLOCK_BYTES];
+static size_t  head = 0;            // next block slot to write
+static size_t  filled = 0;          // valid blocks in the ring
+static int16_t staging[FR_BLOCK_SAMPLES][3];
+static uint8_t staging_range[FR_BLOCK_SAMPLES];
+static size_t  staged = 0;
+
+static RecorderState state = FR_RECORDING;
+static size_t  post_remaining = 0;
+static FlightSnapshotHeader header;
+static size_t  read_offset = 0;
+static uint32_t sequence = 0;
+
+static int16_t clamp16(int32_t v) {
+    if (v > 32767) return 32767;
+    if (v < -32768) return -32768;
+    return (int16_t)v;
+}
+
+// Bring every staged sample to the widest range in the block
+static uint8_t rescale_staging() {
+    uint8_t range = 0;
+    for (size_t i = 0; i < FR_BLOCK_SAMPLES; i++) {
+        if (staging_range[i] > range) range = staging_range[i];
+    }
+    for (size_t i = 0; i < FR_BLOCK_SAMPLES; i++) {
+        uint8_t shift = range - staging_range[i];
+        if (shift == 0) continue;
+        for (int axis = 0; axis < 3; axis++) {
+            int32_t v = staging[i][axis];
+            staging[i][axis] = (int16_t)((v + ((1 << shift) >> 1)) >> shift);
+        }
+    }
+    return range;
+}
+
+static void encode_block(uint8_t *out) {
+    uint8_t range = rescale_staging();
+    for (int axis = 0; axis < 3; axis++) {
+        uint8_t *p = out + axis * (FR_BLOCK_BYTES / 3);
+        int16_t key = staging[0][axis];
+        p[0] = (uint8_t)key;
+        p[1] = (uint8_t)(key >> 8);
+
+        // Smallest shift that fits the largest step into int8
+        int32_t max_step = 0;
+        for (size_t i = 1; i < FR_BLOCK_SAMPLES; i++) {
+            int32_t d = staging[i][axis] - staging[i - 1][axis];
+            if (d < 0) d = -d;
+            if (d > max_step) max_step = d;
+        }
+        uint8_t shift = 0;
+        while (shift < 15 && (max_step >> shift) > 127) shift++;
+        p[2] = (uint8_t)(shift | (range << FR_RANGE_SHIFT));
+
+        int32_t recon = key;
+        for (size_t i = 1; i < FR_BLOCK_SAMPLES; i++) {
+            int32_t d = staging[i][axis] - recon;
+            int32_t half = (1 << shift) >> 1;
+            int32_t q = d >= 0 ? (d + half) >> shift : -((-d + half) >> shift);
+            if (q > 127) q = 127;
+            if (q < -127) q = -127;
+            recon = clamp16(recon + q * (1 << shift));
+            p[2 + i] = (uint8_t)(int8_t)q;
+        }
+    }
+}
+
+void flight_recorder_decode_block(const uint8_t *block, int16_t out[FR_BLOCK_SAMPLES][3]) {
+    for (int axis = 0; axis < 3; axis++) {
+        const uint8_t *p = block + axis * (FR_BLOCK_BYTES / 3);
+        int32_t recon = (int16_t)(p[0] | (p[1] << 8));
+        uint8_t shift = p[2] & FR_SHIFT_MASK;
+        out[0][axis] = (int16_t)recon;
+        for (size_t i = 1; i < FR_BLOCK_SAMPLES; i++) {
+            recon = clamp16(recon + (int8_t)p[2 + i] * (1 << shift));
+            out[i][axis] = (int16_t)recon;
+        }
+    }
+}
+
+uint8_t flight_recorder_block_range(const uint8_t *block) {
+    return block[2] >> FR_RANGE_SHIFT;
+}
+
+static void freeze() {
+    size_t count = filled;
+    header.magic[0] = 'F';
+    header.magic[1] = 'R';
+    header.block_samples = FR_BLOCK_SAMPLES;
+    header.block_count = (uint16_t)count;
+    header.trigger_block = (uint16_t)(count - FR_POST_BLOCKS);
+    header.sequence = sequence++;
+    read_offset = 0;
+    state = FR_FROZEN;
+}
+
+void flight_recorder_init() {
+    head = 0;
+    filled = 0;
+    staged = 0;
+    post_remaining = 0;
+    read_offset = 0;
+    state = FR_RECORDING;
+}
+
+void flight_recorder_add_sample(int16_t x, int16_t y, int16_t z, uint8_t range) {
+    if (state == FR_FROZEN) return;
+
+    staging[staged][0] = x;
+    staging[staged][1] = y;
+    staging[staged][2] = z;
+    staging_range[staged] = range;
+    if (++staged < FR_BLOCK_SAMPLES) return;
+    staged = 0;
+
+    encode_block(blocks[head]);
+    head = (head + 1) % FR_TOTAL_BLOCKS;
+    if (filled < FR_TOTAL_BLOCKS) filled++;
+
+    if (state == FR_POST_TRIGGER && --post_remaining == 0) {
+        freeze();
+    }
+}
+
+bool flight_recorder_trigger(uint8_t reason) {
+    if (state != FR_RECORDING) return false;
+    header.reason = reason;
+    // The block in progress becomes the first post-trigger block
+    post_remaining = FR_POST_BLOCKS;
+    state = FR_POST_TRIGGER;
+    return true;
+}
+
+bool flight_recorder_ready() {
+    return state == FR_FROZEN;
+}
+
+size_t flight_recorder_read(uint8_t *out, size_t capacity) {
+    if (state != FR_FROZEN || out == nullptr) return 0;
+
+    const size_t total = sizeof(header) + (size_t)header.block_count * FR_BLOCK_BYTES;
+    // Oldest block sits at head once the ring has wrapped
+    const size_t first = (filled == FR_TOTAL_BLOCKS) ? head : 0;
+
+    size_t copied = 0;
+    while (copied < capacity && read_offset < total) {
+        size_t n;
+        if (read_offset < sizeof(header)) {
+            n = sizeof(header) - read_offset;
+            if (n > capacity - copied) n = capacity - copied;
+            memcpy(out + copied, (const uint8_t *)&header + read_offset, n);
+        } else {
+            size_t pos = read_offset - sizeof(header);
+            size_t block = (first + pos / FR_BLOCK_BYTES) % FR_TOTAL_BLOCKS;
+            size_t within = pos % FR_BLOCK_BYTES;
+            n = FR_BLOCK_BYTES - within;
+            if (n > capacity - copied) n = capacity - copied;
+            memcpy(out + copied, &blocks[block][within], n);
+        }
+        copied += n;
+        read_offset += n;
+    }
+
+    if (read_offset >= total) {
+        // Snapshot delivered: start a fresh pre-trigger history
+        flight_recorder_init();
+    }
+    return copied;
+}
@@ -1,71 +1,23 @@
 #include "gait.h"
 #include "parkinsons_system.h"
-#include <cmath>
+
+static_assert(BUFFER_SIZE == WINDOW_SAMPLES, "detect_core.h window differs from BUFFER_SIZE");
 
 // State tracking for FOG detection
-static float prev_variance = 0.0f;
+static GaitState state = {0.0f};
+
+// Extremely rigid (frozen) threshold; adapted per patient by baseline.cpp
+static float rigid_threshold = GAIT_RIGID_STD_G;
 
 void gait_init() {
-    prev_variance = 0.0f;
+    state.prev_variance = 0.0f;
 }
 
-GaitStatus gait_update(const SignalWindow &window) {
-    GaitStatus status{};
-
-    // Calculate magnitude for each sample
-    float magnitude_sum = 0.0f;
-    float magnitude[BUFFER_SIZE];
-
-    for (int i = 0; i < BUFFER_SIZE; i++) {
-        magnitude[i] = sqrtf(
-            sensor_data.accel_x[i] * sensor_data.accel_x[i] +
-            sensor_data.accel_y[i] * sensor_data.accel_y[i] +
-            sensor_data.accel_z[i] * sensor_data.accel_z[i]
-        );
-        magnitude_sum += magnitude[i];
-    }
-
-    float mean_magnitude = magnitude_sum / BUFFER_SIZE;
-
-    // Calculate variance (motion regularity)
-    float variance = 0.0f;
-    for (int i = 0; i < BUFFER_SIZE; i++) {
-        float diff = magnitude[i] - mean_magnitude;
-        variance += diff * diff;
-    }
-    variance /= BUFFER_SIZE;
-    float std_dev = sqrtf(variance);
-
-    // FOG Detection Logic based on variance and mean magnitude
-    // Low variance + low acceleration = freezing of gait
-    // Normal gait: acceleration magnitude 0.8-1.5g with high variance
-    // FOG state: acceleration magnitude < 0.8g with very low variance
-
-    // Thresholds tuned for Parkinson's freezing detection
-    float low_motion_threshold = 0.8f;    // Below normal gravity + gait
-    float variance_threshold_low = 0.25f; // Very rigid motion
-    float variance_threshold_high = 0.15f; // Extremely rigid (frozen)
-
-    // Condition 1: Very low motion with very low variance = FREEZE
-    if (mean_magnitude < low_motion_threshold && std_dev < variance_threshold_high) {
-        if (prev_variance > variance_threshold_low) {
-            status.fog_state = 1;  // Freeze start (sudden drop to stillness)
-        } else {
-            status.fog_state = 2;  // Sustained freeze
-        }
-    }
-    // Condition 2: Some motion but extremely rigid = FREEZE (tremor/rigidity)
-    else if (std_dev < variance_threshold_high) {
-        status.fog_state = 2;  // Rigid tremorous movement
-    }
-    else {
-        status.fog_state = 0;  // Normal gait
-    }
-
-    // Debug: Uncomment to see FOG detection values
-    // printf("  [FOG] Mean:%.3f StdDev:%.3f PrevVar:%.3f State:%d\r\n",
-    //        mean_magnitude, std_dev, prev_variance, status.fog_state);
+void gait_set_rigid_threshold(float std_dev_g) {
+    rigid_threshold = std_dev_g;
+}
 
-    prev_variance = std_dev;
-    return status;
+GaitStatus gait_update(const SignalWindow &window) {
+    return detect_gait(sensor_data.accel_x, sensor_data.accel_y, sensor_data.accel_z,
+                       rigid_threshold, state);
 }
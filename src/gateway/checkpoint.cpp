@@ -0,0 +1,321 @@
+#include "gateway/checkpoint.h"
+
+#include <cmath>
+#include <cstring>
+
+static const uint8_t CHECKPOINT_MAGIC[4] = {'G', 'W', 'C', 'K'};
+
+static constexpr size_t HEADER_BYTES    = 4 + 2 + 2 + 4;
+static constexpr size_t CANCELLER_BYTES = 7 * 4 + 2 + 1 + 1 + 2 * 4 * (HARMONIC_CANCELLER_MAX + 1);
+static constexpr size_t GAIT_BYTES      = 4 + 4;
+static constexpr size_t HELD_BYTES      = 4 + 8 * 4 + 3;
+static constexpr size_t ACTIVITY_BYTES  = 6 * 4 + 3;
+static constexpr size_t BASELINE_BYTES  = (4 + 4 + 4) * BASELINE_COUNT;
+static constexpr size_t REORDER_BYTES   = 3 * 4 + 1 + 8 + 8;
+static constexpr size_t SLOT_BYTES      = 2 + 8 + 4 + 4 + 1;    // plus bitmap and samples
+static constexpr size_t SAMPLE_BYTES    = 3 * 4;
+static constexpr size_t CRC_BYTES       = 4;
+static constexpr size_t FIXED_BYTES     = HEADER_BYTES + CANCELLER_BYTES + GAIT_BYTES +
+                                          HELD_BYTES + ACTIVITY_BYTES + BASELINE_BYTES + REORDER_BYTES +
+                                          CRC_BYTES;
+
+// Bitwise CRC-32 (IEEE); checkpoints are rare so no table is kept
+static uint32_t crc32(const uint8_t *data, size_t len) {
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int b = 0; b < 8; b++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
+
+// === Little-endian writer / reader ===
+static uint8_t *put_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    return p + 2;
+}
+
+static uint8_t *put_u32(uint8_t *p, uint32_t v) {
+    p = put_u16(p, (uint16_t)v);
+    return put_u16(p, (uint16_t)(v >> 16));
+}
+
+static uint8_t *put_u64(uint8_t *p, uint64_t v) {
+    p = put_u32(p, (uint32_t)v);
+    return put_u32(p, (uint32_t)(v >> 32));
+}
+
+static uint8_t *put_f32(uint8_t *p, float v) {
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    return put_u32(p, bits);
+}
+
+static uint16_t get_u16(const uint8_t *&p) {
+    uint16_t v = (uint16_t)(p[0] | (p[1] << 8));
+    p += 2;
+    return v;
+}
+
+static uint32_t get_u32(const uint8_t *&p) {
+    uint32_t lo = get_u16(p);
+    uint32_t hi = get_u16(p);
+    return lo | (hi << 16);
+}
+
+static uint64_t get_u64(const uint8_t *&p) {
+    uint64_t lo = get_u32(p);
+    uint64_t hi = get_u32(p);
+    return lo | (hi << 32);
+}
+
+static float get_f32(const uint8_t *&p) {
+    uint32_t bits = get_u32(p);
+    float v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+static uint32_t used_slots(const ReorderBuffer &reorder) {
+    uint32_t n = 0;
+    for (const ReorderSlot &s : reorder.slots) n += s.window >= 0;
+    return n;
+}
+
+size_t checkpoint_size(const ReorderBuffer &reorder) {
+    size_t bytes = FIXED_BYTES;
+    for (const ReorderSlot &s : reorder.slots) {
+        if (s.window < 0) continue;
+        bytes += SLOT_BYTES + reorder.bitmap_words * 8 + (size_t)s.present * SAMPLE_BYTES;
+    }
+    return bytes;
+}
+
+size_t checkpoint_save(const DetectStream &stream, const ReorderBuffer &reorder,
+                       uint8_t *out, size_t capacity) {
+    const size_t total = checkpoint_size(reorder);
+    if (out == nullptr || capacity < total) return 0;
+
+    uint8_t *p = out;
+    memcpy(p, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+    p += sizeof(CHECKPOINT_MAGIC);
+    p = put_u16(p, CHECKPOINT_VERSION);
+    p = put_u16(p, (uint16_t)used_slots(reorder));
+    p = put_u32(p, reorder.stream_id);
+
+    const HarmonicCanceller &c = stream.canceller;
+    p = put_f32(p, c.fs);
+    p = put_f32(p, c.band_low);
+    p = put_f32(p, c.band_high);
+    p = put_f32(p, c.ph_re);
+    p = put_f32(p, c.ph_im);
+    p = put_f32(p, c.rot_re);
+    p = put_f32(p, c.rot_im);
+    p = put_u16(p, (uint16_t)c.renorm_count);
+    *p++ = c.enabled ? 1 : 0;
+    uint8_t active = 0;
+    for (int h = 0; h <= HARMONIC_CANCELLER_MAX; h++) active |= c.active[h] ? (uint8_t)(1u << h) : 0;
+    *p++ = active;
+    for (int h = 0; h <= HARMONIC_CANCELLER_MAX; h++) p = put_f32(p, c.w_re[h]);
+    for (int h = 0; h <= HARMONIC_CANCELLER_MAX; h++) p = put_f32(p, c.w_im[h]);
+
+    p = put_f32(p, stream.gait.prev_variance);
+    p = put_f32(p, stream.last_step_hz);
+
+    const DetectWindowResult &held = stream.previous;
+    p = put_u32(p, stream.windows);
+    p = put_f32(p, held.tremor_intensity);
+    p = put_f32(p, held.dyskinesia_intensity);
+    p = put_f32(p, held.step_hz);
+    p = put_f32(p, held.std_dev);
+    p = put_f32(p, held.step_regularity);
+    p = put_f32(p, held.step_symmetry);
+    p = put_f32(p, held.tremor_coherence);
+    p = put_f32(p, held.tremor_linearity);
+    *p++ = held.fog_state;
+    *p++ = held.activity;
+    *p++ = (held.tremor_detected ? 0x01 : 0) | (held.dyskinesia_detected ? 0x02 : 0) |
+           (held.freezing_detected ? 0x04 : 0);
+
+    const ActivityState &a = stream.activity;
+    p = put_f32(p, a.gravity_alpha);
+    p = put_f32(p, a.motion_alpha);
+    for (int i = 0; i < 3; i++) p = put_f32(p, a.gravity[i]);
+    p = put_f32(p, a.motion_power);
+    *p++ = a.context;
+    *p++ = a.candidate;
+    *p++ = (uint8_t)a.candidate_windows;
+
+    for (int m = 0; m < BASELINE_COUNT; m++) {
+        p = put_f32(p, stream.baseline.metrics[m].estimate);
+        p = put_f32(p, stream.baseline.metrics[m].spread);
+        p = put_u32(p, stream.baseline.metrics[m].count);
+    }
+
+    const ReorderConfig &config = reorder.config;
+    p = put_u32(p, config.window_samples);
+    p = put_u32(p, config.retain_windows);
+    p = put_u32(p, config.lateness_samples);
+    *p++ = reorder.started ? 1 : 0;
+    p = put_u64(p, (uint64_t)reorder.high_seq);
+    p = put_u64(p, (uint64_t)reorder.next_close);
+    for (uint32_t slot = 0; slot < config.retain_windows; slot++) {
+        const ReorderSlot &s = reorder.slots[slot];
+        if (s.window < 0) continue;
+        p = put_u16(p, (uint16_t)slot);
+        p = put_u64(p, (uint64_t)s.window);
+        p = put_u32(p, s.present);
+        p = put_u32(p, s.revision);
+        *p++ = (s.emitted ? 0x01 : 0) | (s.dirty ? 0x02 : 0);
+        const uint64_t *bits = &reorder.present_bits[(size_t)slot * reorder.bitmap_words];
+        for (uint32_t w = 0; w < reorder.bitmap_words; w++) p = put_u64(p, bits[w]);
+        // Raw float bits: batches may have been scaled at different ranges
+        const size_t base = (size_t)slot * config.window_samples;
+        for (uint32_t i = 0; i < config.window_samples; i++) {
+            if (!(bits[i / 64] >> (i % 64) & 1)) continue;
+            p = put_f32(p, reorder.accel_x[base + i]);
+            p = put_f32(p, reorder.accel_y[base + i]);
+            p = put_f32(p, reorder.accel_z[base + i]);
+        }
+    }
+
+    p = put_u32(p, crc32(out, (size_t)(p - out)));
+    return (size_t)(p - out);
+}
+
+bool checkpoint_restore(const uint8_t *in, size_t length, DetectStream &stream,
+                        ReorderBuffer &reorder) {
+    if (in == nullptr || length < FIXED_BYTES) return false;
+    if (memcmp(in, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) != 0) return false;
+
+    const uint8_t *crc_at = in + length - CRC_BYTES;
+    if (get_u32(crc_at) != crc32(in, length - CRC_BYTES)) return false;
+    const uint8_t *end = in + length - CRC_BYTES;
+
+    const uint8_t *p = in + sizeof(CHECKPOINT_MAGIC);
+    if (get_u16(p) != CHECKPOINT_VERSION) return false;
+    const uint16_t slot_count = get_u16(p);
+    const uint32_t stream_id = get_u32(p);
+
+    HarmonicCanceller c;
+    c.fs = get_f32(p);
+    c.band_low = get_f32(p);
+    c.band_high = get_f32(p);
+    c.ph_re = get_f32(p);
+    c.ph_im = get_f32(p);
+    c.rot_re = get_f32(p);
+    c.rot_im = get_f32(p);
+    c.renorm_count = get_u16(p);
+    c.enabled = *p++ != 0;
+    const uint8_t active = *p++;
+    for (int h = 0; h <= HARMONIC_CANCELLER_MAX; h++) c.active[h] = (active >> h) & 1;
+    for (int h = 0; h <= HARMONIC_CANCELLER_MAX; h++) c.w_re[h] = get_f32(p);
+    for (int h = 0; h <= HARMONIC_CANCELLER_MAX; h++) c.w_im[h] = get_f32(p);
+
+    GaitState gait;
+    gait.prev_variance = get_f32(p);
+    const float last_step_hz = get_f32(p);
+
+    const uint32_t windows = get_u32(p);
+    DetectWindowResult held = {};
+    held.tremor_intensity = get_f32(p);
+    held.dyskinesia_intensity = get_f32(p);
+    held.step_hz = get_f32(p);
+    held.std_dev = get_f32(p);
+    held.step_regularity = get_f32(p);
+    held.step_symmetry = get_f32(p);
+    held.tremor_coherence = get_f32(p);
+    held.tremor_linearity = get_f32(p);
+    held.fog_state = *p++;
+    held.activity = (ActivityContext)*p++;
+    const uint8_t detected = *p++;
+    held.tremor_detected = (detected & 0x01) != 0;
+    held.dyskinesia_detected = (detected & 0x02) != 0;
+    held.freezing_detected = (detected & 0x04) != 0;
+    if (held.activity >= ACTIVITY_COUNT) return false;
+
+    ActivityState a;
+    a.gravity_alpha = get_f32(p);
+    a.motion_alpha = get_f32(p);
+    for (int i = 0; i < 3; i++) a.gravity[i] = get_f32(p);
+    a.motion_power = get_f32(p);
+    a.context = (ActivityContext)*p++;
+    a.candidate = (ActivityContext)*p++;
+    a.candidate_windows = *p++;
+    if (a.context >= ACTIVITY_COUNT || a.candidate >= ACTIVITY_COUNT) return false;
+
+    BaselineState baseline;
+    for (int m = 0; m < BASELINE_COUNT; m++) {
+        baseline.metrics[m].estimate = get_f32(p);
+        baseline.metrics[m].spread = get_f32(p);
+        baseline.metrics[m].count = get_u32(p);
+    }
+
+    ReorderConfig config;
+    config.window_samples = get_u32(p);
+    config.retain_windows = get_u32(p);
+    config.lateness_samples = get_u32(p);
+    if (config.window_samples == 0 || config.retain_windows < 2 ||
+        config.lateness_samples > (config.retain_windows - 1) * config.window_samples ||
+        slot_count > config.retain_windows) {
+        return false;
+    }
+    ReorderBuffer r;
+    reorder_init(r, config, stream_id);
+    r.started = *p++ != 0;
+    r.high_seq = (int64_t)get_u64(p);
+    r.next_close = (int64_t)get_u64(p);
+
+    const size_t bitmap_bytes = (size_t)r.bitmap_words * 8;
+    for (uint16_t n = 0; n < slot_count; n++) {
+        if ((size_t)(end - p) < SLOT_BYTES + bitmap_bytes) return false;
+        const uint16_t slot = get_u16(p);
+        ReorderSlot s;
+        s.window = (int64_t)get_u64(p);
+        s.present = get_u32(p);
+        s.revision = get_u32(p);
+        const uint8_t flags = *p++;
+        s.emitted = (flags & 0x01) != 0;
+        s.dirty = (flags & 0x02) != 0;
+        if (slot >= config.retain_windows || s.window < 0 ||
+            s.window % config.retain_windows != slot || r.slots[slot].window >= 0) {
+            return false;
+        }
+
+        uint64_t *bits = &r.present_bits[(size_t)slot * r.bitmap_words];
+        uint32_t present = 0;
+        for (uint32_t w = 0; w < r.bitmap_words; w++) {
+            bits[w] = get_u64(p);
+            present += (uint32_t)__builtin_popcountll(bits[w]);
+        }
+        const uint32_t tail = config.window_samples % 64;
+        if (tail && bits[r.bitmap_words - 1] >> tail) return false;
+        if (present != s.present || (size_t)(end - p) < (size_t)present * SAMPLE_BYTES) return false;
+
+        const size_t base = (size_t)slot * config.window_samples;
+        for (uint32_t i = 0; i < config.window_samples; i++) {
+            if (!(bits[i / 64] >> (i % 64) & 1)) continue;
+            float x = get_f32(p), y = get_f32(p), z = get_f32(p);
+            r.accel_x[base + i] = x;
+            r.accel_y[base + i] = y;
+            r.accel_z[base + i] = z;
+            r.accel_total[base + i] = sqrtf(x * x + y * y + z * z);
+        }
+        r.slots[slot] = s;
+    }
+    if (p != end) return false;
+
+    // Validated - now commit to the stream
+    stream.canceller = c;
+    stream.gait = gait;
+    stream.activity = a;
+    stream.baseline = baseline;
+    stream.last_step_hz = last_step_hz;
+    stream.windows = windows;
+    stream.previous = held;
+    reorder = std::move(r);
+    return true;
+}
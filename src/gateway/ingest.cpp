@@ -0,0 +1,319 @@
+#include "gateway/ingest.h"
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <utility>
+
+static uint16_t get_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void put_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static uint32_t steady_ms() {
+    return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+IngestConfig ingest_default_config(uint16_t port) {
+    IngestConfig c;
+    c.port = port;
+    c.batch = 64;
+    c.reuseport = false;
+    c.send_acks = true;
+    c.reorder = reorder_default_config();
+    c.lsb_to_g = 0.061f / 1000.0f;
+    // A full detect_stream_window() is ~10 us on a desktop core; shed once
+    // windows take 100x that or 8 receive batches in a row came back full
+    c.load_shed = LoadShedConfig{1000, 8, 0, 10};
+    return c;
+}
+
+// recvmmsg()/sendmmsg() bookkeeping lives in one allocation per worker
+struct MmsgArrays {
+    mmsghdr *rx;
+    iovec *rx_iov;
+    sockaddr_in *peers;
+    mmsghdr *tx;
+    iovec *tx_iov;
+};
+
+static MmsgArrays mmsg_arrays(IngestWorker &worker) {
+    const unsigned n = worker.config.batch;
+    uint8_t *p = worker.mmsg_storage.data();
+    MmsgArrays a;
+    a.rx = (mmsghdr *)p;
+    p += n * sizeof(mmsghdr);
+    a.tx = (mmsghdr *)p;
+    p += n * sizeof(mmsghdr);
+    a.rx_iov = (iovec *)p;
+    p += n * sizeof(iovec);
+    a.tx_iov = (iovec *)p;
+    p += n * sizeof(iovec);
+    a.peers = (sockaddr_in *)p;
+    return a;
+}
+
+void ingest_init(IngestWorker &worker, const IngestConfig &config) {
+    worker.config = config;
+    worker.fd = -1;
+    if (worker.config.batch == 0) worker.config.batch = 1;
+    worker.stats = IngestStats{};
+    worker.on_window = nullptr;
+    worker.window_context = nullptr;
+    load_shed_init(worker.load_shed, worker.config.load_shed);
+    worker.backlog = 0;
+    worker.streams.clear();
+    worker.stream_timers.clear();
+    worker.now_ms = 0;
+    timer_wheel_init(worker.timers, 0);
+
+    const unsigned n = worker.config.batch;
+    worker.rx_buffers.assign((size_t)n * INGEST_MAX_DATAGRAM, 0);
+    worker.ack_buffers.assign((size_t)n * INGEST_ACK_BYTES, 0);
+    worker.mmsg_storage.assign(n * (2 * sizeof(mmsghdr) + 2 * sizeof(iovec) + sizeof(sockaddr_in)), 0);
+
+    // Receive headers point at fixed buffers once; recvmmsg() only
+    // updates lengths, so nothing is rebuilt per poll
+    MmsgArrays a = mmsg_arrays(worker);
+    for (unsigned i = 0; i < n; i++) {
+        a.rx_iov[i].iov_base = &worker.rx_buffers[(size_t)i * INGEST_MAX_DATAGRAM];
+        a.rx_iov[i].iov_len = INGEST_MAX_DATAGRAM;
+        a.rx[i].msg_hdr.msg_iov = &a.rx_iov[i];
+        a.rx[i].msg_hdr.msg_iovlen = 1;
+        a.rx[i].msg_hdr.msg_name = &a.peers[i];
+        a.rx[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+    }
+}
+
+bool ingest_open(IngestWorker &worker, const IngestConfig &config) {
+    ingest_init(worker, config);
+    worker.now_ms = steady_ms();
+    timer_wheel_init(worker.timers, worker.now_ms);
+    worker.fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (worker.fd < 0) return false;
+
+    int one = 1;
+    if (worker.config.reuseport &&
+        setsockopt(worker.fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) != 0) {
+        ingest_close(worker);
+        return false;
+    }
+    int rcvbuf = 8 << 20;
+    setsockopt(worker.fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(worker.config.port);
+    if (bind(worker.fd, (sockaddr *)&addr, sizeof(addr)) != 0) {
+        int err = errno;
+        ingest_close(worker);
+        errno = err;
+        return false;
+    }
+    return true;
+}
+
+void ingest_close(IngestWorker &worker) {
+    if (worker.fd >= 0) close(worker.fd);
+    worker.fd = -1;
+}
+
+ReorderBuffer *ingest_stream(IngestWorker &worker, uint32_t stream_id) {
+    auto it = worker.streams.find(stream_id);
+    return it == worker.streams.end() ? nullptr : &it->second;
+}
+
+// A window should close every hop; firing means it is late. If the stall
+// timer is due no later, batches stopped coming and the stall reports it.
+static void on_hop_deadline(TimerNode &node) {
+    IngestStreamTimers &timers = *(IngestStreamTimers *)node.context;
+    if ((int32_t)(timers.stall.expires - node.expires) <= 0) return;
+    timers.worker->stats.hop_misses++;
+    timer_wheel_schedule(timers.worker->timers, node, node.expires + HOP_PERIOD_MS);
+}
+
+// No batch within the stall timeout: stop expecting windows until one arrives
+static void on_stream_stall(TimerNode &node) {
+    IngestStreamTimers &timers = *(IngestStreamTimers *)node.context;
+    timers.worker->stats.stalls++;
+    timers.stalled = true;
+    timer_wheel_cancel(timers.worker->timers, timers.hop);
+}
+
+static void arm_stream_timers(IngestWorker &worker, uint32_t stream_id) {
+    auto it = worker.stream_timers.find(stream_id);
+    if (it == worker.stream_timers.end()) {
+        it = worker.stream_timers.emplace(stream_id, IngestStreamTimers()).first;
+        IngestStreamTimers &timers = it->second;
+        timer_node_init(timers.hop, on_hop_deadline, &timers);
+        timer_node_init(timers.stall, on_stream_stall, &timers);
+        timers.worker = &worker;
+        timers.stream_id = stream_id;
+    }
+    IngestStreamTimers &timers = it->second;
+    timers.stalled = false;
+    timer_wheel_schedule(worker.timers, timers.stall, worker.now_ms + SENSOR_STALL_MS);
+    if (!timer_node_pending(timers.hop)) {
+        timer_wheel_schedule(worker.timers, timers.hop,
+                             worker.now_ms + HOP_PERIOD_MS + HOP_DEADLINE_SLACK_MS);
+    }
+}
+
+void ingest_advance(IngestWorker &worker, uint32_t now_ms) {
+    worker.now_ms = now_ms;
+    timer_wheel_advance(worker.timers, now_ms);
+}
+
+void ingest_forget(IngestWorker &worker, uint32_t stream_id) {
+    auto it = worker.stream_timers.find(stream_id);
+    if (it != worker.stream_timers.end()) {
+        timer_wheel_cancel(worker.timers, it->second.hop);
+        timer_wheel_cancel(worker.timers, it->second.stall);
+        worker.stream_timers.erase(it);
+    }
+    worker.streams.erase(stream_id);
+}
+
+void ingest_adopt(IngestWorker &worker, ReorderBuffer &&buffer) {
+    const uint32_t stream_id = buffer.stream_id;
+    worker.streams[stream_id] = std::move(buffer);
+    arm_stream_timers(worker, stream_id);
+}
+
+// Reorder emits land here: re-arm the hop deadline on a first emission,
+// analyse at the stream's tier and feed the handler's run time and the
+// receive backlog back to load shedding
+static void deliver_window(void *context, const ReorderView &view) {
+    IngestWorker &worker = *(IngestWorker *)context;
+    if (view.revision == 0) {
+        auto it = worker.stream_timers.find(view.stream_id);
+        if (it != worker.stream_timers.end() && !it->second.stalled) {
+            timer_wheel_schedule(worker.timers, it->second.hop,
+                                 worker.now_ms + HOP_PERIOD_MS + HOP_DEADLINE_SLACK_MS);
+        }
+    }
+    if (!worker.on_window) return;
+    const AnalysisTier tier = load_shed_tier(worker.load_shed, view.stream_id);
+    auto t0 = std::chrono::steady_clock::now();
+    worker.on_window(worker.window_context, view, tier);
+    uint32_t us = (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+                      std::chrono::steady_clock::now() - t0).count();
+    load_shed_observe(worker.load_shed, worker.backlog, us);
+    load_shed_account(worker.load_shed, tier);
+}
+
+bool ingest_datagram(IngestWorker &worker, const uint8_t *data, size_t length) {
+    if (length < INGEST_HEADER_BYTES || get_u16(data) != INGEST_MAGIC ||
+        data[2] != INGEST_VERSION || data[3] != INGEST_KIND_SAMPLES) {
+        worker.stats.malformed++;
+        return false;
+    }
+    const uint32_t stream_id = get_u32(data + 4);
+    const uint32_t first_seq = get_u32(data + 8);
+    const uint32_t count = get_u16(data + 12);
+    const uint16_t range = get_u16(data + 14);
+    if (length < INGEST_HEADER_BYTES + (size_t)count * 6 || range >= INGEST_RANGE_COUNT) {
+        worker.stats.malformed++;
+        return false;
+    }
+
+    auto it = worker.streams.find(stream_id);
+    if (it == worker.streams.end()) {
+        it = worker.streams.emplace(stream_id, ReorderBuffer()).first;
+        reorder_init(it->second, worker.config.reorder, stream_id);
+    }
+    arm_stream_timers(worker, stream_id);
+    reorder_insert(it->second, first_seq, data + INGEST_HEADER_BYTES, count, range,
+                   worker.config.lsb_to_g, deliver_window, &worker);
+    worker.stats.samples += count;
+    worker.stats.datagrams++;
+    return true;
+}
+
+int ingest_poll(IngestWorker &worker, int timeout_ms) {
+    pollfd pfd = {worker.fd, POLLIN, 0};
+    int ready = poll(&pfd, 1, timeout_ms);
+    ingest_advance(worker, steady_ms());
+    if (ready <= 0) return ready;
+
+    MmsgArrays a = mmsg_arrays(worker);
+    const unsigned n = worker.config.batch;
+    for (unsigned i = 0; i < n; i++) {
+        a.rx[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+    }
+    int got = recvmmsg(worker.fd, a.rx, n, MSG_DONTWAIT, nullptr);
+    worker.stats.syscalls++;
+    if (got < 0) return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+    // A full batch means more datagrams were queued behind it
+    worker.backlog = got == (int)n ? worker.backlog + 1 : 0;
+
+    unsigned acks = 0;
+    for (int i = 0; i < got; i++) {
+        const uint8_t *data = (const uint8_t *)a.rx_iov[i].iov_base;
+        if (!ingest_datagram(worker, data, a.rx[i].msg_len) || !worker.config.send_acks) continue;
+
+        uint8_t *ack = &worker.ack_buffers[(size_t)acks * INGEST_ACK_BYTES];
+        put_u16(ack, INGEST_MAGIC);
+        ack[2] = INGEST_VERSION;
+        ack[3] = INGEST_KIND_ACK;
+        memcpy(ack + 4, data + 4, 10);                // stream_id, first_seq, count
+        put_u16(ack + 14, 0);
+        a.tx_iov[acks].iov_base = ack;
+        a.tx_iov[acks].iov_len = INGEST_ACK_BYTES;
+        memset(&a.tx[acks], 0, sizeof(mmsghdr));
+        a.tx[acks].msg_hdr.msg_iov = &a.tx_iov[acks];
+        a.tx[acks].msg_hdr.msg_iovlen = 1;
+        a.tx[acks].msg_hdr.msg_name = &a.peers[i];
+        a.tx[acks].msg_hdr.msg_namelen = a.rx[i].msg_hdr.msg_namelen;
+        acks++;
+    }
+    if (acks > 0) {
+        int sent = sendmmsg(worker.fd, a.tx, acks, MSG_DONTWAIT);
+        worker.stats.syscalls++;
+        if (sent > 0) worker.stats.acks_sent += sent;
+    }
+    return got;
+}
+
+size_t ingest_encode_samples(uint8_t *out, size_t capacity, uint32_t stream_id,
+                             uint32_t first_seq, const int16_t (*xyz)[3], uint16_t count,
+                             uint16_t range) {
+    size_t bytes = INGEST_HEADER_BYTES + (size_t)count * 6;
+    if (bytes > capacity || count > INGEST_MAX_SAMPLES || range >= INGEST_RANGE_COUNT) return 0;
+    put_u16(out, INGEST_MAGIC);
+    out[2] = INGEST_VERSION;
+    out[3] = INGEST_KIND_SAMPLES;
+    put_u32(out + 4, stream_id);
+    put_u32(out + 8, first_seq);
+    put_u16(out + 12, count);
+    put_u16(out + 14, range);
+    uint8_t *p = out + INGEST_HEADER_BYTES;
+    for (uint16_t i = 0; i < count; i++, p += 6) {
+        put_u16(p, (uint16_t)xyz[i][0]);
+        put_u16(p + 2, (uint16_t)xyz[i][1]);
+        put_u16(p + 4, (uint16_t)xyz[i][2]);
+    }
+    return bytes;
+}
@@ -0,0 +1,212 @@
+#include "gateway/reorder.h"
+
+#include <cmath>
+#include <cstring>
+
+static const uint32_t SAMPLE_RATE_HZ = 52;
+
+ReorderConfig reorder_default_config() {
+    ReorderConfig c;
+    c.window_samples = 156;
+    c.lateness_samples = 26;      // one FIFO watermark batch
+    // Every window within the backfill horizon of the newest sample, plus
+    // the open window and the one the lateness grace keeps open: 32 slots
+    const uint32_t horizon = REORDER_BACKFILL_HORIZON_S * SAMPLE_RATE_HZ;
+    c.retain_windows = (horizon + c.window_samples - 1) / c.window_samples + 2;
+    return c;
+}
+
+void reorder_init(ReorderBuffer &buffer, const ReorderConfig &config, uint32_t stream_id) {
+    buffer.config = config;
+    if (buffer.config.window_samples == 0) buffer.config.window_samples = 1;
+    if (buffer.config.retain_windows < 2) buffer.config.retain_windows = 2;
+    // An open window must never be evicted by the lateness grace alone
+    uint32_t max_lateness = (buffer.config.retain_windows - 1) * buffer.config.window_samples;
+    if (buffer.config.lateness_samples > max_lateness) buffer.config.lateness_samples = max_lateness;
+
+    const size_t samples = (size_t)buffer.config.retain_windows * buffer.config.window_samples;
+    buffer.stream_id = stream_id;
+    buffer.accel_x.assign(samples, 0.0f);
+    buffer.accel_y.assign(samples, 0.0f);
+    buffer.accel_z.assign(samples, 0.0f);
+    buffer.accel_total.assign(samples, 0.0f);
+    buffer.bitmap_words = (buffer.config.window_samples + 63) / 64;
+    buffer.present_bits.assign((size_t)buffer.config.retain_windows * buffer.bitmap_words, 0);
+    buffer.slots.assign(buffer.config.retain_windows, ReorderSlot{-1, 0, 0, false, false});
+    buffer.started = false;
+    buffer.high_seq = 0;
+    buffer.next_close = 0;
+    buffer.stats = ReorderStats{};
+}
+
+size_t reorder_memory_bytes(const ReorderBuffer &buffer) {
+    return sizeof(ReorderBuffer) +
+           4 * buffer.accel_x.capacity() * sizeof(float) +
+           buffer.present_bits.capacity() * sizeof(uint64_t) +
+           buffer.slots.capacity() * sizeof(ReorderSlot);
+}
+
+static uint32_t slot_of(const ReorderBuffer &buffer, int64_t window) {
+    return (uint32_t)(window % buffer.config.retain_windows);
+}
+
+static void emit_slot(ReorderBuffer &buffer, uint32_t slot, ReorderEmitFn emit, void *context) {
+    ReorderSlot &s = buffer.slots[slot];
+    const size_t base = (size_t)slot * buffer.config.window_samples;
+    if (emit) {
+        ReorderView view;
+        view.stream_id = buffer.stream_id;
+        view.window = s.window;
+        view.present = s.present;
+        view.revision = s.revision;
+        view.accel_x = &buffer.accel_x[base];
+        view.accel_y = &buffer.accel_y[base];
+        view.accel_z = &buffer.accel_z[base];
+        view.accel_total = &buffer.accel_total[base];
+        view.size = buffer.config.window_samples;
+        emit(context, view);
+    }
+    if (s.emitted) buffer.stats.revisions_emitted++;
+    else buffer.stats.windows_emitted++;
+    s.emitted = true;
+    s.dirty = false;
+}
+
+// Emit every window below `target` that has not been emitted yet. Only the
+// retained slots can hold data, so a huge forward jump costs at most one
+// pass over the ring.
+static void close_before(ReorderBuffer &buffer, int64_t target, ReorderEmitFn emit, void *context) {
+    const int64_t limit = buffer.next_close + buffer.config.retain_windows;
+    for (int64_t w = buffer.next_close; w < target && w < limit; w++) {
+        uint32_t slot = slot_of(buffer, w);
+        ReorderSlot &s = buffer.slots[slot];
+        if (s.window != w) {
+            buffer.stats.windows_skipped++;
+            continue;
+        }
+        if (!s.emitted) emit_slot(buffer, slot, emit, context);
+    }
+    if (target > buffer.next_close) buffer.next_close = target;
+}
+
+static void open_slot(ReorderBuffer &buffer, uint32_t slot, int64_t window) {
+    const size_t base = (size_t)slot * buffer.config.window_samples;
+    const size_t n = buffer.config.window_samples;
+    memset(&buffer.accel_x[base], 0, n * sizeof(float));
+    memset(&buffer.accel_y[base], 0, n * sizeof(float));
+    memset(&buffer.accel_z[base], 0, n * sizeof(float));
+    memset(&buffer.accel_total[base], 0, n * sizeof(float));
+    memset(&buffer.present_bits[(size_t)slot * buffer.bitmap_words], 0,
+           buffer.bitmap_words * sizeof(uint64_t));
+    buffer.slots[slot] = ReorderSlot{window, 0, 0, false, false};
+}
+
+static void emit_dirty(ReorderBuffer &buffer, bool partial, ReorderEmitFn emit, void *context) {
+    const int64_t oldest = buffer.next_close - buffer.config.retain_windows;
+    for (int64_t w = oldest < 0 ? 0 : oldest; w < buffer.next_close; w++) {
+        uint32_t slot = slot_of(buffer, w);
+        ReorderSlot &s = buffer.slots[slot];
+        if (s.window != w || !s.dirty) continue;
+        if (!partial && s.present != buffer.config.window_samples) continue;
+        if (s.emitted) s.revision++;
+        emit_slot(buffer, slot, emit, context);
+    }
+}
+
+static int16_t get_i16(const uint8_t *p) {
+    return (int16_t)(p[0] | (p[1] << 8));
+}
+
+void reorder_insert(ReorderBuffer &buffer, uint32_t first_seq, const uint8_t *samples,
+                    uint32_t count, unsigned range, float lsb_to_g, ReorderEmitFn emit,
+                    void *context) {
+    if (count == 0) return;
+    // Backfilled batches keep the range they were captured at, so the scale
+    // is per batch rather than per stream
+    const float sensitivity = lsb_to_g * (float)(1u << range);
+    const int64_t size = buffer.config.window_samples;
+    const int64_t retain = buffer.config.retain_windows;
+
+    if (!buffer.started) {
+        buffer.started = true;
+        buffer.high_seq = first_seq;
+        buffer.next_close = first_seq / size;
+    }
+    // Widen against the highest sequence seen: within +-2^31 samples
+    // (about 1.3 years at 52 Hz) of the live position
+    int64_t seq = buffer.high_seq + (int32_t)(first_seq - (uint32_t)buffer.high_seq);
+    bool revised = false;
+
+    for (uint32_t i = 0; i < count; i++, seq++, samples += 6) {
+        if (seq < 0) {
+            buffer.stats.too_late++;
+            continue;
+        }
+        const int64_t window = seq / size;
+        if (window >= buffer.next_close + retain) {
+            // Running ahead of the ring: force-close the windows it evicts
+            close_before(buffer, window - retain + 1, emit, context);
+        }
+        const uint32_t slot = slot_of(buffer, window);
+        ReorderSlot &s = buffer.slots[slot];
+        if (s.window != window) {
+            if (s.window > window) {
+                // Slot already reused by a newer window
+                buffer.stats.too_late++;
+                continue;
+            }
+            if (s.dirty) {
+                // Evicting a closed window with pending late samples
+                if (s.emitted) s.revision++;
+                emit_slot(buffer, slot, emit, context);
+            }
+            open_slot(buffer, slot, window);
+        }
+
+        const uint32_t offset = (uint32_t)(seq - window * size);
+        uint64_t &word = buffer.present_bits[(size_t)slot * buffer.bitmap_words + offset / 64];
+        const uint64_t bit = 1ull << (offset % 64);
+        if (word & bit) {
+            buffer.stats.duplicates++;
+            continue;
+        }
+        word |= bit;
+        s.present++;
+
+        const size_t idx = (size_t)slot * size + offset;
+        float x = get_i16(samples) * sensitivity;
+        float y = get_i16(samples + 2) * sensitivity;
+        float z = get_i16(samples + 4) * sensitivity;
+        buffer.accel_x[idx] = x;
+        buffer.accel_y[idx] = y;
+        buffer.accel_z[idx] = z;
+        buffer.accel_total[idx] = sqrtf(x * x + y * y + z * z);
+        buffer.stats.accepted++;
+
+        if (window < buffer.next_close) {
+            // Closed already: either emitted, or skipped while still empty
+            s.dirty = true;
+            revised = true;
+            buffer.stats.late_accepted++;
+        }
+        if (seq + 1 > buffer.high_seq) buffer.high_seq = seq + 1;
+    }
+
+    // Close windows the grace period has passed
+    int64_t closable = (buffer.high_seq - (int64_t)buffer.config.lateness_samples) / size;
+    if (buffer.high_seq >= (int64_t)buffer.config.lateness_samples) {
+        close_before(buffer, closable, emit, context);
+    }
+
+    // Re-analyse only the windows this batch completed, oldest first.
+    // Partially backfilled windows wait for their remaining batches, or
+    // are re-emitted as they are when their slot is reused or on flush.
+    if (revised) emit_dirty(buffer, false, emit, context);
+}
+
+void reorder_flush(ReorderBuffer &buffer, ReorderEmitFn emit, void *context) {
+    if (!buffer.started) return;
+    emit_dirty(buffer, true, emit, context);
+    close_before(buffer, (buffer.high_seq + buffer.config.window_samples - 1) /
+                             buffer.config.window_samples, emit, context);
+}
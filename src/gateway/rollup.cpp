@@ -0,0 +1,227 @@
+#include "gateway/rollup.h"
+#include "session_log.h"
+
+#include <cstring>
+
+static const int64_t SECONDS_PER_DAY = 86400;
+
+static int64_t floor_div(int64_t a, int64_t b) {
+    int64_t q = a / b;
+    return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+void rollup_init(RollupStore &store) {
+    store.patients.clear();
+    store.updates = 0;
+    store.corrections = 0;
+    store.stale = 0;
+    store.too_old = 0;
+}
+
+static PatientRollup &patient_for(RollupStore &store, uint32_t patient) {
+    auto it = store.patients.find(patient);
+    if (it != store.patients.end()) return it->second;
+    PatientRollup &p = store.patients[patient];
+    p.utc_offset_s = 0;
+    p.first_day = 0;
+    p.first_week = 0;
+    p.recent.assign(ROLLUP_RECENT_WINDOWS, RollupRecent{-1, 0, 0});
+    p.high_window = -1;
+    return p;
+}
+
+void rollup_set_utc_offset(RollupStore &store, uint32_t patient, int32_t utc_offset_s) {
+    patient_for(store, patient).utc_offset_s = utc_offset_s;
+}
+
+static int32_t local_day(const PatientRollup &p, int64_t unix_s) {
+    return (int32_t)floor_div(unix_s + p.utc_offset_s, SECONDS_PER_DAY);
+}
+
+int32_t rollup_day_of(const RollupStore &store, uint32_t patient, int64_t unix_s) {
+    auto it = store.patients.find(patient);
+    int32_t offset = it == store.patients.end() ? 0 : it->second.utc_offset_s;
+    return (int32_t)floor_div(unix_s + offset, SECONDS_PER_DAY);
+}
+
+// 1970-01-01 was a Thursday; shift so weeks start on Monday
+int32_t rollup_week_of_day(int32_t day) {
+    return (int32_t)floor_div((int64_t)day + 3, 7);
+}
+
+// Grow a dense per-day/per-week vector to cover index, front or back
+template <typename T>
+static T &slot_at(std::vector<T> &v, int32_t &first, int32_t index) {
+    if (v.empty()) {
+        first = index;
+        v.push_back(T{});
+    } else if (index < first) {
+        v.insert(v.begin(), (size_t)(first - index), T{});
+        first = index;
+    } else if (index >= first + (int32_t)v.size()) {
+        v.resize((size_t)(index - first) + 1, T{});
+    }
+    return v[(size_t)(index - first)];
+}
+
+// Field deltas applied to a day and its week together
+struct Delta {
+    int windows, tremor, dyskinesia, fog, episodes;
+};
+
+static void apply(PatientRollup &p, int32_t day, const Delta &d) {
+    DayRollup &dr = slot_at(p.days, p.first_day, day);
+    dr.windows = (uint16_t)(dr.windows + d.windows);
+    dr.tremor_windows = (uint16_t)(dr.tremor_windows + d.tremor);
+    dr.dyskinesia_windows = (uint16_t)(dr.dyskinesia_windows + d.dyskinesia);
+    dr.fog_windows = (uint16_t)(dr.fog_windows + d.fog);
+    dr.fog_episodes = (uint16_t)(dr.fog_episodes + d.episodes);
+
+    WeekRollup &wr = slot_at(p.weeks, p.first_week, rollup_week_of_day(day));
+    wr.windows += d.windows;
+    wr.tremor_windows += d.tremor;
+    wr.dyskinesia_windows += d.dyskinesia;
+    wr.fog_windows += d.fog;
+    wr.fog_episodes += d.episodes;
+}
+
+static Delta contribution(uint8_t flags, int sign) {
+    Delta d;
+    d.windows = sign;
+    d.tremor = (flags & SESSION_TREMOR) ? sign : 0;
+    d.dyskinesia = (flags & SESSION_DYSKINESIA) ? sign : 0;
+    d.fog = (flags & SESSION_FREEZING) ? sign : 0;
+    d.episodes = 0;
+    return d;
+}
+
+static bool is_fog(const PatientRollup &p, int64_t window) {
+    return p.fog.count(window) != 0;
+}
+
+// Windows w and w+1 are the only episode starts a change at w can affect
+static void episode_starts(const PatientRollup &p, int64_t w, bool &start_w, bool &start_next) {
+    bool prev = is_fog(p, w - 1), cur = is_fog(p, w), next = is_fog(p, w + 1);
+    start_w = cur && !prev;
+    start_next = next && !cur;
+}
+
+void rollup_update(RollupStore &store, const RollupWindow &result) {
+    PatientRollup &p = patient_for(store, result.patient);
+    store.updates++;
+
+    // Its ring slot now belongs to a newer window: a revision could not be
+    // told from a first report and would be counted twice
+    if (p.high_window >= 0 && result.window <= p.high_window - ROLLUP_RECENT_WINDOWS) {
+        store.too_old++;
+        return;
+    }
+    if (result.window > p.high_window) {
+        p.high_window = result.window;
+        // Episode lookups reach one window below the oldest correctable one
+        const int64_t horizon = p.high_window - ROLLUP_RECENT_WINDOWS;
+        while (!p.fog.empty() && *p.fog.begin() < horizon) p.fog.erase(p.fog.begin());
+    }
+    const int32_t day = local_day(p, result.start_s);
+
+    RollupRecent &recent = p.recent[(size_t)(result.window % ROLLUP_RECENT_WINDOWS)];
+    const bool replacing = recent.window == result.window;
+    if (replacing) {
+        if (result.revision < recent.revision) {
+            store.stale++;
+            return;
+        }
+        store.corrections++;
+        recent.revision = result.revision;
+        if (recent.flags == result.flags) return;
+        apply(p, day, contribution(recent.flags, -1));
+    }
+    apply(p, day, contribution(result.flags, +1));
+
+    const bool was_fog = is_fog(p, result.window);
+    const bool now_fog = (result.flags & SESSION_FREEZING) != 0;
+    if (was_fog != now_fog) {
+        bool before_w, before_next, after_w, after_next;
+        episode_starts(p, result.window, before_w, before_next);
+        if (now_fog) p.fog.insert(result.window);
+        else p.fog.erase(result.window);
+        episode_starts(p, result.window, after_w, after_next);
+
+        Delta d = {0, 0, 0, 0, 0};
+        if (before_w != after_w) {
+            d.episodes = after_w ? 1 : -1;
+            apply(p, day, d);
+        }
+        if (before_next != after_next) {
+            d.episodes = after_next ? 1 : -1;
+            apply(p, local_day(p, result.start_s + ROLLUP_WINDOW_S), d);
+        }
+    }
+    recent.window = result.window;
+    recent.revision = result.revision;
+    recent.flags = result.flags;
+}
+
+bool rollup_day(const RollupStore &store, uint32_t patient, int32_t day, DayRollup &out) {
+    memset(&out, 0, sizeof(out));
+    auto it = store.patients.find(patient);
+    if (it == store.patients.end()) return false;
+    const PatientRollup &p = it->second;
+    if (day < p.first_day || day >= p.first_day + (int32_t)p.days.size()) return false;
+    out = p.days[(size_t)(day - p.first_day)];
+    return out.windows != 0;
+}
+
+bool rollup_week(const RollupStore &store, uint32_t patient, int32_t week, WeekRollup &out) {
+    memset(&out, 0, sizeof(out));
+    auto it = store.patients.find(patient);
+    if (it == store.patients.end()) return false;
+    const PatientRollup &p = it->second;
+    if (week < p.first_week || week >= p.first_week + (int32_t)p.weeks.size()) return false;
+    out = p.weeks[(size_t)(week - p.first_week)];
+    return out.windows != 0;
+}
+
+static float slope(const float *y, unsigned n) {
+    if (n < 2) return 0.0f;
+    float mean_x = (n - 1) / 2.0f, mean_y = 0.0f;
+    for (unsigned i = 0; i < n; i++) mean_y += y[i];
+    mean_y /= n;
+    float num = 0.0f, den = 0.0f;
+    for (unsigned i = 0; i < n; i++) {
+        num += (i - mean_x) * (y[i] - mean_y);
+        den += (i - mean_x) * (i - mean_x);
+    }
+    return num / den;
+}
+
+void rollup_trend(const RollupStore &store, uint32_t patient, int32_t last_week,
+                  unsigned weeks, RollupTrend &out) {
+    memset(&out, 0, sizeof(out));
+    if (weeks > ROLLUP_TREND_WEEKS) weeks = ROLLUP_TREND_WEEKS;
+    out.weeks = weeks;
+    for (unsigned i = 0; i < weeks; i++) {
+        WeekRollup w;
+        rollup_week(store, patient, last_week - (int32_t)(weeks - 1 - i), w);
+        // Rates per monitored day, so partial wear time does not read as improvement
+        float days = w.windows * (float)ROLLUP_WINDOW_S / SECONDS_PER_DAY;
+        if (days <= 0.0f) continue;
+        out.tremor_minutes_per_day[i] = w.tremor_windows * (ROLLUP_WINDOW_S / 60.0f) / days;
+        out.fog_episodes_per_day[i] = w.fog_episodes / days;
+    }
+    out.tremor_slope = slope(out.tremor_minutes_per_day, weeks);
+    out.fog_slope = slope(out.fog_episodes_per_day, weeks);
+}
+
+size_t rollup_memory_bytes(const RollupStore &store) {
+    size_t bytes = sizeof(RollupStore);
+    for (const auto &kv : store.patients) {
+        const PatientRollup &p = kv.second;
+        bytes += sizeof(kv) + sizeof(void *) * 2 +
+                 p.days.capacity() * sizeof(DayRollup) +
+                 p.weeks.capacity() * sizeof(WeekRollup) +
+                 p.recent.capacity() * sizeof(RollupRecent) +
+                 p.fog.size() * (sizeof(int64_t) + 4 * sizeof(void *));
+    }
+    return bytes;
+}
@@ -0,0 +1,51 @@
+#include "gateway/shard.h"
+#include <algorithm>
+
+// Murmur3 32-bit finalizer - cheap, well mixed, stable across builds
+static uint32_t mix32(uint32_t h) {
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35u;
+    h ^= h >> 16;
+    return h;
+}
+
+static uint32_t point_hash(uint32_t node_id, uint32_t replica) {
+    return mix32(node_id * 0x9E3779B1u ^ mix32(replica + 1));
+}
+
+static bool point_less(const ShardPoint &a, const ShardPoint &b) {
+    if (a.hash != b.hash) return a.hash < b.hash;
+    return a.node_id < b.node_id;  // deterministic order on collisions
+}
+
+void shard_ring_init(ShardRing &ring, unsigned vnodes_per_node) {
+    ring.points.clear();
+    ring.vnodes_per_node = vnodes_per_node > 0 ? vnodes_per_node : 1;
+}
+
+void shard_ring_add_node(ShardRing &ring, uint32_t node_id) {
+    shard_ring_remove_node(ring, node_id);
+    for (uint32_t r = 0; r < ring.vnodes_per_node; r++) {
+        ring.points.push_back(ShardPoint{point_hash(node_id, r), node_id});
+    }
+    std::sort(ring.points.begin(), ring.points.end(), point_less);
+}
+
+void shard_ring_remove_node(ShardRing &ring, uint32_t node_id) {
+    ring.points.erase(
+        std::remove_if(ring.points.begin(), ring.points.end(),
+                       [node_id](const ShardPoint &p) { return p.node_id == node_id; }),
+        ring.points.end());
+}
+
+bool shard_ring_lookup(const ShardRing &ring, uint32_t stream_id, uint32_t &node_id) {
+    if (ring.points.empty()) return false;
+
+    const ShardPoint key{mix32(stream_id), 0};
+    auto it = std::lower_bound(ring.points.begin(), ring.points.end(), key, point_less);
+    if (it == ring.points.end()) it = ring.points.begin();  // wrap around
+    node_id = it->node_id;
+    return true;
+}
@@ -0,0 +1,101 @@
+#include "harmonic_canceller.h"
+#include <cmath>
+
+static const float TWO_PI = 6.28318530718f;
+static const float MU = 0.03f;           // LMS step: ~0.6 s time constant
+static const float DECAY = 0.995f;       // weight leak when disabled
+
+// Overwritten by harmonic_canceller_init(); pass-through until then
+static HarmonicCanceller canceller = {52.0f, 3.0f, 5.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0,
+                                      {}, {}, {}, false};
+
+void harmonic_canceller_reset(HarmonicCanceller &c, float fs_hz, float band_low_hz, float band_high_hz) {
+    c.fs = fs_hz;
+    c.band_low = band_low_hz;
+    c.band_high = band_high_hz;
+    c.ph_re = 1.0f;
+    c.ph_im = 0.0f;
+    c.rot_re = 1.0f;
+    c.rot_im = 0.0f;
+    c.renorm_count = 0;
+    c.enabled = false;
+    for (int h = 0; h <= HARMONIC_CANCELLER_MAX; h++) {
+        c.active[h] = false;
+        c.w_re[h] = c.w_im[h] = 0.0f;
+    }
+}
+
+void harmonic_canceller_retune(HarmonicCanceller &c, float step_hz) {
+    c.enabled = false;
+    for (int h = 2; h <= HARMONIC_CANCELLER_MAX; h++) {
+        // Half a Hz of margin so harmonics at the band edges leak no energy in
+        float f = h * step_hz;
+        c.active[h] = step_hz > 0.0f && f >= c.band_low - 0.5f && f <= c.band_high + 0.5f &&
+                      f < 0.5f * c.fs;
+        c.enabled = c.enabled || c.active[h];
+    }
+    if (!c.enabled) return;
+
+    float w = TWO_PI * step_hz / c.fs;
+    c.rot_re = cosf(w);
+    c.rot_im = sinf(w);
+}
+
+float harmonic_canceller_filter(HarmonicCanceller &c, float sample) {
+    if (!c.enabled) {
+        // Let weights fade so a stale fit is not reused after a pause
+        for (int h = 2; h <= HARMONIC_CANCELLER_MAX; h++) {
+            c.w_re[h] *= DECAY;
+            c.w_im[h] *= DECAY;
+        }
+        return sample;
+    }
+
+    // Advance the fundamental phasor; renormalize now and then so rounding
+    // does not let its magnitude drift
+    float re = c.ph_re * c.rot_re - c.ph_im * c.rot_im;
+    float im = c.ph_re * c.rot_im + c.ph_im * c.rot_re;
+    c.ph_re = re;
+    c.ph_im = im;
+    if (++c.renorm_count >= 256) {
+        c.renorm_count = 0;
+        float inv = 1.0f / sqrtf(c.ph_re * c.ph_re + c.ph_im * c.ph_im);
+        c.ph_re *= inv;
+        c.ph_im *= inv;
+    }
+
+    // Harmonic references are successive powers of the phasor
+    float ref_re[HARMONIC_CANCELLER_MAX + 1];
+    float ref_im[HARMONIC_CANCELLER_MAX + 1];
+    ref_re[1] = c.ph_re;
+    ref_im[1] = c.ph_im;
+    for (int h = 2; h <= HARMONIC_CANCELLER_MAX; h++) {
+        ref_re[h] = ref_re[h - 1] * c.ph_re - ref_im[h - 1] * c.ph_im;
+        ref_im[h] = ref_re[h - 1] * c.ph_im + ref_im[h - 1] * c.ph_re;
+    }
+
+    float estimate = 0.0f;
+    for (int h = 2; h <= HARMONIC_CANCELLER_MAX; h++) {
+        if (c.active[h]) estimate += c.w_re[h] * ref_re[h] + c.w_im[h] * ref_im[h];
+    }
+    float err = sample - estimate;
+
+    for (int h = 2; h <= HARMONIC_CANCELLER_MAX; h++) {
+        if (!c.active[h]) continue;
+        c.w_re[h] += 2.0f * MU * err * ref_re[h];
+        c.w_im[h] += 2.0f * MU * err * ref_im[h];
+    }
+    return err;
+}
+
+void harmonic_canceller_init(float fs_hz, float band_low_hz, float band_high_hz) {
+    harmonic_canceller_reset(canceller, fs_hz, band_low_hz, band_high_hz);
+}
+
+void harmonic_canceller_set_step_hz(float step_hz) {
+    harmonic_canceller_retune(canceller, step_hz);
+}
+
+float harmonic_canceller_process(float sample) {
+    return harmonic_canceller_filter(canceller, sample);
+}
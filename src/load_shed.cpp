@@ -0,0 +1,60 @@
+#include "load_shed.h"
+
+static constexpr uint16_t PRESSURE_MAX = (TIER_COUNT - 1) * 100;
+
+// Stable 0-99 rank per stream (murmur3 finalizer)
+static uint32_t stream_rank(uint32_t stream_id) {
+    uint32_t h = stream_id;
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35u;
+    h ^= h >> 16;
+    return h % 100;
+}
+
+void load_shed_init(LoadShedState &state, const LoadShedConfig &config) {
+    state = LoadShedState{};
+    state.config = config;
+    if (state.config.pressure_step == 0) state.config.pressure_step = 10;
+}
+
+void load_shed_observe(LoadShedState &state, uint32_t queue_depth, uint32_t latency_us) {
+    // Smooth latency so a single slow window (e.g. a UART stall) does not shed
+    state.latency_ewma_us += 0.2f * ((float)latency_us - state.latency_ewma_us);
+
+    const LoadShedConfig &c = state.config;
+    bool overloaded = queue_depth >= c.queue_high ||
+                      state.latency_ewma_us > (float)c.latency_budget_us;
+    bool recovered  = queue_depth <= c.queue_low &&
+                      state.latency_ewma_us < 0.7f * (float)c.latency_budget_us;
+
+    if (overloaded) {
+        uint32_t p = state.pressure + c.pressure_step;
+        state.pressure = (uint16_t)(p > PRESSURE_MAX ? PRESSURE_MAX : p);
+    } else if (recovered) {
+        state.pressure = state.pressure > c.pressure_step ? state.pressure - c.pressure_step : 0;
+    }
+    // In between: hold the current tiers (hysteresis band)
+}
+
+AnalysisTier load_shed_tier(const LoadShedState &state, uint32_t stream_id) {
+    // Tier t is entered once pressure passes (t-1)*100 + rank
+    uint32_t rank = stream_rank(stream_id);
+    int tier = TIER_FULL;
+    for (int t = 1; t < TIER_COUNT; t++) {
+        if (state.pressure > (uint32_t)(t - 1) * 100 + rank) tier = t;
+    }
+    return (AnalysisTier)tier;
+}
+
+void load_shed_account(LoadShedState &state, AnalysisTier tier) {
+    state.tier_windows[tier]++;
+    state.windows_total++;
+    if (tier != TIER_FULL) state.windows_shed++;
+}
+
+float load_shed_rate(const LoadShedState &state) {
+    if (state.windows_total == 0) return 0.0f;
+    return 100.0f * state.windows_shed / state.windows_total;
+}
@@ -1,14 +1,57 @@
 #include "math.h"
 #include "parkinsons_system.h"
 #include "gait.h"
+#include "detect_core.h"
+#include "load_shed.h"
+#include "timer_wheel.h"
+#include "energy.h"
+#include "flight_recorder.h"
+#include "spectrogram.h"
+#include "tremor_tracker.h"
+#include "harmonic_canceller.h"
+#include "activity.h"
+#include "baseline.h"
+#include "trace.h"
+#include "spectral_kernels.h"
+#include "spectral_backend.h"
+#include "multitaper.h"
+#include "session_log.h"
+#include "ble_service.h"
+#include "kvstore_global_api.h"
 
 // ===================================================
 // Hardware Initialization
 // ===================================================
 I2C i2c(PB_11, PB_10);
 BufferedSerial serial_port(USBTX, USBRX, 115200);
+
+// Console that forwards to the UART and meters bytes for energy accounting
+class MeteredConsole : public FileHandle {
+public:
+    ssize_t read(void *buffer, size_t size) override {
+        return serial_port.read(buffer, size);
+    }
+    ssize_t write(const void *buffer, size_t size) override {
+        ssize_t n = serial_port.write(buffer, size);
+        if (n > 0) energy_add_uart_bytes((uint32_t)n);
+        return n;
+    }
+    off_t seek(off_t offset, int whence) override {
+        (void)offset;
+        (void)whence;
+        return -ESPIPE;
+    }
+    int close() override {
+        return 0;
+    }
+    int isatty() override {
+        return 1;
+    }
+};
+
+static MeteredConsole console;
 FileHandle *mbed::mbed_override_console(int) {
-    return &serial_port;
+    return &console;
 }
 
 // LED Indicators
@@ -16,35 +59,196 @@ DigitalOut led1(LED1);  // LD1 - Green - Tremor
 DigitalOut led2(LED2);  // LD2 - Green - Dyskinesia
 DigitalOut led3(LED3);  // LD3 - Yellow - Freezing
 InterruptIn button(BUTTON1);
+InterruptIn imu_int1(IMU_INT1_PIN);
+
+// Set from the LSM6DSL FIFO watermark interrupt
+static constexpr uint32_t IMU_FIFO_WATERMARK_FLAG = 0x1;
+static constexpr uint32_t BLE_EVENTS_FLAG = 0x2;
+#if BARE_METAL
+#if defined(MBED_CONF_RTOS_PRESENT)
+#error "BARE_METAL needs the bare-metal profile (mbed_app_bare_metal.json)"
+#endif
+// No kernel: interrupts post bits here and main() sleeps until one is set
+static constexpr uint32_t BATCH_TIMEOUT_FLAG = 0x80000000u;
+static volatile uint32_t pending_events = 0;
+static LowPowerTimeout batch_timeout;
+#else
+static EventFlags imu_events;
+#endif
 
 // === Global Variables ===
-SensorData sensor_data = {{0}, {0}, {0}, {0}, 0};
-DetectionResults results = {false, 0, false, 0, false, 0};
+SensorData sensor_data = {{0}, {0}, {0}, {0}, {0}, 0};
+DetectionResults results = {};
 bool sensor_initialized = false;
 bool button_pressed = false;
 
+// Analysis tier controller (single stream on the device)
+static LoadShedState load_shed;
+static uint32_t window_count = 0;
+
+// Cadence from the last gait window (0 when not walking)
+static float last_step_hz = 0.0f;
+
+// Millisecond timer wheel driving hop deadlines and stall detection
+static TimerWheel timers;
+static TimerNode hop_deadline_timer;
+static TimerNode sensor_stall_timer;
+static uint32_t hop_deadline_misses = 0;
+static bool sensor_stalled = false;
+static uint32_t now_ms();
+
+static int sample_count = 0;
+static uint32_t fifo_overruns = 0;
+
 // ===================================================
 // I2C Communication
 // ===================================================
 void write_register(uint8_t reg, uint8_t value) {
     char data[2] = {(char)reg, (char)value};
+    uint32_t t0 = us_ticker_read();
     i2c.write(LSM6DSL_ADDR, data, 2);
+    energy_add_time(ENERGY_I2C, us_ticker_read() - t0);
 }
 
 bool read_register(uint8_t reg, uint8_t &value) {
     char r = (char)reg;
-    if (i2c.write(LSM6DSL_ADDR, &r, 1, true) != 0) return false;
+    uint32_t t0 = us_ticker_read();
+    int err = i2c.write(LSM6DSL_ADDR, &r, 1, true);
+    energy_add_time(ENERGY_I2C, us_ticker_read() - t0);
+    if (err != 0) return false;
+
     ThisThread::sleep_for(1ms);
-    if (i2c.read(LSM6DSL_ADDR, &r, 1) != 0) return false;
+
+    t0 = us_ticker_read();
+    err = i2c.read(LSM6DSL_ADDR, &r, 1);
+    energy_add_time(ENERGY_I2C, us_ticker_read() - t0);
+    if (err != 0) return false;
     value = (uint8_t)r;
     return true;
 }
 
-int16_t read_int16(uint8_t reg_low) {
-    uint8_t low_byte, high_byte;
-    if (!read_register(reg_low, low_byte)) return 0;
-    if (!read_register(reg_low + 1, high_byte)) return 0;
-    return (int16_t)((high_byte << 8) | low_byte);
+// Burst read of consecutive registers (CTRL3_C.IF_INC is set at init).
+// No settling delay is needed between address and data phases.
+bool read_registers(uint8_t reg, uint8_t *buffer, int length) {
+    char r = (char)reg;
+    TRACE_BEGIN(TRACE_I2C);
+    uint32_t t0 = us_ticker_read();
+    bool ok = i2c.write(LSM6DSL_ADDR, &r, 1, true) == 0 &&
+              i2c.read(LSM6DSL_ADDR, (char *)buffer, length) == 0;
+    energy_add_time(ENERGY_I2C, us_ticker_read() - t0);
+    TRACE_END_ARG(TRACE_I2C, ok ? length : 0xFFFF);
+    return ok;
+}
+
+// ===================================================
+// Accelerometer Auto-ranging
+// ===================================================
+// FIFO words carry no full-scale marker, so a range switch is bracketed by
+// two FIFO_STATUS reads: every word queued before the first read was taken
+// at the old range, every word after the second at the new one. A sample
+// landing between the two reads could be either and is resolved by
+// continuity with the sample before it.
+static const uint8_t ACCEL_RANGE_CTRL1_XL[ACCEL_RANGE_COUNT] = {0x30, 0x38, 0x3C};  // 52 Hz
+static uint8_t  accel_range = 0;
+static uint8_t  range_previous = 0;      // range of the words queued before the last switch
+static uint16_t range_old_words = 0;     // FIFO words still known to be at range_previous
+static uint16_t range_unsure_words = 0;  // FIFO words at either range
+static int32_t  range_peak = 0;          // largest |raw| at the current range since the last decision
+static uint16_t range_quiet_samples = 0;
+static float    range_last_g[3] = {0.0f, 0.0f, 1.0f};
+static uint32_t range_switches_up = 0;
+static uint32_t range_switches_down = 0;
+static uint32_t range_ambiguous = 0;
+
+static uint16_t fifo_words(const uint8_t *status) {
+    return status[0] | ((status[1] & 0x07) << 8);
+}
+
+// Words read from the FIFO without being tagged (realignment)
+static void autorange_skip(uint16_t words) {
+    uint16_t n = words < range_old_words ? words : range_old_words;
+    range_old_words -= n;
+    words -= n;
+    range_unsure_words = words < range_unsure_words ? range_unsure_words - words : 0;
+}
+
+static float squared_step(const int16_t *raw, uint8_t range) {
+    float sum = 0.0f;
+    for (int i = 0; i < 3; i++) {
+        float d = raw[i] * ACCEL_SENSITIVITY_AT(range) - range_last_g[i];
+        sum += d * d;
+    }
+    return sum;
+}
+
+// Full-scale range the next sample read from the FIFO was taken at
+static uint8_t autorange_tag(int16_t x, int16_t y, int16_t z) {
+    const int16_t raw[3] = {x, y, z};
+    uint8_t range = accel_range;
+    if (range_old_words >= 3) {
+        range_old_words -= 3;
+        range = range_previous;
+    } else if (range_unsure_words >= 3) {
+        range_unsure_words -= 3;
+        range_ambiguous++;
+        if (squared_step(raw, range_previous) < squared_step(raw, accel_range)) range = range_previous;
+    } else {
+        range_old_words = 0;
+        range_unsure_words = 0;
+    }
+
+    for (int i = 0; i < 3; i++) range_last_g[i] = raw[i] * ACCEL_SENSITIVITY_AT(range);
+
+    if (range == accel_range) {
+        int32_t peak = 0;
+        for (int i = 0; i < 3; i++) {
+            int32_t v = raw[i] < 0 ? -(int32_t)raw[i] : raw[i];
+            if (v > peak) peak = v;
+        }
+        if (peak > range_peak) range_peak = peak;
+        if (peak >= AUTORANGE_DOWN_LSB) range_quiet_samples = 0;
+        else if (range_quiet_samples < AUTORANGE_DOWN_SAMPLES) range_quiet_samples++;
+    }
+    return range;
+}
+
+// Widen as soon as a drained batch came near clipping; narrow after
+// AUTORANGE_DOWN_SAMPLES quiet samples. Runs right after a drain, while the
+// FIFO holds at most a sample or two.
+static void autorange_update() {
+    uint8_t target = accel_range;
+    if (range_peak >= AUTORANGE_UP_LSB && accel_range + 1 < ACCEL_RANGE_COUNT) {
+        target = accel_range + 1;
+    } else if (range_quiet_samples >= AUTORANGE_DOWN_SAMPLES && accel_range > 0) {
+        target = accel_range - 1;
+    }
+    range_peak = 0;
+    // A bus error left words from the previous switch queued; decide later
+    if (target == accel_range || range_old_words != 0 || range_unsure_words != 0) return;
+
+    uint8_t before[2], after[2], readback;
+    if (!read_registers(FIFO_STATUS1, before, sizeof(before))) return;
+    write_register(CTRL1_XL, ACCEL_RANGE_CTRL1_XL[target]);
+    if (!read_registers(CTRL1_XL, &readback, 1) || readback != ACCEL_RANGE_CTRL1_XL[target]) {
+        // Unknown whether the write landed: put the old range back and retry
+        // on a later drain (at most one sample can have been taken meanwhile)
+        write_register(CTRL1_XL, ACCEL_RANGE_CTRL1_XL[accel_range]);
+        return;
+    }
+    bool bracketed = read_registers(FIFO_STATUS1, after, sizeof(after));
+    if (before[1] & 0x40) fifo_overruns++;
+    if (bracketed && (after[1] & 0x40)) fifo_overruns++;
+
+    range_previous = accel_range;
+    range_old_words = fifo_words(before);
+    range_unsure_words = 3;   // at 52 Hz at most one sample lands between the reads
+    if (bracketed && fifo_words(after) <= range_old_words) range_unsure_words = 0;
+
+    if (target > accel_range) range_switches_up++;
+    else range_switches_down++;
+    accel_range = target;
+    range_quiet_samples = 0;
+    printf("[XL] full scale +/-%d g\r\n", 2 << accel_range);
 }
 
 // ===================================================
@@ -61,9 +265,22 @@ bool initialize_sensor() {
     printf("Sensor detected: LSM6DSL (ID: 0x%02X)\r\n", device_id);
 
     write_register(CTRL3_C, 0x44);
-    write_register(CTRL1_XL, 0x30);
+    write_register(CTRL1_XL, ACCEL_RANGE_CTRL1_XL[accel_range]);
     write_register(CTRL2_G, 0x00);
 
+    // FIFO: accelerometer only, 52 Hz, continuous; watermark on INT1 so the
+    // MCU can sleep through a whole batch of samples
+    const uint16_t watermark_words = FIFO_BATCH_SAMPLES * 3;
+    write_register(FIFO_CTRL5, 0x00);                           // bypass (flush)
+    write_register(FIFO_CTRL1, watermark_words & 0xFF);
+    write_register(FIFO_CTRL2, (watermark_words >> 8) & 0x07);
+    write_register(FIFO_CTRL3, 0x01);                           // XL, no decimation
+    write_register(FIFO_CTRL5, 0x1E);                           // 52 Hz, continuous
+    write_register(INT1_CTRL, 0x08);                            // INT1_FTH
+
+    range_old_words = 0;                                         // flushed above
+    range_unsure_words = 0;
+
     ThisThread::sleep_for(100ms);
 
     printf("Sensor initialized successfully\r\n");
@@ -74,23 +291,13 @@ bool initialize_sensor() {
 // ===================================================
 // Data Collection
 // ===================================================
-void read_accelerometer(float &acc_x, float &acc_y, float &acc_z) {
-    int16_t raw_x = read_int16(OUTX_L_XL);
-    int16_t raw_y = read_int16(OUTY_L_XL);
-    int16_t raw_z = read_int16(OUTZ_L_XL);
-
-    const float SENSITIVITY = 0.061f / 1000.0f;
-    acc_x = raw_x * SENSITIVITY;
-    acc_y = raw_y * SENSITIVITY;
-    acc_z = raw_z * SENSITIVITY;
-}
-
 void collect_data_sample(float acc_x, float acc_y, float acc_z) {
     uint16_t idx = sensor_data.index;
     sensor_data.accel_x[idx] = acc_x;
     sensor_data.accel_y[idx] = acc_y;
     sensor_data.accel_z[idx] = acc_z;
     sensor_data.accel_total[idx] = sqrtf(acc_x * acc_x + acc_y * acc_y + acc_z * acc_z);
+    sensor_data.accel_tremor[idx] = harmonic_canceller_process(sensor_data.accel_total[idx]);
     sensor_data.index = (idx + 1) % BUFFER_SIZE;
 }
 
@@ -99,100 +306,237 @@ bool buffer_is_full() {
 }
 
 // ===================================================
-// FFT Implementation (Cooley-Tukey)
+// FIFO Drain
 // ===================================================
-void fft_complex(float *real, float *imag, int n) {
-    if (n <= 1) return;
+#if BARE_METAL
+static void post_event(uint32_t flag) {
+    core_util_critical_section_enter();
+    pending_events |= flag;
+    core_util_critical_section_exit();
+}
 
-    for (int i = 1, j = 0; i < n; i++) {
-        int bit = n >> 1;
-        for (; j & bit; bit >>= 1) {
-            j ^= bit;
-        }
-        j ^= bit;
-
-        if (i < j) {
-            float temp_r = real[i];
-            float temp_i = imag[i];
-            real[i] = real[j];
-            imag[i] = imag[j];
-            real[j] = temp_r;
-            imag[j] = temp_i;
-        }
-    }
+static void on_batch_timeout() {
+    post_event(BATCH_TIMEOUT_FLAG);
+}
 
-    const float PI = 3.14159265359f;
-    for (int s = 1; s <= (int)log2f(n); s++) {
-        int m = 1 << s;
-        float angle = -2.0f * PI / m;
-        float wm_real = cosf(angle);
-        float wm_imag = sinf(angle);
+// The bare-metal counterpart of EventFlags::wait_any_for(). The check and
+// the sleep share a critical section, so an interrupt arriving in between
+// leaves the core pending and WFI returns at once instead of missing it;
+// the handler then runs when the section is left.
+static uint32_t wait_events(uint32_t flags, uint32_t timeout_ms) {
+    batch_timeout.attach(on_batch_timeout, chrono::milliseconds(timeout_ms));
+    core_util_critical_section_enter();
+    while ((pending_events & (flags | BATCH_TIMEOUT_FLAG)) == 0) {
+        sleep();
+        core_util_critical_section_exit();
+        core_util_critical_section_enter();
+    }
+    uint32_t events = pending_events;
+    pending_events &= ~(flags | BATCH_TIMEOUT_FLAG);
+    core_util_critical_section_exit();
+    batch_timeout.detach();
+    return events & flags;
+}
+#else
+static void post_event(uint32_t flag) {
+    imu_events.set(flag);
+}
 
-        for (int k = 0; k < n; k += m) {
-            float w_real = 1.0f;
-            float w_imag = 0.0f;
+static uint32_t wait_events(uint32_t flags, uint32_t timeout_ms) {
+    uint32_t events = imu_events.wait_any_for(flags, chrono::milliseconds(timeout_ms));
+    return (events & osFlagsError) ? 0 : events;
+}
+#endif
 
-            for (int j = 0; j < m / 2; j++) {
-                int t = k + j;
-                int u = k + j + m / 2;
+static void on_imu_fifo_watermark() {
+    post_event(IMU_FIFO_WATERMARK_FLAG);
+}
 
-                float t_real = real[u] * w_real - imag[u] * w_imag;
-                float t_imag = real[u] * w_imag + imag[u] * w_real;
+static void on_ble_events() {
+    post_event(BLE_EVENTS_FLAG);
+}
 
-                real[u] = real[t] - t_real;
-                imag[u] = imag[t] - t_imag;
-                real[t] = real[t] + t_real;
-                imag[t] = imag[t] + t_imag;
+// Read every complete x/y/z sample in the FIFO and pass each one, tagged
+// with the full-scale range it was taken at, to handle_sample(). Returns the
+// number of samples read, or -1 on a bus error.
+static int drain_fifo(void (*handle_sample)(int16_t, int16_t, int16_t, uint8_t)) {
+    uint8_t status[4];
+    if (!read_registers(FIFO_STATUS1, status, sizeof(status))) return -1;
+
+    uint16_t words = fifo_words(status);
+    uint16_t pattern = status[2] | ((status[3] & 0x03) << 8);
+    if (status[1] & 0x40) fifo_overruns++;
+
+    // Realign to an x word if a previous read stopped mid-sample
+    static uint8_t discard[6];
+    if (pattern != 0 && words >= 3u - pattern) {
+        uint16_t skip = 3 - pattern;
+        if (!read_registers(FIFO_DATA_OUT_L, discard, skip * 2)) return -1;
+        autorange_skip(skip);
+        words -= skip;
+    }
 
-                float temp_real = w_real * wm_real - w_imag * wm_imag;
-                float temp_imag = w_real * wm_imag + w_imag * wm_real;
-                w_real = temp_real;
-                w_imag = temp_imag;
-            }
+    static uint8_t raw[FIFO_BATCH_SAMPLES * 6];
+    int samples = words / 3;
+    int done = 0;
+    while (done < samples) {
+        int chunk = samples - done;
+        if (chunk > FIFO_BATCH_SAMPLES) chunk = FIFO_BATCH_SAMPLES;
+        if (!read_registers(FIFO_DATA_OUT_L, raw, chunk * 6)) return -1;
+
+        for (int i = 0; i < chunk; i++) {
+            const uint8_t *p = &raw[i * 6];
+            int16_t x = (int16_t)(p[0] | (p[1] << 8));
+            int16_t y = (int16_t)(p[2] | (p[3] << 8));
+            int16_t z = (int16_t)(p[4] | (p[5] << 8));
+            handle_sample(x, y, z, autorange_tag(x, y, z));
         }
+        done += chunk;
     }
+    return samples;
 }
 
 // ===================================================
 // FFT and Frequency Analysis
 // ===================================================
+static_assert(GAIT_FFT_SIZE == FFT_SIZE && SAMPLE_RATE == FS_HZ,
+              "detect_core.h spectral settings differ from parkinsons_system.h");
+
+// The last spectrum stays in spectral_scratch; gait periodicity reuses it
+// when it belongs to accel_total
+static SpectralScratch spectral_scratch;
+static const float *spectrum_source = nullptr;
+
 float analyze_frequency_band(float *data, float freq_low, float freq_high) {
-    float fft_real[GAIT_FFT_SIZE];
-    float fft_imag[GAIT_FFT_SIZE];
+    spectrum_source = SpectralBackend::FULL_SPECTRUM ? data : nullptr;
+    return detect_band_percent(data, freq_low, freq_high, spectral_scratch);
+}
 
-    for (int i = 0; i < GAIT_FFT_SIZE; i++) {
-        fft_real[i] = 0;
-        fft_imag[i] = 0;
+// Tremor-band coherence and direction across x/y/z. The three axes share
+// one packed transform in spectral_scratch; its power spectrum is kept.
+static void analyze_axis_coherence(bool run) {
+    AxisCoherence c{};
+    if (run) {
+        c = detect_axis_coherence(sensor_data.accel_x, sensor_data.accel_y, sensor_data.accel_z,
+                                  TREMOR_LOW_HZ, TREMOR_HIGH_HZ, spectral_scratch);
     }
+    results.tremor_coherence = (c.coherence_xy + c.coherence_xz + c.coherence_yz) / 3.0f;
+    for (int a = 0; a < 3; a++) results.tremor_axis[a] = c.direction[a];
+    results.tremor_linearity = c.linearity;
+}
 
-    const float PI = 3.14159265359f;
-    for (int i = 0; i < BUFFER_SIZE; i++) {
-        if (i < GAIT_FFT_SIZE) {
-            float window = 0.5f * (1.0f - cosf(2.0f * PI * i / (BUFFER_SIZE - 1)));
-            fft_real[i] = data[i] * window;
+// Spectral part of detection at the requested tier, for the bands the
+// activity policy enables. Returns the tier actually used.
+static AnalysisTier analyze_spectral(AnalysisTier tier, const DetectorPolicy &policy) {
+    const bool tremor = policy.run_tremor;
+    const bool dysk = policy.run_dyskinesia;
+
+    switch (tier) {
+    case TIER_LONG_HOP:
+        if (window_count & 1) {
+            // Skipped hop: hold previous spectral results
+            break;
+        }
+        // fall through
+    case TIER_FULL:
+#if SPECTRAL_MULTITAPER
+    {
+        static float power[FFT_SIZE / 2];
+        if (tremor) {
+            multitaper_power_spectrum(sensor_data.accel_tremor, power);
+            results.tremor_intensity = band_energy_percent(power, TREMOR_LOW_HZ, TREMOR_HIGH_HZ);
+        }
+        if (dysk) {
+            multitaper_power_spectrum(sensor_data.accel_total, power);
+            results.dyskinesia_intensity = band_energy_percent(power, DYSKINESIA_LOW_HZ, DYSKINESIA_HIGH_HZ);
         }
     }
+#else
+        if (tremor) {
+            results.tremor_intensity = analyze_frequency_band(
+                sensor_data.accel_tremor, TREMOR_LOW_HZ, TREMOR_HIGH_HZ
+            );
+        }
+        if (dysk) {
+            results.dyskinesia_intensity = analyze_frequency_band(
+                sensor_data.accel_total, DYSKINESIA_LOW_HZ, DYSKINESIA_HIGH_HZ
+            );
+        }
+#endif
+        break;
+
+    default:
+        // Gate only: clear spectral detections when the limb is still,
+        // otherwise hold the last spectral results
+        if (detect_motion_std(sensor_data.accel_total) < MOTION_GATE_STD_G) {
+            results.tremor_intensity = 0.0f;
+            results.dyskinesia_intensity = 0.0f;
+        }
+        break;
+    }
 
-    fft_complex(fft_real, fft_imag, GAIT_FFT_SIZE);
-
-    float band_energy = 0.0f;
-    float total_energy = 0.0f;
+    if (!tremor) results.tremor_intensity = 0.0f;
+    if (!dysk) results.dyskinesia_intensity = 0.0f;
+    return tier;
+}
 
-    int bin_low = (int)(freq_low * GAIT_FFT_SIZE / SAMPLE_RATE);
-    int bin_high = (int)(freq_high * GAIT_FFT_SIZE / SAMPLE_RATE);
+// ===================================================
+// Energy Report
+// ===================================================
+// Estimated mAh/h per subsystem, sleep residency from the RTOS CPU stats
+static void report_energy() {
+    mbed_stats_cpu_t stats;
+    mbed_stats_cpu_get(&stats);
+    energy_set_sleep(stats.sleep_time, stats.deep_sleep_time);
+
+    EnergyReport e = energy_report(stats.uptime);
+    if (stats.uptime > 0) {
+        printf("[PWR] sleep:%.1f%% deep:%.1f%% fifo_overruns:%lu\r\n",
+               100.0f * stats.sleep_time / stats.uptime,
+               100.0f * stats.deep_sleep_time / stats.uptime,
+               (unsigned long)fifo_overruns);
+    }
+    printf("[E] mAh/h i2c:%.3f dsp:%.3f uart:%.3f radio:%.3f sleep:%.3f deep:%.3f cpu:%.3f total:%.2f\r\n",
+           e.mah_per_hour[ENERGY_I2C], e.mah_per_hour[ENERGY_DSP],
+           e.mah_per_hour[ENERGY_UART], e.mah_per_hour[ENERGY_RADIO],
+           e.mah_per_hour[ENERGY_SLEEP], e.mah_per_hour[ENERGY_DEEP_SLEEP],
+           e.mah_per_hour[ENERGY_CPU_OTHER], e.total_mah_per_hour);
+    ble_service_energy(e, (uint32_t)(stats.uptime / 1000000u));
+}
 
-    for (int i = 0; i < GAIT_FFT_SIZE / 2; i++) {
-        float magnitude = sqrtf(fft_real[i] * fft_real[i] + fft_imag[i] * fft_imag[i]);
-        float energy = magnitude * magnitude;
-        total_energy += energy;
+// Windows and mean analysis time per activity context
+static void report_activity() {
+    printf("[CTX] now:%s", activity_name(activity_context()));
+    for (int c = 0; c < ACTIVITY_COUNT; c++) {
+        uint32_t n = activity_windows((ActivityContext)c);
+        printf(" %s:%lu/%luus", activity_name((ActivityContext)c), (unsigned long)n,
+               (unsigned long)(n ? activity_cpu_us((ActivityContext)c) / n : 0));
+    }
+    printf("\r\n");
+}
 
-        if (i >= bin_low && i <= bin_high) {
-            band_energy += energy;
-        }
+// ===================================================
+// Baseline Persistence
+// ===================================================
+// Baselines live in the internal-flash KVStore so a reboot does not
+// restart per-patient learning
+static void load_baselines() {
+    uint8_t blob[64];
+    size_t actual = 0;
+    if (kv_get(BASELINE_KV_KEY, blob, sizeof(blob), &actual) == 0 &&
+        baseline_load(blob, actual)) {
+        printf("Patient baselines restored\r\n");
+    } else {
+        printf("No stored baselines, learning from scratch\r\n");
     }
+}
 
-    if (total_energy == 0) return 0.0f;
-    return (band_energy / total_energy) * 100.0f;
+static void save_baselines() {
+    uint8_t blob[64];
+    size_t size = baseline_save(blob, sizeof(blob));
+    if (size == 0 || kv_set(BASELINE_KV_KEY, blob, size, 0) != 0) {
+        printf("WARN: baseline save failed\r\n");
+    }
 }
 
 // ===================================================
@@ -201,29 +545,155 @@ float analyze_frequency_band(float *data, float freq_low, float freq_high) {
 void detect_symptoms() {
     if (!buffer_is_full()) return;
 
-    //TODO: change from only considering accel_z to 3 dimensional vector sum
+    Timer analysis_timer;
+    analysis_timer.start();
+
+    const DetectionResults previous = results;
 
-    results.tremor_intensity = analyze_frequency_band(
-        sensor_data.accel_total, TREMOR_LOW_HZ, TREMOR_HIGH_HZ
-    );
-    results.tremor_detected = (results.tremor_intensity > 20.0f);
+    // Activity context decides which detectors run and their thresholds
+    ActivityContext context = activity_classify(last_step_hz);
+    const DetectorPolicy &policy = activity_policy(context);
 
-    results.dyskinesia_intensity = analyze_frequency_band(
-        sensor_data.accel_total, DYSKINESIA_LOW_HZ, DYSKINESIA_HIGH_HZ
-    );
-    results.dyskinesia_detected = (results.dyskinesia_intensity > 20.0f);
+    spectrum_source = nullptr;
+    TRACE_BEGIN(TRACE_SPECTRAL);
+    AnalysisTier tier = analyze_spectral(load_shed_tier(load_shed, DEVICE_STREAM_ID), policy);
+    analyze_axis_coherence(tier == TIER_FULL && policy.run_tremor && policy.run_tremor_axes);
+    TRACE_END_ARG(TRACE_SPECTRAL, tier);
+    window_count++;
 
-    // Use the new gait detection from gait.cpp
-    GaitStatus gait_status = gait_update(SignalWindow{});
-    results.freezing_detected = (gait_status.fog_state > 0);  // 1 = freeze start, 2 = sustained
-    results.freezing_confidence = (gait_status.fog_state > 0) ? 100.0f : 0.0f;
+    // Per-sample tracker: frequency once locked (0 before), optionally drives intensity
+    TremorEstimate tremor = tremor_tracker_estimate();
+    results.tremor_frequency_hz = tremor.frequency_hz;
+#if USE_WFLC_TREMOR
+    if (policy.run_tremor) {
+        results.tremor_intensity = tremor.intensity;
+    }
+#endif
+
+    // Thresholds are relative to this patient's learned baselines
+    results.tremor_detected = (results.tremor_intensity >
+                               baseline_threshold(BASELINE_TREMOR, policy.tremor_threshold));
+    results.dyskinesia_detected = (results.dyskinesia_intensity >
+                                   baseline_threshold(BASELINE_DYSKINESIA, policy.dyskinesia_threshold));
+    if (policy.run_tremor) baseline_observe(BASELINE_TREMOR, results.tremor_intensity);
+    if (policy.run_dyskinesia) baseline_observe(BASELINE_DYSKINESIA, results.dyskinesia_intensity);
+
+    // Use the new gait detection from gait.cpp (not while lying or sitting)
+    if (policy.run_fog) {
+        gait_set_rigid_threshold(baseline_threshold(BASELINE_GAIT_STD, GAIT_RIGID_STD_G));
+        TRACE_BEGIN(TRACE_GAIT);
+        GaitStatus gait_status = gait_update(SignalWindow{});
+        detect_gait_periodicity(sensor_data.accel_total, spectrum_source == sensor_data.accel_total,
+                                spectral_scratch, gait_status);
+        spectrum_source = sensor_data.accel_total;   // computed above if it was not there
+        TRACE_END(TRACE_GAIT);
+        baseline_observe(BASELINE_GAIT_STD, gait_status.std_dev);
+        results.freezing_detected = (gait_status.fog_state > 0);  // 1 = freeze start, 2 = sustained
+        results.freezing_confidence = (gait_status.fog_state > 0) ? 100.0f : 0.0f;
+        last_step_hz = gait_status.step_hz;
+        if (gait_status.step_hz > 0.0f) {
+            printf("[GAIT] %.2f steps/s reg:%.2f/%.2f sym:%.2f\r\n",
+                   gait_status.acf_step_hz, gait_status.step_regularity,
+                   gait_status.stride_regularity, gait_status.step_symmetry);
+        }
+    } else {
+        results.freezing_detected = false;
+        results.freezing_confidence = 0.0f;
+        last_step_hz = 0.0f;
+    }
+
+    // Cadence from this window keys the gait-harmonic canceller for the next
+#if HARMONIC_CANCELLER
+    harmonic_canceller_set_step_hz(last_step_hz);
+#endif
+
+    // Analysis runs inline with sampling, so there is no backlog queue;
+    // latency against the budget is what drives shedding here
+    analysis_timer.stop();
+    uint32_t analysis_us = (uint32_t)chrono::duration_cast<chrono::microseconds>(
+                               analysis_timer.elapsed_time()).count();
+    load_shed_observe(load_shed, 0, analysis_us);
+    load_shed_account(load_shed, tier);
+
+    // History reuses the magnitude spectrum left in scratch, outside the
+    // timed analysis; cheaper tiers leave none and are recorded as gaps
+    if (spectrum_source == sensor_data.accel_total) {
+        spectrogram_push(spectral_scratch.power);
+    } else {
+        spectrogram_push_gap();
+    }
+#if SPECTROGRAM_STREAM
+    uint8_t column[SPECTROGRAM_RECORD_MAX];
+    size_t column_bytes = spectrogram_last_record(column, sizeof(column));
+    printf("SG ");
+    for (size_t i = 0; i < column_bytes; i++) printf("%02X", column[i]);
+    printf("\r\n");
+#endif
+    energy_add_time(ENERGY_DSP, analysis_us);
+    activity_account(context, analysis_us);
+
+    // Freeze the raw-data flight recorder on any detection rising edge
+    uint8_t onset = 0;
+    if (results.tremor_detected && !previous.tremor_detected)         onset |= FR_TRIGGER_TREMOR;
+    if (results.dyskinesia_detected && !previous.dyskinesia_detected) onset |= FR_TRIGGER_DYSKINESIA;
+    if (results.freezing_detected && !previous.freezing_detected)     onset |= FR_TRIGGER_FREEZING;
+    if (onset != 0) {
+        flight_recorder_trigger(onset);
+    }
+
+    // One record per window for later bulk offload
+    SessionRecord record = {};
+    record.uptime_s = now_ms() / 1000;
+    record.tremor = (uint8_t)results.tremor_intensity;
+    record.dyskinesia = (uint8_t)results.dyskinesia_intensity;
+    record.flags = (results.tremor_detected ? SESSION_TREMOR : 0) |
+                   (results.dyskinesia_detected ? SESSION_DYSKINESIA : 0) |
+                   (results.freezing_detected ? SESSION_FREEZING : 0);
+    record.activity = context;
+    session_log_append(record);
+#if SESSION_LOG_STREAM
+    // The record at full intensity resolution: uptime, tremor %, dyskinesia %,
+    // flags, activity context
+    printf("SL %lu %.2f %.2f %02X %u\r\n", (unsigned long)record.uptime_s,
+           results.tremor_intensity, results.dyskinesia_intensity, record.flags, record.activity);
+#endif
+
+    TRACE_BEGIN(TRACE_OUTPUT);
+
+    if (results.tremor_linearity > 0.0f) {
+        printf("[AX] coh:%.2f lin:%.2f dir:%+.2f/%+.2f/%+.2f\r\n",
+               results.tremor_coherence, results.tremor_linearity,
+               results.tremor_axis[0], results.tremor_axis[1], results.tremor_axis[2]);
+    }
 
     // Compact status format: [Tremor|Dyskinesia|Freezing]
     printf("[%s|%s|%s]\r\n",
            results.tremor_detected ? "T" : " ",
            results.dyskinesia_detected ? "D" : " ",
            results.freezing_detected ? "F" : " ");
+
+    // Flash writes are rate-limited to protect the sector endurance
+    if (window_count % BASELINE_SAVE_WINDOWS == 0) {
+        save_baselines();
+    }
+
+    // Tier distribution, shed rate and energy estimate, once a minute
+    if (window_count % METRICS_REPORT_WINDOWS == 0) {
+        printf("[LS] full:%lu hop2:%lu gate:%lu shed:%.1f%%\r\n",
+               (unsigned long)load_shed.tier_windows[TIER_FULL],
+               (unsigned long)load_shed.tier_windows[TIER_LONG_HOP],
+               (unsigned long)load_shed.tier_windows[TIER_GATE_ONLY],
+               load_shed_rate(load_shed));
+#if ACCEL_AUTORANGE
+        printf("[XL] fs:%dg up:%lu down:%lu amb:%lu\r\n", 2 << accel_range,
+               (unsigned long)range_switches_up, (unsigned long)range_switches_down,
+               (unsigned long)range_ambiguous);
+#endif
+        report_energy();
+        report_activity();
+    }
     fflush(stdout);
+    TRACE_END(TRACE_OUTPUT);
 }
 
 // ===================================================
@@ -233,6 +703,26 @@ void transmit_results() {
     // Empty - LED status handled separately
 }
 
+// ===================================================
+// Scheduling (timer wheel callbacks)
+// ===================================================
+static uint32_t now_ms() {
+    return (uint32_t)Kernel::Clock::now().time_since_epoch().count();
+}
+
+// A full window should complete every hop; firing means the loop fell behind
+static void on_hop_deadline(TimerNode &node) {
+    hop_deadline_misses++;
+    printf("WARN: hop deadline missed (%lu)\r\n", (unsigned long)hop_deadline_misses);
+    timer_wheel_schedule(timers, node, node.expires + HOP_PERIOD_MS);
+}
+
+// No successful sensor read within the stall timeout
+static void on_sensor_stall(TimerNode &node) {
+    (void)node;
+    sensor_stalled = true;
+}
+
 // ===================================================
 // Button Handler
 // ===================================================
@@ -240,18 +730,134 @@ void on_button_press() {
     button_pressed = true;
 }
 
+// ===================================================
+// Per-sample Processing
+// ===================================================
+static void handle_sample(int16_t raw_x, int16_t raw_y, int16_t raw_z, uint8_t range) {
+    flight_recorder_add_sample(raw_x, raw_y, raw_z, range);
+
+    float acc_x = raw_x * ACCEL_SENSITIVITY_AT(range);
+    float acc_y = raw_y * ACCEL_SENSITIVITY_AT(range);
+    float acc_z = raw_z * ACCEL_SENSITIVITY_AT(range);
+    collect_data_sample(acc_x, acc_y, acc_z);
+    activity_update(acc_x, acc_y, acc_z);
+    tremor_tracker_update(sensor_data.accel_tremor[(sensor_data.index + BUFFER_SIZE - 1) % BUFFER_SIZE]);
+
+    if (sample_count % 52 == 0) {
+        printf("Sample %d | X: %.3f | Y: %.3f | Z: %.3f g\r\n",
+               sample_count, acc_x, acc_y, acc_z);
+    }
+
+    if (buffer_is_full()) {
+        timer_wheel_schedule(timers, hop_deadline_timer,
+                             now_ms() + HOP_PERIOD_MS + HOP_DEADLINE_SLACK_MS);
+        detect_symptoms();
+        transmit_results();
+        printf("---\r\n");
+    }
+
+    sample_count++;
+}
+
+// ===================================================
+// Flight Recorder Export
+// ===================================================
+// Stream a frozen snapshot as hex lines, one bounded chunk per wakeup, so
+// acquisition is never held up by the export
+static void export_flight_recorder() {
+    if (!flight_recorder_ready()) return;
+
+    uint8_t chunk[FLIGHT_EXPORT_CHUNK_BYTES];
+    size_t n = flight_recorder_read(chunk, sizeof(chunk));
+    printf("FR ");
+    for (size_t i = 0; i < n; i++) {
+        printf("%02X", chunk[i]);
+    }
+    printf("\r\n");
+}
+
+// ===================================================
+// Spectrogram Export
+// ===================================================
+// Whole history on a button press, a few records per wakeup like the
+// flight recorder so the UART never blocks the loop for long
+static_assert(SPECTROGRAM_EXPORT_CHUNK_BYTES >= SPECTROGRAM_RECORD_MAX,
+              "a spectrogram export chunk must hold a key record");
+static bool spectrogram_exporting = false;
+
+static void start_spectrogram_export() {
+    spectrogram_dump_start();
+    spectrogram_exporting = true;
+    printf("SPECTROGRAM BEGIN bins=%u low=%u fft=%u fs=%.0f offset=%d\r\n",
+           (unsigned)SPECTROGRAM_BINS, (unsigned)SPECTROGRAM_BIN_LOW, (unsigned)GAIT_FFT_SIZE,
+           SAMPLE_RATE, SPECTROGRAM_LEVEL_OFFSET);
+}
+
+static void export_spectrogram() {
+    if (!spectrogram_exporting) return;
+
+    uint8_t chunk[SPECTROGRAM_EXPORT_CHUNK_BYTES];
+    size_t n = spectrogram_dump_read(chunk, sizeof(chunk));
+    if (n == 0) {
+        spectrogram_exporting = false;
+        printf("SPECTROGRAM END\r\n");
+        return;
+    }
+    printf("SD ");
+    for (size_t i = 0; i < n; i++) {
+        printf("%02X", chunk[i]);
+    }
+    printf("\r\n");
+}
+
+// ===================================================
+// Trace Dump
+// ===================================================
+// Recording is frozen for the dump so the timeline ends where it was
+// requested; the FIFO absorbs the samples that arrive meanwhile
+static void dump_trace() {
+    TraceEvent chunk[FLIGHT_EXPORT_CHUNK_BYTES / sizeof(TraceEvent)];
+
+    trace_pause(true);
+    printf("TRACE BEGIN hz=%lu dropped=%lu\r\n",
+           (unsigned long)trace_clock_hz(), (unsigned long)trace_dropped());
+    size_t n;
+    while ((n = trace_drain(chunk, sizeof(chunk) / sizeof(chunk[0]))) > 0) {
+        const uint8_t *bytes = (const uint8_t *)chunk;
+        printf("TR ");
+        for (size_t i = 0; i < n * sizeof(TraceEvent); i++) {
+            printf("%02X", bytes[i]);
+        }
+        printf("\r\n");
+    }
+    printf("TRACE END\r\n");
+    fflush(stdout);
+    trace_pause(false);
+}
+
 // ===================================================
 // Main Program
 // ===================================================
 int main() {
+    // The µs ticker starts during HAL init, so this is the boot cost before main()
+    const uint32_t main_entry_us = us_ticker_read();
+    bool boot_reported = false;
+
+    energy_init(energy_default_model(), 115200);
+    trace_init();
+
     printf("\r\n==========================================\r\n");
     printf("  Parkinson's Symptom Detection System   \r\n");
     printf("  GaitWave - Real-time Detection        \r\n");
     printf("==========================================\r\n\r\n");
 
     button.fall(&on_button_press);
+    imu_int1.rise(&on_imu_fifo_watermark);
     i2c.frequency(400000);
 
+    // Console is output-only; disabling RX drops the UART deep-sleep lock
+    serial_port.enable_input(false);
+
     sensor_initialized = initialize_sensor();
 
     if (!sensor_initialized) {
@@ -264,31 +870,66 @@ int main() {
     }
 
     gait_init();
+    tremor_tracker_init(SAMPLE_RATE, TREMOR_LOW_HZ, TREMOR_HIGH_HZ);
+    harmonic_canceller_init(SAMPLE_RATE, TREMOR_LOW_HZ, TREMOR_HIGH_HZ);
+    activity_init(SAMPLE_RATE);
+    baseline_init();
+    load_baselines();
+    flight_recorder_init();
+    spectrogram_init();
+    session_log_init();
+    ble_service_init(on_ble_events);
+    load_shed_init(load_shed, LoadShedConfig{ANALYSIS_BUDGET_US, 1, 0, 10});
+
+    timer_wheel_init(timers, now_ms());
+    timer_node_init(hop_deadline_timer, on_hop_deadline, nullptr);
+    timer_node_init(sensor_stall_timer, on_sensor_stall, nullptr);
+    timer_wheel_schedule(timers, sensor_stall_timer, now_ms() + SENSOR_STALL_MS);
 
     printf("\r\nStarting data acquisition...\r\n");
     printf("Sample Rate: %.0f Hz | Buffer: %d samples (3 sec)\r\n", SAMPLE_RATE, BUFFER_SIZE);
     printf("Collecting data, detection begins when buffer fills...\r\n\r\n");
     fflush(stdout);
 
-    int sample_count = 0;
-
     while (true) {
-        float acc_x, acc_y, acc_z;
-        read_accelerometer(acc_x, acc_y, acc_z);
-        collect_data_sample(acc_x, acc_y, acc_z);
-
-        if (sample_count % 52 == 0) {
-            printf("Sample %d | X: %.3f | Y: %.3f | Z: %.3f g\r\n",
-                   sample_count, acc_x, acc_y, acc_z);
-            fflush(stdout);
+        // Sleep (tickless; stop mode when no driver holds the deep-sleep
+        // lock) until the FIFO reaches its watermark or the batch times out
+        TRACE_BEGIN(TRACE_SLEEP);
+        wait_events(IMU_FIFO_WATERMARK_FLAG | BLE_EVENTS_FLAG, FIFO_BATCH_TIMEOUT_MS);
+        TRACE_RESYNC();
+        TRACE_END(TRACE_SLEEP);
+
+        timer_wheel_advance(timers, now_ms());
+
+        if (sensor_stalled) {
+            sensor_stalled = false;
+            printf("WARN: sensor stalled, re-initializing\r\n");
+            initialize_sensor();
+            timer_wheel_schedule(timers, sensor_stall_timer, now_ms() + SENSOR_STALL_MS);
         }
 
-        if (buffer_is_full()) {
-            detect_symptoms();
-            transmit_results();
-            printf("---\r\n");
-            fflush(stdout);
+        // Batch: drain everything the FIFO holds, analysing at each hop
+        TRACE_BEGIN(TRACE_ACQUISITION);
+        int drained = drain_fifo(handle_sample);
+        TRACE_END_ARG(TRACE_ACQUISITION, drained > 0 ? drained : 0);
+        if (drained > 0) {
+            timer_wheel_schedule(timers, sensor_stall_timer, now_ms() + SENSOR_STALL_MS);
+#if ACCEL_AUTORANGE
+            autorange_update();
+#endif
+            if (!boot_reported) {
+                boot_reported = true;
+                printf("[BOOT] %s: main() at %lu us, first samples at %lu us\r\n",
+                       BARE_METAL ? "bare-metal" : "rtos",
+                       (unsigned long)main_entry_us, (unsigned long)us_ticker_read());
+            }
         }
+        TRACE_BEGIN(TRACE_OUTPUT);
+        export_flight_recorder();
+        export_spectrogram();
+        ble_service_process(now_ms());
+        fflush(stdout);
+        TRACE_END(TRACE_OUTPUT);
 
         // Update LEDs: Keep one LED ON (solid) per detected symptom
         // LED1 = Tremor, LED2 = Dyskinesia, LED3 = Freezing
@@ -307,9 +948,9 @@ int main() {
                        sensor_data.index, BUFFER_SIZE);
             }
             fflush(stdout);
+            dump_trace();
+            start_spectrogram_export();
         }
 
-        sample_count++;
-        ThisThread::sleep_for(chrono::milliseconds(SAMPLE_PERIOD_MS));
     }
 }
@@ -0,0 +1,72 @@
+#include "multitaper.h"
+#include "dpss_tapers.h"
+#include "spectral_backend.h"
+#include "spectral_kernels.h"
+
+static_assert(DPSS_N == WINDOW_SAMPLES, "dpss_tapers.h is stale: rerun tools/gen_dpss.py");
+
+// ===================================================
+// Multitaper Power Spectrum
+// ===================================================
+// One Backend::power_spectrum() per taper; with the rfft backend that is
+// the spectral_kernels rfft (CMSIS on the device, the best SIMD variant on
+// the host), which already packs its real input into a half-length complex
+// transform, so K tapers cost the same as transforming them in pairs
+// through one full-length complex FFT. As in the spectral
+// backends the window mean (gravity) is removed first, and a window under
+// MOTION_GATE_STD_G leaves an all-zero spectrum, so it has no band share.
+template <typename Backend>
+void multitaper_power_spectrum_with(const float *data, float *power, SpectralScratch &scratch) {
+    const SpectralKernels &kernels = spectral_kernels();
+
+    for (size_t k = 0; k < FFT_SIZE / 2; k++) {
+        power[k] = 0.0f;
+    }
+
+    if (detect_motion_std(data) < MOTION_GATE_STD_G) return;
+    const float mean = kernels.sum(data, WINDOW_SAMPLES) / WINDOW_SAMPLES;
+
+    for (int t = 0; t < DPSS_K; t++) {
+        for (size_t i = 0; i < WINDOW_SAMPLES; i++) {
+            scratch.fft_in[i] = (data[i] - mean) * DPSS_TAPERS[t][i];
+        }
+        for (size_t i = WINDOW_SAMPLES; i < FFT_SIZE; i++) scratch.fft_in[i] = 0.0f;
+        Backend::power_spectrum(scratch);
+        for (size_t k = 0; k < FFT_SIZE / 2; k++) power[k] += scratch.power[k];
+    }
+
+    const float inv_k = 1.0f / DPSS_K;
+    for (size_t k = 0; k < FFT_SIZE / 2; k++) {
+        power[k] *= inv_k;
+    }
+}
+
+template void multitaper_power_spectrum_with<RfftBackend>(const float *, float *,
+                                                          SpectralScratch &);
+template void multitaper_power_spectrum_with<FftComplexBackend>(const float *, float *,
+                                                                SpectralScratch &);
+template void multitaper_power_spectrum_with<GoertzelBackend>(const float *, float *,
+                                                              SpectralScratch &);
+
+void multitaper_power_spectrum(const float *data, float *power) {
+    static SpectralScratch scratch;
+    multitaper_power_spectrum_with<SpectralBackend>(data, power, scratch);
+}
+
+// Band share of a half spectrum, same bin convention as the spectral backends
+float band_energy_percent(const float *power, float freq_low, float freq_high) {
+    int bin_low = (int)(freq_low * FFT_SIZE / FS_HZ);
+    int bin_high = (int)(freq_high * FFT_SIZE / FS_HZ);
+
+    float band_energy = 0.0f;
+    float total_energy = 0.0f;
+    for (int i = 0; i < (int)FFT_SIZE / 2; i++) {
+        total_energy += power[i];
+        if (i >= bin_low && i <= bin_high) {
+            band_energy += power[i];
+        }
+    }
+
+    if (total_energy == 0) return 0.0f;
+    return (band_energy / total_energy) * 100.0f;
+}
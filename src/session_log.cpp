@@ -0,0 +1,63 @@
+#include "session_log.h"
+
+static SessionRecord ring[SESSION_LOG_RECORDS];
+static uint32_t end_seq = 0;
+
+void session_log_init() {
+    end_seq = 0;
+}
+
+uint32_t session_log_append(const SessionRecord &record) {
+    SessionRecord &slot = ring[end_seq % SESSION_LOG_RECORDS];
+    slot = record;
+    slot.seq = end_seq;
+    return end_seq++;
+}
+
+uint32_t session_log_first_seq() {
+    return end_seq > SESSION_LOG_RECORDS ? end_seq - SESSION_LOG_RECORDS : 0;
+}
+
+uint32_t session_log_end_seq() {
+    return end_seq;
+}
+
+size_t session_log_read(uint32_t seq, uint8_t *out, size_t max_records) {
+    if (seq < session_log_first_seq() || seq >= end_seq) return 0;
+    size_t n = end_seq - seq;
+    if (n > max_records) n = max_records;
+    for (size_t i = 0; i < n; i++) {
+        session_record_encode(ring[(seq + i) % SESSION_LOG_RECORDS], out + i * SESSION_RECORD_BYTES);
+    }
+    return n;
+}
+
+static uint8_t *put_u32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+    return p + 4;
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+void session_record_encode(const SessionRecord &record, uint8_t *out) {
+    out = put_u32(out, record.seq);
+    out = put_u32(out, record.uptime_s);
+    out[0] = record.tremor;
+    out[1] = record.dyskinesia;
+    out[2] = record.flags;
+    out[3] = record.activity;
+}
+
+void session_record_decode(const uint8_t *in, SessionRecord &record) {
+    record.seq = get_u32(in);
+    record.uptime_s = get_u32(in + 4);
+    record.tremor = in[8];
+    record.dyskinesia = in[9];
+    record.flags = in[10];
+    record.activity = in[11];
+}
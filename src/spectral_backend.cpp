@@ -0,0 +1,214 @@
+#include "spectral_backend.h"
+#include "spectral_kernels.h"
+
+#include <cmath>
+
+// Built on first use; a function-local static so concurrent host
+// threads initialise it once
+struct HannWindow {
+    float w[WINDOW_SAMPLES];
+    float sum_sq;
+    HannWindow() {
+        const float PI = 3.14159265359f;
+        sum_sq = 0.0f;
+        for (size_t i = 0; i < WINDOW_SAMPLES; i++) {
+            w[i] = 0.5f * (1.0f - cosf(2.0f * PI * i / (WINDOW_SAMPLES - 1)));
+            sum_sq += w[i] * w[i];
+        }
+    }
+};
+
+static const HannWindow &hann_window() {
+    static const HannWindow hann;
+    return hann;
+}
+
+const float *spectral_hann_window() {
+    return hann_window().w;
+}
+
+static void band_bins(float freq_low, float freq_high, int &bin_low, int &bin_high) {
+    bin_low = (int)(freq_low * FFT_SIZE / FS_HZ);
+    bin_high = (int)(freq_high * FFT_SIZE / FS_HZ);
+    if (bin_high > (int)FFT_SIZE / 2 - 1) bin_high = FFT_SIZE / 2 - 1;
+}
+
+// Hann-windowed samples with the window mean removed. Gravity sits in a
+// magnitude window as a 1 g offset; left in, its bin dominates the total
+// and caps every band share at a few percent. Returns false when the
+// weighted std-dev is under MOTION_GATE_STD_G: a still limb, whose band
+// shares would only describe sensor noise.
+static bool window_detrended(const float *data, float *out) {
+    const SpectralKernels &kernels = spectral_kernels();
+    const HannWindow &hann = hann_window();
+    const float mean = kernels.sum(data, WINDOW_SAMPLES) / WINDOW_SAMPLES;
+    kernels.multiply(data, hann.w, out, WINDOW_SAMPLES);
+    float energy = 0.0f;
+    for (size_t i = 0; i < WINDOW_SAMPLES; i++) {
+        out[i] -= mean * hann.w[i];
+        energy += out[i] * out[i];
+    }
+    return energy >= MOTION_GATE_STD_G * MOTION_GATE_STD_G * hann.sum_sq;
+}
+
+bool spectral_window(const float *data, SpectralScratch &scratch) {
+    const bool moving = window_detrended(data, scratch.fft_in);
+    for (size_t i = WINDOW_SAMPLES; i < FFT_SIZE; i++) {
+        scratch.fft_in[i] = 0.0f;
+    }
+    return moving;
+}
+
+static float percent(float band_energy, float total_energy) {
+    if (total_energy == 0) return 0.0f;
+    return (band_energy / total_energy) * 100.0f;
+}
+
+// ===================================================
+// Real FFT (spectral_kernels)
+// ===================================================
+void RfftBackend::power_spectrum(SpectralScratch &scratch) {
+    // CMSIS on the device, best SIMD variant for the CPU on the host
+    const SpectralKernels &kernels = spectral_kernels();
+    kernels.rfft(scratch.fft_in, scratch.fft_out, FFT_SIZE);
+    kernels.power(scratch.fft_out, scratch.power, FFT_SIZE);
+}
+
+float RfftBackend::band_percent(const float *data, float freq_low, float freq_high,
+                                SpectralScratch &scratch) {
+    const SpectralKernels &kernels = spectral_kernels();
+    const bool moving = spectral_window(data, scratch);
+    power_spectrum(scratch);
+
+    int bin_low, bin_high;
+    band_bins(freq_low, freq_high, bin_low, bin_high);
+    float total_energy = kernels.sum(scratch.power, FFT_SIZE / 2);
+    float band_energy = kernels.sum(scratch.power + bin_low, bin_high - bin_low + 1);
+    return moving ? percent(band_energy, total_energy) : 0.0f;
+}
+
+// ===================================================
+// Complex FFT (Cooley-Tukey)
+// ===================================================
+void fft_complex(float *real, float *imag, int n) {
+    if (n <= 1) return;
+
+    for (int i = 1, j = 0; i < n; i++) {
+        int bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+
+        if (i < j) {
+            float temp_r = real[i];
+            float temp_i = imag[i];
+            real[i] = real[j];
+            imag[i] = imag[j];
+            real[j] = temp_r;
+            imag[j] = temp_i;
+        }
+    }
+
+    const float PI = 3.14159265359f;
+    for (int s = 1; s <= (int)log2f(n); s++) {
+        int m = 1 << s;
+        float angle = -2.0f * PI / m;
+        float wm_real = cosf(angle);
+        float wm_imag = sinf(angle);
+
+        for (int k = 0; k < n; k += m) {
+            float w_real = 1.0f;
+            float w_imag = 0.0f;
+
+            for (int j = 0; j < m / 2; j++) {
+                int t = k + j;
+                int u = k + j + m / 2;
+
+                float t_real = real[u] * w_real - imag[u] * w_imag;
+                float t_imag = real[u] * w_imag + imag[u] * w_real;
+
+                real[u] = real[t] - t_real;
+                imag[u] = imag[t] - t_imag;
+                real[t] = real[t] + t_real;
+                imag[t] = imag[t] + t_imag;
+
+                float temp_real = w_real * wm_real - w_imag * wm_imag;
+                float temp_imag = w_real * wm_imag + w_imag * wm_real;
+                w_real = temp_real;
+                w_imag = temp_imag;
+            }
+        }
+    }
+}
+
+void FftComplexBackend::power_spectrum(SpectralScratch &scratch) {
+    float *real = scratch.fft_in;
+    float *imag = scratch.fft_out;
+    for (size_t i = 0; i < FFT_SIZE; i++) {
+        imag[i] = 0.0f;
+    }
+    fft_complex(real, imag, FFT_SIZE);
+    for (size_t k = 0; k < FFT_SIZE / 2; k++) {
+        scratch.power[k] = real[k] * real[k] + imag[k] * imag[k];
+    }
+}
+
+float FftComplexBackend::band_percent(const float *data, float freq_low, float freq_high,
+                                      SpectralScratch &scratch) {
+    const bool moving = spectral_window(data, scratch);
+    power_spectrum(scratch);
+
+    int bin_low, bin_high;
+    band_bins(freq_low, freq_high, bin_low, bin_high);
+    float total_energy = 0.0f;
+    float band_energy = 0.0f;
+    for (int k = 0; k < (int)FFT_SIZE / 2; k++) {
+        total_energy += scratch.power[k];
+        if (k >= bin_low && k <= bin_high) band_energy += scratch.power[k];
+    }
+    return moving ? percent(band_energy, total_energy) : 0.0f;
+}
+
+// ===================================================
+// Goertzel
+// ===================================================
+// The half-spectrum total comes from Parseval plus the DC and Nyquist
+// bins, so no FFT is needed
+float GoertzelBackend::band_percent(const float *data, float freq_low, float freq_high,
+                                    SpectralScratch &scratch) {
+    const float PI = 3.14159265359f;
+    float *windowed = scratch.fft_in;
+    if (!window_detrended(data, windowed)) return 0.0f;
+
+    float sum_sq = 0.0f;
+    float dc = 0.0f;
+    float nyquist = 0.0f;
+    for (size_t i = 0; i < WINDOW_SAMPLES; i++) {
+        float x = windowed[i];
+        sum_sq += x * x;
+        dc += x;
+        nyquist += (i & 1) ? -x : x;
+    }
+
+    // sum_{k<N/2} |X_k|^2 = (N * sum x^2 + |X_0|^2 - |X_N/2|^2) / 2
+    float total_energy = 0.5f * (FFT_SIZE * sum_sq + dc * dc - nyquist * nyquist);
+
+    int bin_low, bin_high;
+    band_bins(freq_low, freq_high, bin_low, bin_high);
+    float band_energy = 0.0f;
+    for (int k = bin_low; k <= bin_high; k++) {
+        float coeff = 2.0f * cosf(2.0f * PI * k / FFT_SIZE);
+        float s1 = 0.0f;
+        float s2 = 0.0f;
+        for (size_t i = 0; i < WINDOW_SAMPLES; i++) {
+            float s0 = windowed[i] + coeff * s1 - s2;
+            s2 = s1;
+            s1 = s0;
+        }
+        band_energy += s1 * s1 + s2 * s2 - coeff * s1 * s2;
+    }
+
+    if (total_energy <= 0) return 0.0f;
+    return (band_energy / total_energy) * 100.0f;
+}
@@ -0,0 +1,327 @@
+#include "spectral_kernels.h"
+
+#if defined(ARM_MATH_CM4) || defined(ARM_MATH_CM7) || defined(ARM_MATH_CM33)
+// ===================================================
+// Firmware: CMSIS-DSP
+// ===================================================
+#include "arm_math.h"
+
+static arm_rfft_fast_instance_f32 rfft_instance;
+static int rfft_size = 0;
+
+static void cmsis_rfft(float *in, float *out, int n) {
+    if (n != rfft_size) {
+        arm_rfft_fast_init_f32(&rfft_instance, (uint16_t)n);
+        rfft_size = n;
+    }
+    arm_rfft_fast_f32(&rfft_instance, in, out, 0);
+}
+
+static void cmsis_multiply(const float *a, const float *b, float *out, int n) {
+    arm_mult_f32((float32_t *)a, (float32_t *)b, out, (uint32_t)n);
+}
+
+static void cmsis_power(const float *packed, float *power, int n) {
+    arm_cmplx_mag_squared_f32((float32_t *)packed, power, (uint32_t)(n / 2));
+    power[0] = packed[0] * packed[0];   // packed[1] is the Nyquist bin, not Im X[0]
+}
+
+static float cmsis_sum(const float *x, int n) {
+    float s = 0.0f;
+    for (int i = 0; i < n; i++) {
+        s += x[i];
+    }
+    return s;
+}
+
+static const SpectralKernels CMSIS_KERNELS = {"cmsis", cmsis_rfft, cmsis_multiply, cmsis_power, cmsis_sum};
+
+const SpectralKernels &spectral_kernels() {
+    return CMSIS_KERNELS;
+}
+
+size_t spectral_kernel_variants(const SpectralKernels **out, size_t max) {
+    if (max == 0) return 0;
+    out[0] = &CMSIS_KERNELS;
+    return 1;
+}
+
+#else
+// ===================================================
+// Host: one generic implementation, several ISA builds
+// ===================================================
+// Kernels are written once over a GCC vector type V (float for scalar) and
+// force-inlined into per-ISA entry points carrying a target attribute, so
+// each entry point is compiled for its instruction set.
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#define KERNEL_INLINE static inline __attribute__((always_inline))
+
+// Wide vector types only ever cross force-inlined calls, so the
+// pass-by-value ABI notes do not apply
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SPECTRAL_X86 1
+#else
+#define SPECTRAL_X86 0
+#endif
+
+typedef float v4sf __attribute__((vector_size(16)));
+typedef float v8sf __attribute__((vector_size(32)));
+typedef float v16sf __attribute__((vector_size(64)));
+
+// Twiddles for every butterfly span m <= SPECTRAL_MAX_FFT, contiguous per
+// span: exp(-2*pi*i*j/m) for j < m/2 lives at [m/2 - 1 + j]
+static float twiddle_re[SPECTRAL_MAX_FFT];
+static float twiddle_im[SPECTRAL_MAX_FFT];
+
+static bool init_twiddles() {
+    for (int half = 1; half <= SPECTRAL_MAX_FFT / 2; half <<= 1) {
+        for (int j = 0; j < half; j++) {
+            double a = -M_PI * j / half;
+            twiddle_re[half - 1 + j] = (float)cos(a);
+            twiddle_im[half - 1 + j] = (float)sin(a);
+        }
+    }
+    return true;
+}
+
+template <typename V>
+KERNEL_INLINE V load(const float *p) {
+    V v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+template <typename V>
+KERNEL_INLINE void store(float *p, const V &v) {
+    memcpy(p, &v, sizeof(v));
+}
+
+template <typename V>
+KERNEL_INLINE float horizontal_sum(const V &v) {
+    float lanes[sizeof(V) / sizeof(float)];
+    memcpy(lanes, &v, sizeof(v));
+    float s = 0.0f;
+    for (size_t i = 0; i < sizeof(V) / sizeof(float); i++) {
+        s += lanes[i];
+    }
+    return s;
+}
+
+// In-place complex FFT, separate real/imaginary arrays (radix-2 DIT).
+// Butterflies of a stage are contiguous, so spans of at least one vector
+// run W at a time.
+template <typename V>
+KERNEL_INLINE void complex_fft(float *re, float *im, int n) {
+    const int W = sizeof(V) / sizeof(float);
+
+    for (int i = 1, j = 0; i < n; i++) {
+        int bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            float t = re[i]; re[i] = re[j]; re[j] = t;
+            t = im[i]; im[i] = im[j]; im[j] = t;
+        }
+    }
+
+    for (int half = 1; half < n; half <<= 1) {
+        const float *wr = &twiddle_re[half - 1];
+        const float *wi = &twiddle_im[half - 1];
+        for (int k = 0; k < n; k += 2 * half) {
+            float *ar = re + k, *ai = im + k;
+            float *br = re + k + half, *bi = im + k + half;
+            int j = 0;
+            if (half >= W) {
+                for (; j < half; j += W) {
+                    V xr = load<V>(br + j), xi = load<V>(bi + j);
+                    V cr = load<V>(wr + j), ci = load<V>(wi + j);
+                    V tr = xr * cr - xi * ci;
+                    V ti = xr * ci + xi * cr;
+                    V ur = load<V>(ar + j), ui = load<V>(ai + j);
+                    store(ar + j, ur + tr);
+                    store(ai + j, ui + ti);
+                    store(br + j, ur - tr);
+                    store(bi + j, ui - ti);
+                }
+            }
+            for (; j < half; j++) {
+                float tr = br[j] * wr[j] - bi[j] * wi[j];
+                float ti = br[j] * wi[j] + bi[j] * wr[j];
+                br[j] = ar[j] - tr;
+                bi[j] = ai[j] - ti;
+                ar[j] += tr;
+                ai[j] += ti;
+            }
+        }
+    }
+}
+
+// Real FFT through an n/2-point complex FFT of the even/odd samples:
+//   X[k] = (Z[k] + conj(Z[h-k])) / 2 - i/2 * w^k * (Z[k] - conj(Z[h-k]))
+template <typename V>
+KERNEL_INLINE void rfft_body(float *in, float *out, int n) {
+    const int h = n / 2;
+    float re[SPECTRAL_MAX_FFT / 2];
+    float im[SPECTRAL_MAX_FFT / 2];
+    for (int m = 0; m < h; m++) {
+        re[m] = in[2 * m];
+        im[m] = in[2 * m + 1];
+    }
+
+    complex_fft<V>(re, im, h);
+
+    out[0] = re[0] + im[0];
+    out[1] = re[0] - im[0];
+    const float *wr = &twiddle_re[h - 1];
+    const float *wi = &twiddle_im[h - 1];
+    for (int k = 1; k < h; k++) {
+        float er = 0.5f * (re[k] + re[h - k]);
+        float ei = 0.5f * (im[k] - im[h - k]);
+        float or_ = 0.5f * (im[k] + im[h - k]);
+        float oi = -0.5f * (re[k] - re[h - k]);
+        out[2 * k] = er + wr[k] * or_ - wi[k] * oi;
+        out[2 * k + 1] = ei + wr[k] * oi + wi[k] * or_;
+    }
+}
+
+template <typename V>
+KERNEL_INLINE void multiply_body(const float *a, const float *b, float *out, int n) {
+    const int W = sizeof(V) / sizeof(float);
+    int i = 0;
+    for (; i + W <= n; i += W) {
+        store(out + i, load<V>(a + i) * load<V>(b + i));
+    }
+    for (; i < n; i++) {
+        out[i] = a[i] * b[i];
+    }
+}
+
+// Squares interleaved re/im pairs, then folds lane pairs with one shuffle
+template <typename V, typename Mask>
+KERNEL_INLINE void power_body(const float *packed, float *power, int n, const Mask &even, const Mask &odd) {
+    const int W = sizeof(V) / sizeof(float);
+    const int bins = n / 2;
+    int k = 0;
+    for (; k + W <= bins; k += W) {
+        V a = load<V>(packed + 2 * k);
+        V b = load<V>(packed + 2 * k + W);
+        a *= a;
+        b *= b;
+        store(power + k, __builtin_shuffle(a, b, even) + __builtin_shuffle(a, b, odd));
+    }
+    for (; k < bins; k++) {
+        power[k] = packed[2 * k] * packed[2 * k] + packed[2 * k + 1] * packed[2 * k + 1];
+    }
+    power[0] = packed[0] * packed[0];
+}
+
+template <typename V>
+KERNEL_INLINE float sum_body(const float *x, int n) {
+    const int W = sizeof(V) / sizeof(float);
+    V acc0 = {}, acc1 = {};
+    int i = 0;
+    for (; i + 2 * W <= n; i += 2 * W) {
+        acc0 += load<V>(x + i);
+        acc1 += load<V>(x + i + W);
+    }
+    float s = horizontal_sum(acc0 + acc1);
+    for (; i < n; i++) {
+        s += x[i];
+    }
+    return s;
+}
+
+// === Scalar ===
+static void scalar_rfft(float *in, float *out, int n) { rfft_body<float>(in, out, n); }
+static void scalar_multiply(const float *a, const float *b, float *out, int n) { multiply_body<float>(a, b, out, n); }
+static void scalar_power(const float *packed, float *power, int n) {
+    for (int k = 0; k < n / 2; k++) {
+        power[k] = packed[2 * k] * packed[2 * k] + packed[2 * k + 1] * packed[2 * k + 1];
+    }
+    power[0] = packed[0] * packed[0];
+}
+static float scalar_sum(const float *x, int n) {
+    float s = 0.0f;
+    for (int i = 0; i < n; i++) {
+        s += x[i];
+    }
+    return s;
+}
+
+static const SpectralKernels SCALAR_KERNELS = {"scalar", scalar_rfft, scalar_multiply, scalar_power, scalar_sum};
+
+#if SPECTRAL_X86
+typedef int v4si __attribute__((vector_size(16)));
+typedef int v8si __attribute__((vector_size(32)));
+typedef int v16si __attribute__((vector_size(64)));
+
+// Each ISA gets the four entry points with its target attribute
+#define DEFINE_ISA_KERNELS(prefix, isa, V, M, even, odd)                                   \
+    __attribute__((target(isa))) static void prefix##_rfft(float *in, float *out, int n) { \
+        rfft_body<V>(in, out, n);                                                           \
+    }                                                                                       \
+    __attribute__((target(isa))) static void prefix##_multiply(const float *a, const float *b, float *out, int n) { \
+        multiply_body<V>(a, b, out, n);                                                     \
+    }                                                                                       \
+    __attribute__((target(isa))) static void prefix##_power(const float *packed, float *power, int n) { \
+        power_body<V, M>(packed, power, n, (M)even, (M)odd);                                \
+    }                                                                                       \
+    __attribute__((target(isa))) static float prefix##_sum(const float *x, int n) {        \
+        return sum_body<V>(x, n);                                                           \
+    }
+
+#define EVEN4  {0, 2, 4, 6}
+#define ODD4   {1, 3, 5, 7}
+#define EVEN8  {0, 2, 4, 6, 8, 10, 12, 14}
+#define ODD8   {1, 3, 5, 7, 9, 11, 13, 15}
+#define EVEN16 {0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30}
+#define ODD16  {1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31}
+
+DEFINE_ISA_KERNELS(sse42, "sse4.2", v4sf, v4si, EVEN4, ODD4)
+DEFINE_ISA_KERNELS(avx2, "avx2,fma", v8sf, v8si, EVEN8, ODD8)
+DEFINE_ISA_KERNELS(avx512, "avx512f", v16sf, v16si, EVEN16, ODD16)
+
+static const SpectralKernels SSE42_KERNELS = {"sse4.2", sse42_rfft, sse42_multiply, sse42_power, sse42_sum};
+static const SpectralKernels AVX2_KERNELS = {"avx2", avx2_rfft, avx2_multiply, avx2_power, avx2_sum};
+static const SpectralKernels AVX512_KERNELS = {"avx512", avx512_rfft, avx512_multiply, avx512_power, avx512_sum};
+#endif
+
+size_t spectral_kernel_variants(const SpectralKernels **out, size_t max) {
+    static const bool twiddles_ready = init_twiddles();
+    (void)twiddles_ready;
+
+    size_t n = 0;
+    if (n < max) out[n++] = &SCALAR_KERNELS;
+#if SPECTRAL_X86
+    __builtin_cpu_init();
+    if (n < max && __builtin_cpu_supports("sse4.2")) out[n++] = &SSE42_KERNELS;
+    if (n < max && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) out[n++] = &AVX2_KERNELS;
+    if (n < max && __builtin_cpu_supports("avx512f")) out[n++] = &AVX512_KERNELS;
+#endif
+    return n;
+}
+
+static const SpectralKernels *select_kernels() {
+    const SpectralKernels *variants[4];
+    size_t n = spectral_kernel_variants(variants, 4);
+    const char *forced = getenv("SPECTRAL_ISA");
+    if (forced != nullptr) {
+        for (size_t i = 0; i < n; i++) {
+            if (strcmp(variants[i]->name, forced) == 0) return variants[i];
+        }
+    }
+    return variants[n - 1];
+}
+
+const SpectralKernels &spectral_kernels() {
+    static const SpectralKernels *selected = select_kernels();
+    return *selected;
+}
+#endif
@@ -0,0 +1,247 @@
+#include "spectrogram.h"
+#include <cmath>
+#include <cstring>
+
+// Logical byte offsets grow without bound; ring position is offset % size
+static uint8_t  ring[SPECTROGRAM_BYTES];
+static uint32_t tail = 0;             // oldest record (always a key)
+static uint32_t head = 0;             // next record
+static uint32_t last_record = 0;      // offset of the newest record
+static uint32_t last_key = 0;         // offset of the newest key
+static size_t   last_size = 0;
+
+static uint8_t  column[SPECTROGRAM_BINS];   // newest decoded column
+static bool     have_column = false;        // false until a key, and after a gap
+static uint32_t since_key = 0;
+static uint16_t window_seq = 0;
+
+static bool     dumping = false;
+static uint32_t dump_pos = 0;
+
+static uint8_t at(uint32_t offset) {
+    return ring[offset % SPECTROGRAM_BYTES];
+}
+
+static size_t record_size(uint32_t offset) {
+    switch (at(offset)) {
+    case SPECTROGRAM_KEY:   return SPECTROGRAM_KEY_BYTES;
+    case SPECTROGRAM_DELTA: return 2 + at(offset + 1);
+    default:                return 1;
+    }
+}
+
+// Drop the oldest key frame with the deltas and gaps that depend on it
+static void evict_group() {
+    do {
+        tail += record_size(tail);
+    } while (tail != head && at(tail) != SPECTROGRAM_KEY);
+    if (dumping && (int32_t)(dump_pos - tail) < 0) dump_pos = tail;
+}
+
+static void append(const uint8_t *record, size_t n) {
+    while (SPECTROGRAM_BYTES - (head - tail) < n) evict_group();
+    for (size_t i = 0; i < n; i++) ring[(head + i) % SPECTROGRAM_BYTES] = record[i];
+    last_record = head;
+    last_size = n;
+    head += n;
+}
+
+// 0.5 dB steps of power; 20*log10(p) = 20*log10(2) * log2(p)
+static uint8_t level(float power) {
+    if (!(power > 0.0f)) return 0;
+    long q = lrintf(6.0206f * log2f(power)) + SPECTROGRAM_LEVEL_OFFSET;
+    if (q < 0) return 0;
+    if (q > 255) return 255;
+    return (uint8_t)q;
+}
+
+void spectrogram_init() {
+    tail = head = 0;
+    last_record = 0;
+    last_key = 0;
+    last_size = 0;
+    have_column = false;
+    since_key = 0;
+    window_seq = 0;
+    dumping = false;
+}
+
+// Rice code of zigzagged steps: quotient in unary, then k low bits. A
+// quotient of RICE_ESCAPE ones is followed by the absolute level instead.
+static const unsigned RICE_ESCAPE = 12;
+
+static unsigned zigzag(int d) {
+    return d >= 0 ? 2u * d : 2u * -d - 1;
+}
+
+static size_t rice_bits(unsigned u, unsigned k) {
+    unsigned q = u >> k;
+    return q < RICE_ESCAPE ? q + 1 + k : RICE_ESCAPE + 8;
+}
+
+struct BitWriter {
+    uint8_t *out;
+    size_t bits;
+    void put(unsigned value, unsigned count) {
+        while (count--) {
+            size_t byte = bits / 8;
+            if ((bits & 7) == 0) out[byte] = 0;
+            if ((value >> count) & 1) out[byte] |= (uint8_t)(0x80 >> (bits & 7));
+            bits++;
+        }
+    }
+};
+
+struct BitReader {
+    const uint8_t *in;
+    size_t bits;
+    size_t limit;
+    bool get(unsigned count, unsigned &value) {
+        if (bits + count > limit) return false;
+        value = 0;
+        while (count--) {
+            value = (value << 1) | ((in[bits / 8] >> (7 - (bits & 7))) & 1);
+            bits++;
+        }
+        return true;
+    }
+};
+
+void spectrogram_push(const float *power) {
+    uint8_t next[SPECTROGRAM_BINS];
+    for (size_t i = 0; i < SPECTROGRAM_BINS; i++) next[i] = level(power[SPECTROGRAM_BIN_LOW + i]);
+
+    uint8_t record[SPECTROGRAM_RECORD_MAX];
+    size_t n = 0;
+    if (have_column && since_key < SPECTROGRAM_KEY_INTERVAL) {
+        // Smallest Rice parameter for this column's steps
+        size_t bits[8] = {0};
+        for (size_t i = 0; i < SPECTROGRAM_BINS; i++) {
+            unsigned u = zigzag(next[i] - column[i]);
+            for (unsigned k = 0; k < 8; k++) bits[k] += rice_bits(u, k);
+        }
+        unsigned k = 0;
+        for (unsigned j = 1; j < 8; j++) {
+            if (bits[j] < bits[k]) k = j;
+        }
+        n = 3 + (bits[k] + 7) / 8;
+
+        // Otherwise a key frame is no larger, or making room for the
+        // delta would evict the key it depends on
+        if (n < SPECTROGRAM_KEY_BYTES && SPECTROGRAM_BYTES - (head - last_key) >= n) {
+            record[0] = SPECTROGRAM_DELTA;
+            record[1] = (uint8_t)(n - 2);
+            record[2] = (uint8_t)k;
+            BitWriter w{record + 3, 0};
+            for (size_t i = 0; i < SPECTROGRAM_BINS; i++) {
+                unsigned u = zigzag(next[i] - column[i]);
+                unsigned q = u >> k;
+                if (q < RICE_ESCAPE) {
+                    w.put((1u << q) - 1, q);
+                    w.put(0, 1);
+                    w.put(u, k);
+                } else {
+                    w.put((1u << RICE_ESCAPE) - 1, RICE_ESCAPE);
+                    w.put(next[i], 8);
+                }
+            }
+            since_key++;
+        } else {
+            n = 0;
+        }
+    }
+    if (n == 0) {
+        record[0] = SPECTROGRAM_KEY;
+        record[1] = (uint8_t)window_seq;
+        record[2] = (uint8_t)(window_seq >> 8);
+        memcpy(record + 3, next, SPECTROGRAM_BINS);
+        n = SPECTROGRAM_KEY_BYTES;
+        since_key = 1;
+        last_key = head;
+    }
+
+    append(record, n);
+    memcpy(column, next, sizeof(column));
+    have_column = true;
+    window_seq++;
+}
+
+void spectrogram_push_gap() {
+    // A leading gap would have no key to date it
+    if (head != tail) {
+        const uint8_t record = SPECTROGRAM_GAP;
+        append(&record, 1);
+    }
+    have_column = false;
+    window_seq++;
+}
+
+size_t spectrogram_last_record(uint8_t *out, size_t capacity) {
+    if (last_size == 0 || capacity < last_size || (int32_t)(last_record - tail) < 0) return 0;
+    for (size_t i = 0; i < last_size; i++) out[i] = at(last_record + i);
+    return last_size;
+}
+
+void spectrogram_dump_start() {
+    dumping = true;
+    dump_pos = tail;
+}
+
+size_t spectrogram_dump_read(uint8_t *out, size_t capacity) {
+    if (!dumping) return 0;
+    size_t copied = 0;
+    while (dump_pos != head) {
+        size_t n = record_size(dump_pos);
+        if (copied + n > capacity) break;
+        for (size_t i = 0; i < n; i++) out[copied + i] = at(dump_pos + i);
+        copied += n;
+        dump_pos += n;
+    }
+    if (copied == 0) dumping = false;
+    return copied;
+}
+
+size_t spectrogram_decode_record(const uint8_t *record, size_t length,
+                                 uint8_t out[SPECTROGRAM_BINS]) {
+    if (length == 0) return 0;
+    switch (record[0]) {
+    case SPECTROGRAM_KEY:
+        if (length < SPECTROGRAM_KEY_BYTES) return 0;
+        memcpy(out, record + 3, SPECTROGRAM_BINS);
+        return SPECTROGRAM_KEY_BYTES;
+
+    case SPECTROGRAM_DELTA: {
+        if (length < 3 || length < 2 + (size_t)record[1] || record[2] > 7) return 0;
+        const unsigned k = record[2];
+        BitReader r{record + 3, 0, 8 * ((size_t)record[1] - 1)};
+        for (size_t i = 0; i < SPECTROGRAM_BINS; i++) {
+            unsigned q = 0, bit = 1, value;
+            while (q < RICE_ESCAPE) {
+                if (!r.get(1, bit)) return 0;
+                if (bit == 0) break;
+                q++;
+            }
+            if (q == RICE_ESCAPE) {
+                if (!r.get(8, value)) return 0;
+                out[i] = (uint8_t)value;
+                continue;
+            }
+            if (!r.get(k, value)) return 0;
+            unsigned u = (q << k) | value;
+            int d = (u & 1) ? -(int)((u + 1) / 2) : (int)(u / 2);
+            out[i] = (uint8_t)(out[i] + d);
+        }
+        return 2 + record[1];
+    }
+
+    case SPECTROGRAM_GAP:
+        return 1;
+
+    default:
+        return 0;
+    }
+}
+
+size_t spectrogram_used_bytes() {
+    return head - tail;
+}
@@ -0,0 +1,133 @@
+#include "timer_wheel.h"
+
+static constexpr uint32_t SLOT_MASK = TIMER_WHEEL_SLOTS - 1;
+static constexpr uint32_t MAX_DELTA = (1u << (TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOT_BITS)) - 1;
+
+static void list_init(TimerNode &head) {
+    head.next = &head;
+    head.prev = &head;
+}
+
+static void list_unlink(TimerNode &node) {
+    node.prev->next = node.next;
+    node.next->prev = node.prev;
+    node.next = nullptr;
+    node.prev = nullptr;
+}
+
+static void list_push(TimerNode &head, TimerNode &node) {
+    node.prev = head.prev;
+    node.next = &head;
+    head.prev->next = &node;
+    head.prev = &node;
+}
+
+// Place a node in the slot matching its distance from `now`
+static void place(TimerWheel &wheel, TimerNode &node) {
+    uint32_t delta = node.expires - wheel.now;
+    uint32_t when = node.expires;
+
+    if ((int32_t)delta < 0) {
+        // Already due: next tick
+        delta = 0;
+        when = wheel.now;
+    } else if (delta > MAX_DELTA) {
+        // Beyond the wheel: park at the far edge, re-placed on cascade
+        delta = MAX_DELTA;
+        when = wheel.now + MAX_DELTA;
+    }
+
+    int level = 0;
+    while (level < TIMER_WHEEL_LEVELS - 1 &&
+           delta >= (1u << ((level + 1) * TIMER_WHEEL_SLOT_BITS))) {
+        level++;
+    }
+    uint32_t slot = (when >> (level * TIMER_WHEEL_SLOT_BITS)) & SLOT_MASK;
+    list_push(wheel.slots[level][slot], node);
+}
+
+// Move every node in one higher-level slot down to its finer position
+static void cascade(TimerWheel &wheel, int level) {
+    uint32_t slot = (wheel.now >> (level * TIMER_WHEEL_SLOT_BITS)) & SLOT_MASK;
+    TimerNode &head = wheel.slots[level][slot];
+
+    TimerNode *node = head.next;
+    list_init(head);
+    while (node != &head) {
+        TimerNode *next = node->next;
+        place(wheel, *node);
+        node = next;
+    }
+}
+
+void timer_wheel_init(TimerWheel &wheel, uint32_t now) {
+    for (int l = 0; l < TIMER_WHEEL_LEVELS; l++) {
+        for (int s = 0; s < TIMER_WHEEL_SLOTS; s++) {
+            list_init(wheel.slots[l][s]);
+        }
+    }
+    wheel.now = now;
+    wheel.pending = 0;
+}
+
+void timer_node_init(TimerNode &node, TimerCallback callback, void *context) {
+    node.next = nullptr;
+    node.prev = nullptr;
+    node.expires = 0;
+    node.callback = callback;
+    node.context = context;
+}
+
+bool timer_node_pending(const TimerNode &node) {
+    return node.next != nullptr;
+}
+
+void timer_wheel_schedule(TimerWheel &wheel, TimerNode &node, uint32_t expires) {
+    if (timer_node_pending(node)) {
+        list_unlink(node);
+    } else {
+        wheel.pending++;
+    }
+    node.expires = expires;
+    place(wheel, node);
+}
+
+void timer_wheel_cancel(TimerWheel &wheel, TimerNode &node) {
+    if (!timer_node_pending(node)) return;
+    list_unlink(node);
+    wheel.pending--;
+}
+
+void timer_wheel_advance(TimerWheel &wheel, uint32_t now) {
+    while ((int32_t)(now - wheel.now) >= 0) {
+        if (wheel.pending == 0) {
+            // Nothing scheduled: jump straight to the target tick
+            wheel.now = now + 1;
+            return;
+        }
+
+        uint32_t slot = wheel.now & SLOT_MASK;
+        if (slot == 0) {
+            // Level 0 wrapped: pull down the next coarser slot(s)
+            for (int level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+                cascade(wheel, level);
+                if (((wheel.now >> (level * TIMER_WHEEL_SLOT_BITS)) & SLOT_MASK) != 0) break;
+            }
+        }
+
+        TimerNode &head = wheel.slots[0][slot];
+        while (head.next != &head) {
+            TimerNode &node = *head.next;
+            list_unlink(node);
+            wheel.pending--;
+            if ((int32_t)(node.expires - wheel.now) > 0) {
+                // Parked far-future timer, not actually due yet
+                wheel.pending++;
+                place(wheel, node);
+                continue;
+            }
+            node.callback(node);
+        }
+        wheel.now++;
+    }
+}
@@ -0,0 +1,107 @@
+#include "trace.h"
+
+#if defined(__ARM_ARCH_7EM__) || defined(__ARM_ARCH_7M__)
+#include "cmsis.h"
+#include "hal/lp_ticker_api.h"
+#include "hal/ticker_api.h"
+#define TRACE_USE_DWT 1
+#elif defined(SIM_VIRTUAL_TIME)
+#include "mbed.h"            // host simulator: virtual microseconds
+#define TRACE_USE_DWT 0
+#else
+#include <chrono>
+#define TRACE_USE_DWT 0
+#endif
+
+static_assert((TRACE_BUFFER_EVENTS & (TRACE_BUFFER_EVENTS - 1)) == 0,
+              "TRACE_BUFFER_EVENTS must be a power of two");
+
+static TraceEvent ring[TRACE_BUFFER_EVENTS];
+static uint32_t head = 0;       // total records written (wraps)
+static uint32_t tail = 0;       // first record not yet drained
+static uint32_t dropped = 0;
+static bool paused = false;
+
+#if TRACE_USE_DWT
+// CYCCNT resolves 12.5 ns but stops in Stop mode (most of the time under
+// tickless idle) and wraps every ~54 s at 80 MHz. Timestamps are
+// microseconds: cycles since an anchor taken from the low-power ticker,
+// which keeps counting in deep sleep, re-taken by trace_resync() on wake.
+static uint32_t anchor_us = 0;
+static uint32_t anchor_cycles = 0;
+static uint32_t cycles_per_us = 1;
+#endif
+
+static inline uint32_t trace_clock() {
+#if TRACE_USE_DWT
+    return anchor_us + (DWT->CYCCNT - anchor_cycles) / cycles_per_us;
+#elif defined(SIM_VIRTUAL_TIME)
+    return us_ticker_read();
+#else
+    using namespace std::chrono;
+    return (uint32_t)duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+void trace_resync() {
+#if TRACE_USE_DWT
+    uint32_t cycles = DWT->CYCCNT;
+    uint32_t lp_us = (uint32_t)ticker_read_us(get_lp_ticker_data());
+    uint32_t extrapolated = anchor_us + (cycles - anchor_cycles) / cycles_per_us;
+    // The ticker resolves ~30 us and its crystal drifts against the core
+    // clock; never let a re-anchor step time backwards
+    anchor_us = (int32_t)(lp_us - extrapolated) > 0 ? lp_us : extrapolated;
+    anchor_cycles = cycles;
+#endif
+}
+
+void trace_init() {
+#if TRACE_USE_DWT
+    // Cycle counter: enable trace, reset and start CYCCNT
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    cycles_per_us = SystemCoreClock / 1000000;
+    anchor_us = (uint32_t)ticker_read_us(get_lp_ticker_data());
+    anchor_cycles = 0;
+#endif
+    head = tail = 0;
+    dropped = 0;
+    paused = false;
+}
+
+uint32_t trace_clock_hz() {
+    return 1000000;
+}
+
+void trace_record(TraceStage stage, TracePhase phase, uint16_t arg) {
+    if (paused) return;
+    TraceEvent &e = ring[head & (TRACE_BUFFER_EVENTS - 1)];
+    e.timestamp_us = trace_clock();
+    e.stage = stage;
+    e.phase = phase;
+    e.arg = arg;
+    head++;
+    if (head - tail > TRACE_BUFFER_EVENTS) {
+        tail++;
+        dropped++;
+    }
+}
+
+void trace_pause(bool pause) {
+    paused = pause;
+}
+
+size_t trace_drain(TraceEvent *out, size_t max_events) {
+    size_t n = 0;
+    while (tail != head && n < max_events) {
+        out[n++] = ring[tail & (TRACE_BUFFER_EVENTS - 1)];
+        tail++;
+    }
+    if (tail == head) dropped = 0;
+    return n;
+}
+
+uint32_t trace_dropped() {
+    return dropped;
+}
@@ -0,0 +1,135 @@
+#include "tremor_tracker.h"
+#include <cmath>
+
+static const float TWO_PI = 6.28318530718f;
+
+// Adaptation gains, normalized by the band-passed signal power
+static const float MU_WEIGHTS = 0.02f;
+static const float MU_FREQ    = 0.0015f;
+static const float POWER_ALPHA = 0.02f;   // ~1 s power averaging at 52 Hz
+
+// Lock: share of the band-passed power the sinusoid explains, with hysteresis
+static const float LOCK_ENTER = 0.6f;
+static const float LOCK_EXIT  = 0.4f;
+
+// Band-pass sections in cascade. One section passes 0.35 of a 1 Hz
+// voluntary swing, enough to drown a 0.02 g tremor; three pass 0.04.
+static const int BP_SECTIONS = 3;
+
+static float fs = 52.0f;
+static float band_low = 3.0f;
+static float band_high = 5.0f;
+
+// Band-pass biquad (RBJ, 0 dB peak), identical sections
+static float b0, b2, a1, a2;
+static float bp_x1[BP_SECTIONS], bp_x2[BP_SECTIONS], bp_y1[BP_SECTIONS], bp_y2[BP_SECTIONS];
+
+// DC blocker for the reference power
+static float dc_prev_in, dc_prev_out;
+
+// WFLC state
+static float omega;        // rad/sample
+static float phase;
+static float w_sin, w_cos;
+static float band_power;   // EWMA of band-passed power
+static float error_power;  // EWMA of the combiner's residual power
+static float total_power;  // EWMA of DC-removed power
+static bool locked;
+
+void tremor_tracker_init(float fs_hz, float band_low_hz, float band_high_hz) {
+    fs = fs_hz;
+    band_low = band_low_hz;
+    band_high = band_high_hz;
+
+    // Pass band covers the tracking range with margin on both sides
+    float f0 = sqrtf(band_low * band_high);
+    float bw_oct = log2f((band_high + 2.0f) / (band_low > 1.5f ? band_low - 1.0f : 0.5f));
+    float w0 = TWO_PI * f0 / fs;
+    float alpha = sinf(w0) * sinhf(0.34657359f * bw_oct * w0 / sinf(w0));
+    float a0 = 1.0f + alpha;
+    b0 = alpha / a0;
+    b2 = -alpha / a0;
+    a1 = -2.0f * cosf(w0) / a0;
+    a2 = (1.0f - alpha) / a0;
+    for (int k = 0; k < BP_SECTIONS; k++) bp_x1[k] = bp_x2[k] = bp_y1[k] = bp_y2[k] = 0.0f;
+
+    dc_prev_in = dc_prev_out = 0.0f;
+
+    omega = TWO_PI * f0 / fs;
+    phase = 0.0f;
+    w_sin = w_cos = 0.0f;
+    band_power = total_power = error_power = 1e-6f;
+    locked = false;
+}
+
+void tremor_tracker_update(float sample) {
+    // Reference power of the whole moving signal (DC removed)
+    float dc_out = sample - dc_prev_in + 0.98f * dc_prev_out;
+    dc_prev_in = sample;
+    dc_prev_out = dc_out;
+    total_power += POWER_ALPHA * (dc_out * dc_out - total_power);
+
+    // Band-pass into the tremor range
+    float s = sample;
+    for (int k = 0; k < BP_SECTIONS; k++) {
+        float y = b0 * s + b2 * bp_x2[k] - a1 * bp_y1[k] - a2 * bp_y2[k];
+        bp_x2[k] = bp_x1[k];
+        bp_x1[k] = s;
+        bp_y2[k] = bp_y1[k];
+        bp_y1[k] = y;
+        s = y;
+    }
+    band_power += POWER_ALPHA * (s * s - band_power);
+
+    // WFLC: one harmonic, frequency adapted from the quadrature error
+    phase += omega;
+    if (phase > TWO_PI) phase -= TWO_PI;
+    float sn = sinf(phase);
+    float cs = cosf(phase);
+
+    float err = s - (w_sin * sn + w_cos * cs);
+    error_power += POWER_ALPHA * (err * err - error_power);
+    float explained = 1.0f - error_power / (band_power + 1e-9f);
+    if (locked ? explained < LOCK_EXIT : explained > LOCK_ENTER) locked = !locked;
+    float norm = 1.0f / (band_power + 1e-6f);
+
+    omega += 2.0f * MU_FREQ * norm * err * (w_sin * cs - w_cos * sn);
+    float omega_min = TWO_PI * (band_low - 1.0f) / fs;
+    float omega_max = TWO_PI * (band_high + 2.0f) / fs;
+    if (omega < omega_min) omega = omega_min;
+    if (omega > omega_max) omega = omega_max;
+
+    w_sin += 2.0f * MU_WEIGHTS * err * sn;
+    w_cos += 2.0f * MU_WEIGHTS * err * cs;
+}
+
+// Magnitude response of the band-pass cascade at w rad/sample
+static float bandpass_gain(float w) {
+    float c1 = cosf(w), s1 = sinf(w);
+    float c2 = cosf(2.0f * w), s2 = sinf(2.0f * w);
+    float num_re = b0 + b2 * c2;
+    float num_im = -b2 * s2;
+    float den_re = 1.0f + a1 * c1 + a2 * c2;
+    float den_im = -a1 * s1 - a2 * s2;
+    float gain = sqrtf((num_re * num_re + num_im * num_im) /
+                       (den_re * den_re + den_im * den_im + 1e-12f));
+    float cascade = 1.0f;
+    for (int k = 0; k < BP_SECTIONS; k++) cascade *= gain;
+    return cascade;
+}
+
+TremorEstimate tremor_tracker_estimate() {
+    TremorEstimate e{};
+    e.locked = locked;
+    if (!locked) return e;
+
+    e.frequency_hz = omega * fs / TWO_PI;
+    // Undo the pre-filter attenuation at the tracked frequency
+    e.amplitude_g = sqrtf(w_sin * w_sin + w_cos * w_cos) / bandpass_gain(omega);
+
+    float explained = 0.5f * e.amplitude_g * e.amplitude_g / (total_power + 1e-9f);
+    if (explained > 1.0f) explained = 1.0f;
+    bool in_band = e.frequency_hz >= band_low && e.frequency_hz <= band_high;
+    e.intensity = in_band ? explained * 100.0f : 0.0f;
+    return e;
+}
@@ -0,0 +1,344 @@
+// Host comparison of the spectral backends on identical windows.
+//
+//   g++ -std=gnu++14 -O2 -Iinclude tools/bench_backends.cpp src/spectral_backend.cpp src/spectral_kernels.cpp src/detect_core.cpp src/harmonic_canceller.cpp src/activity.cpp src/baseline.cpp src/multitaper.cpp -o bench_backends
+//   ./bench_backends
+//
+// Band analysis: time per band_percent() call (ns, and TSC cycles on x86),
+// scratch bytes the backend writes, and the worst error in band percent
+// against a double-precision DFT of the same detrended, Hann-windowed
+// window (no share under the motion gate), over
+// synthetic rest / tremor / gait / dyskinesia / noise windows and the
+// tremor, dyskinesia and 0.5-15 Hz bands.
+// Pipeline: detect_stream_window_with<Backend> over the same x/y/z stream,
+// time per window and the largest intensity difference and detection
+// mismatches against the rfft backend.
+// Load-shed tiers: detect_stream_window() on the same stream at each
+// AnalysisTier, time per window against TIER_FULL, with Goertzel on both
+// bands for comparison.
+// Contexts: the same pipeline's time per window grouped by the activity
+// context, with the detectors that context's policy runs.
+// Multitaper: time per tremor-band share against the single Hann window
+// (rfft), and the mean and variance of that share over noisy 4.2 Hz
+// tremor windows.
+
+#include "dpss_tapers.h"
+#include "multitaper.h"
+#include "spectral_backend.h"
+#include "spectral_kernels.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+static uint64_t cycles() { return __rdtsc(); }
+#else
+static uint64_t cycles() { return 0; }
+#endif
+
+static volatile float sink;
+
+struct Timing {
+    double ns;
+    double cycles;
+};
+
+template <typename F>
+static Timing time_call(F fn) {
+    using Clock = std::chrono::steady_clock;
+    int iters = 1000;
+    for (;;) {
+        auto t0 = Clock::now();
+        uint64_t c0 = cycles();
+        for (int i = 0; i < iters; i++) {
+            fn();
+        }
+        uint64_t c1 = cycles();
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+        if (ns > 2e8) return Timing{ns / iters, (double)(c1 - c0) / iters};
+        iters *= 4;
+    }
+}
+
+static const int WINDOWS = 5;
+static const char *const WINDOW_NAMES[WINDOWS] = {"rest", "tremor", "gait", "dyskinesia", "noise"};
+static const float BANDS[3][2] = {
+    {TREMOR_F_LOW, TREMOR_F_HIGH}, {DYSK_F_LOW, DYSK_F_HIGH}, {0.5f, 15.0f}};
+
+static uint32_t rng = 1;
+static float noise() {
+    rng = rng * 1664525u + 1013904223u;
+    return ((rng >> 8) / 16777216.0f) - 0.5f;
+}
+
+// Vector magnitude in g; gravity plus the movement of each scenario
+static void make_window(int kind, float *out) {
+    const double TWO_PI = 2.0 * M_PI;
+    for (size_t i = 0; i < WINDOW_SAMPLES; i++) {
+        double t = i / (double)FS_HZ;
+        double g = 1.0 + 0.005 * noise();
+        switch (kind) {
+        case 1: g += 0.08 * sin(TWO_PI * 4.2 * t) + 0.01 * noise(); break;
+        case 2: g += 0.25 * sin(TWO_PI * 1.8 * t) + 0.1 * sin(TWO_PI * 3.6 * t + 0.4); break;
+        case 3: g += 0.15 * sin(TWO_PI * 0.9 * t) + 0.12 * sin(TWO_PI * 6.1 * t + 1.0); break;
+        case 4: g += 0.2 * noise(); break;
+        default: break;
+        }
+        out[i] = (float)g;
+    }
+}
+
+static double reference_percent(const float *data, float freq_low, float freq_high) {
+    const float *hann = spectral_hann_window();
+    double mean = 0.0;
+    for (size_t i = 0; i < WINDOW_SAMPLES; i++) mean += data[i];
+    mean /= WINDOW_SAMPLES;
+    int bin_low = (int)(freq_low * FFT_SIZE / FS_HZ);
+    int bin_high = (int)(freq_high * FFT_SIZE / FS_HZ);
+    if (bin_high > (int)FFT_SIZE / 2 - 1) bin_high = FFT_SIZE / 2 - 1;
+    double energy = 0.0, hann_sq = 0.0;
+    for (size_t i = 0; i < WINDOW_SAMPLES; i++) {
+        energy += ((double)data[i] - mean) * hann[i] * ((double)data[i] - mean) * hann[i];
+        hann_sq += (double)hann[i] * hann[i];
+    }
+    if (energy < (double)MOTION_GATE_STD_G * MOTION_GATE_STD_G * hann_sq) return 0.0;   // still
+    double band = 0.0, total = 0.0;
+    for (size_t k = 0; k < FFT_SIZE / 2; k++) {
+        double re = 0.0, im = 0.0;
+        for (size_t i = 0; i < WINDOW_SAMPLES; i++) {
+            double x = ((double)data[i] - mean) * hann[i];
+            double a = -2.0 * M_PI * (double)(k * i % FFT_SIZE) / FFT_SIZE;
+            re += x * cos(a);
+            im += x * sin(a);
+        }
+        double p = re * re + im * im;
+        total += p;
+        if ((int)k >= bin_low && (int)k <= bin_high) band += p;
+    }
+    return total > 0.0 ? 100.0 * band / total : 0.0;
+}
+
+// Bytes of the scratch a call writes: paint, run, count what changed
+template <typename Backend>
+static size_t scratch_written(const float *data) {
+    static SpectralScratch scratch, painted;
+    memset(&painted, 0xA5, sizeof(painted));
+    memcpy(&scratch, &painted, sizeof(scratch));
+    Backend::band_percent(data, TREMOR_F_LOW, TREMOR_F_HIGH, scratch);
+    const uint8_t *a = (const uint8_t *)&scratch, *b = (const uint8_t *)&painted;
+    size_t written = 0;
+    for (size_t i = 0; i < sizeof(scratch); i += sizeof(float)) {
+        if (memcmp(a + i, b + i, sizeof(float)) != 0) written += sizeof(float);
+    }
+    return written;
+}
+
+static float windows[WINDOWS][WINDOW_SAMPLES];
+static double reference[WINDOWS][3];
+
+template <typename Backend>
+static void bench_band() {
+    static SpectralScratch scratch;
+    double worst = 0.0;
+    for (int w = 0; w < WINDOWS; w++) {
+        for (int b = 0; b < 3; b++) {
+            double p = Backend::band_percent(windows[w], BANDS[b][0], BANDS[b][1], scratch);
+            worst = fmax(worst, fabs(p - reference[w][b]));
+        }
+    }
+    Timing t = time_call([&] {
+        sink = Backend::band_percent(windows[1], TREMOR_F_LOW, TREMOR_F_HIGH, scratch);
+    });
+    Timing wide = time_call([&] {
+        sink = Backend::band_percent(windows[1], 0.5f, 15.0f, scratch);
+    });
+    printf("%-12s %10.0f %10.0f %12.0f %10zu %14.2e %6s\n", Backend::name(), t.ns, t.cycles,
+           wide.ns, scratch_written<Backend>(windows[1]), worst,
+           Backend::FULL_SPECTRUM ? "yes" : "no");
+}
+
+// Two minutes of each scenario as x/y/z, the magnitude split across the axes
+static std::vector<float> make_stream() {
+    std::vector<float> xyz;
+    float window[WINDOW_SAMPLES];
+    for (int kind = 0; kind < WINDOWS; kind++) {
+        for (int repeat = 0; repeat < 40; repeat++) {
+            make_window(kind, window);
+            for (size_t i = 0; i < WINDOW_SAMPLES; i++) {
+                xyz.push_back(0.3f * window[i] + 0.01f * noise());
+                xyz.push_back(0.2f * window[i] + 0.01f * noise());
+                xyz.push_back(0.93f * window[i]);
+            }
+        }
+    }
+    return xyz;
+}
+
+template <typename Backend>
+static void run_stream(const std::vector<float> &xyz, std::vector<DetectWindowResult> &out,
+                       AnalysisTier tier = TIER_FULL) {
+    static DetectStream stream;
+    detect_stream_init(stream);
+    out.clear();
+    for (size_t at = 0; at + WINDOW_SAMPLES * 3 <= xyz.size(); at += WINDOW_SAMPLES * 3) {
+        out.push_back(detect_stream_window_with<Backend>(stream, &xyz[at], tier));
+    }
+}
+
+template <typename Backend>
+static void bench_pipeline(const std::vector<float> &xyz, const std::vector<DetectWindowResult> &base) {
+    std::vector<DetectWindowResult> results;
+    Timing t = time_call([&] { run_stream<Backend>(xyz, results); });
+    float tremor = 0.0f, dysk = 0.0f;
+    int mismatches = 0;
+    for (size_t i = 0; i < results.size(); i++) {
+        tremor = fmaxf(tremor, fabsf(results[i].tremor_intensity - base[i].tremor_intensity));
+        dysk = fmaxf(dysk, fabsf(results[i].dyskinesia_intensity - base[i].dyskinesia_intensity));
+        mismatches += results[i].tremor_detected != base[i].tremor_detected;
+        mismatches += results[i].dyskinesia_detected != base[i].dyskinesia_detected;
+        mismatches += results[i].fog_state != base[i].fog_state;
+    }
+    printf("%-12s %10.0f %12.2e %12.2e %10d\n", Backend::name(), t.ns / results.size(),
+           tremor, dysk, mismatches);
+}
+
+template <typename Backend>
+static double tier_bands_ns(const float *tremor, const float *total) {
+    static SpectralScratch scratch;
+    return time_call([&] {
+        sink = Backend::band_percent(tremor, TREMOR_F_LOW, TREMOR_F_HIGH, scratch) +
+               Backend::band_percent(total, DYSK_F_LOW, DYSK_F_HIGH, scratch);
+    }).ns;
+}
+
+static void bench_tiers(const std::vector<float> &xyz) {
+    static const char *const NAMES[TIER_COUNT] = {"full", "long hop", "gate only"};
+    std::vector<DetectWindowResult> results;
+    double ns[TIER_COUNT];
+    printf("\n%-22s %10s %10s\n", "tier (pipeline)", "ns/window", "vs full");
+    for (int tier = 0; tier < TIER_COUNT; tier++) {
+        ns[tier] = time_call([&] {
+            run_stream<RfftBackend>(xyz, results, (AnalysisTier)tier);
+        }).ns / results.size();
+        printf("%-22s %10.0f %9.2fx\n", NAMES[tier], ns[tier], ns[tier] / ns[TIER_FULL]);
+    }
+    double bands = tier_bands_ns<RfftBackend>(windows[1], windows[3]);
+    double goertzel = tier_bands_ns<GoertzelBackend>(windows[1], windows[3]);
+    printf("%-22s %10.0f %9.2fx   (both bands only, rfft %.0f ns)\n", "goertzel (dropped)",
+           ns[TIER_FULL] - bands + goertzel, (ns[TIER_FULL] - bands + goertzel) / ns[TIER_FULL],
+           bands);
+}
+
+// Band share of a weak tremor in broadband noise, fresh noise and phase
+// per window, from the single Hann periodogram and from the multitaper
+// average; the spread across windows is the estimator's variance
+static void bench_multitaper() {
+    static SpectralScratch scratch;
+    static float power[FFT_SIZE / 2];
+    const int TRIALS = 2000;
+    const double TWO_PI = 2.0 * M_PI;
+    float window[WINDOW_SAMPLES];
+    double sum[2] = {}, sum_sq[2] = {};
+    for (int trial = 0; trial < TRIALS; trial++) {
+        double phase = TWO_PI * (noise() + 0.5f);
+        for (size_t i = 0; i < WINDOW_SAMPLES; i++) {
+            double t = i / (double)FS_HZ;
+            window[i] = (float)(1.0 + 0.05 * sin(TWO_PI * 4.2 * t + phase) + 0.3 * noise());
+        }
+        multitaper_power_spectrum(window, power);
+        double p[2] = {RfftBackend::band_percent(window, TREMOR_F_LOW, TREMOR_F_HIGH, scratch),
+                       band_energy_percent(power, TREMOR_F_LOW, TREMOR_F_HIGH)};
+        for (int e = 0; e < 2; e++) {
+            sum[e] += p[e];
+            sum_sq[e] += p[e] * p[e];
+        }
+    }
+    double var[2];
+    for (int e = 0; e < 2; e++) {
+        double mean = sum[e] / TRIALS;
+        var[e] = sum_sq[e] / TRIALS - mean * mean;
+    }
+
+    Timing hann = time_call([&] {
+        sink = RfftBackend::band_percent(windows[1], TREMOR_F_LOW, TREMOR_F_HIGH, scratch);
+    });
+    Timing taper = time_call([&] {
+        multitaper_power_spectrum(windows[1], power);
+        sink = band_energy_percent(power, TREMOR_F_LOW, TREMOR_F_HIGH);
+    });
+
+    printf("\n%-12s %10s %10s %12s %10s   (%d noisy 4.2 Hz windows, tremor band)\n",
+           "estimator", "ns", "mean (%)", "variance", "vs hann", TRIALS);
+    printf("%-12s %10.0f %10.2f %12.2f %9.2fx\n", "hann (rfft)", hann.ns, sum[0] / TRIALS,
+           var[0], 1.0);
+    printf("%-12s %10.0f %10.2f %12.2f %9.2fx   (%d tapers)\n", "multitaper", taper.ns,
+           sum[1] / TRIALS, var[1], var[1] / var[0], DPSS_K);
+}
+
+// Pipeline cost per window by the activity context the stream was in,
+// which is what the context's detector policy pays
+static void bench_contexts(const std::vector<float> &xyz) {
+    using Clock = std::chrono::steady_clock;
+    static DetectStream stream;
+    const int REPEATS = 200;
+    double ns[ACTIVITY_COUNT] = {};
+    int count[ACTIVITY_COUNT] = {};
+    for (int rep = 0; rep < REPEATS; rep++) {
+        detect_stream_init(stream);
+        for (size_t at = 0; at + WINDOW_SAMPLES * 3 <= xyz.size(); at += WINDOW_SAMPLES * 3) {
+            auto t0 = Clock::now();
+            DetectWindowResult r = detect_stream_window_with<RfftBackend>(stream, &xyz[at],
+                                                                        TIER_FULL);
+            ns[r.activity] += std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+            count[r.activity]++;
+        }
+    }
+    printf("\n%-12s %10s %10s   detectors\n", "context", "windows", "ns/window");
+    for (int c = 0; c < ACTIVITY_COUNT; c++) {
+        if (count[c] == 0) continue;
+        const DetectorPolicy &policy = activity_policy((ActivityContext)c);
+        printf("%-12s %10d %10.0f   %s%s%s%s\n", activity_name((ActivityContext)c),
+               count[c] / REPEATS, ns[c] / count[c], policy.run_tremor ? "tremor " : "",
+               policy.run_tremor_axes ? "axes " : "", policy.run_dyskinesia ? "dysk " : "",
+               policy.run_fog ? "fog" : "");
+    }
+}
+
+int main() {
+    for (int w = 0; w < WINDOWS; w++) {
+        make_window(w, windows[w]);
+        for (int b = 0; b < 3; b++) {
+            reference[w][b] = reference_percent(windows[w], BANDS[b][0], BANDS[b][1]);
+        }
+    }
+
+    printf("kernels: %s, %zu-point windows in %zu-point transforms\n", spectral_kernels().name,
+           WINDOW_SAMPLES, FFT_SIZE);
+    printf("windows:");
+    for (int w = 0; w < WINDOWS; w++) printf(" %s", WINDOW_NAMES[w]);
+    printf("; scratch is %zu bytes\n\n", sizeof(SpectralScratch));
+
+    printf("%-12s %10s %10s %12s %10s %14s %6s\n",
+           "backend", "tremor ns", "cycles", "0.5-15Hz ns", "scratch B", "max err (%pt)", "power");
+    bench_band<RfftBackend>();
+    bench_band<FftComplexBackend>();
+    bench_band<GoertzelBackend>();
+
+    std::vector<float> xyz = make_stream();
+    bench_tiers(xyz);
+    bench_contexts(xyz);
+    bench_multitaper();
+
+    std::vector<DetectWindowResult> base;
+    run_stream<RfftBackend>(xyz, base);
+    printf("\n%-12s %10s %12s %12s %10s   (%zu windows, against rfft)\n",
+           "pipeline", "ns/window", "tremor diff", "dysk diff", "mismatch", base.size());
+    bench_pipeline<RfftBackend>(xyz, base);
+    bench_pipeline<FftComplexBackend>(xyz, base);
+    bench_pipeline<GoertzelBackend>(xyz, base);
+    return 0;
+}
@@ -0,0 +1,70 @@
+// Host benchmark of the spectral kernel variants the CPU supports.
+//
+//   g++ -std=gnu++14 -O2 -Iinclude tools/bench_spectral.cpp src/spectral_kernels.cpp -o bench_spectral
+//   ./bench_spectral
+//
+// Prints ns per call for each kernel and for the full window pipeline
+// (Hann multiply, real FFT, power spectrum, band + total sums).
+
+#include "spectral_kernels.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+
+static volatile float sink;
+
+template <typename F>
+static double time_ns(F fn) {
+    using Clock = std::chrono::steady_clock;
+    int iters = 1000;
+    for (;;) {
+        auto t0 = Clock::now();
+        for (int i = 0; i < iters; i++) {
+            fn();
+        }
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+        if (ns > 2e8) return ns / iters;
+        iters *= 4;
+    }
+}
+
+int main() {
+    const SpectralKernels *variants[4];
+    size_t count = spectral_kernel_variants(variants, 4);
+    printf("selected: %s\n\n", spectral_kernels().name);
+    printf("%-8s %6s %10s %10s %10s %10s %12s\n",
+           "isa", "n", "rfft", "multiply", "power", "sum", "pipeline");
+
+    static float signal[SPECTRAL_MAX_FFT], window[SPECTRAL_MAX_FFT];
+    static float in[SPECTRAL_MAX_FFT], out[SPECTRAL_MAX_FFT], power[SPECTRAL_MAX_FFT / 2];
+
+    for (int n : {256, 1024}) {
+        for (int i = 0; i < n; i++) {
+            signal[i] = sinf(0.3f * i) + 0.1f * cosf(2.1f * i);
+            window[i] = 0.5f * (1.0f - cosf(2.0f * (float)M_PI * i / (n - 1)));
+        }
+        for (size_t v = 0; v < count; v++) {
+            const SpectralKernels &k = *variants[v];
+            double rfft = time_ns([&] {
+                memcpy(in, signal, n * sizeof(float));
+                k.rfft(in, out, n);
+                sink = out[2];
+            });
+            double mul = time_ns([&] { k.multiply(signal, window, in, n); sink = in[1]; });
+            double pow = time_ns([&] { k.power(out, power, n); sink = power[1]; });
+            double sum = time_ns([&] { sink = k.sum(power, n / 2); });
+            double pipe = time_ns([&] {
+                k.multiply(signal, window, in, n);
+                k.rfft(in, out, n);
+                k.power(out, power, n);
+                sink = k.sum(power + n / 16, n / 16) / k.sum(power, n / 2);
+            });
+            printf("%-8s %6d %10.0f %10.0f %10.0f %10.0f %12.0f\n",
+                   k.name, n, rfft, mul, pow, sum, pipe);
+        }
+    }
+    return 0;
+}
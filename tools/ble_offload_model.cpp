@@ -0,0 +1,277 @@
+// Host model of the BLE bulk offload protocol (src/ble_offload.cpp).
+//
+//   g++ -std=gnu++14 -O2 -Iinclude tools/ble_offload_model.cpp src/ble_offload.cpp src/session_log.cpp src/energy.cpp -o ble_offload_model
+//   ./ble_offload_model [--records=N] [--disconnects=K] [--frame-loss=P] [--ack-loss=P] [--seeds=N]
+//
+// Replays a day of session records through the real sender over a link
+// simulated per connection event: the controller queue, air time per
+// event (same model as ble_link_capacity_bps), a central that ACKs every
+// half window, and random disconnects with resume. Disconnects come on
+// average K times per ideal transfer time of each link, so slow and fast
+// links see the same number; notifications and ACK writes are lost with
+// probabilities P, which only the ack timeout and go-back-N recover. Each
+// link runs with N seeds. Every record must arrive exactly once and in
+// order. The first table compares the old fixed 16-frame window with the
+// window sized from the link's bandwidth-delay product on a clean link.
+// Radio time is charged as the device charges ENERGY_RADIO: the air time
+// of every notification sent, lost ones included, and every ACK written.
+
+#include "ble_offload.h"
+#include "energy.h"
+#include "session_log.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <random>
+#include <vector>
+
+static uint32_t total_records = 28800;      // one day of 3 s windows
+static const uint8_t ACK_RTT_EVENTS = 2;    // OFFLOAD_ACK_RTT_EVENTS on the device
+
+static uint32_t model_first_seq() { return 0; }
+static uint32_t model_end_seq() { return total_records; }
+static size_t model_read(uint32_t seq, uint8_t *out, size_t max_records) {
+    if (seq >= total_records) return 0;
+    size_t n = total_records - seq < max_records ? total_records - seq : max_records;
+    for (size_t i = 0; i < n; i++) {
+        SessionRecord r{};
+        r.seq = seq + (uint32_t)i;
+        r.uptime_s = 3 * r.seq;
+        r.tremor = (uint8_t)(r.seq % 101);
+        session_record_encode(r, out + i * SESSION_RECORD_BYTES);
+    }
+    return n;
+}
+
+struct Scenario {
+    const char *name;
+    BleLinkParams link;
+};
+
+struct Impairments {
+    double disconnect_mean_s;               // 0 = never
+    double frame_loss;                      // per notification
+    double ack_loss;                        // per ACK write
+};
+
+struct Result {
+    double seconds;
+    uint32_t measured_bps;
+    uint32_t capacity_bps;
+    uint8_t window_frames;
+    uint32_t frames_lost;
+    uint32_t acks_lost;
+    uint64_t tx_us;                         // notification air time
+    uint64_t rx_us;                         // ACK write air time
+    OffloadStats stats;
+    bool verified;
+};
+
+// window_frames 0 = as ble_offload_set_link() sizes it
+static Result run(const BleLinkParams &link, uint8_t window_frames, const Impairments &imp, uint32_t seed) {
+    const size_t controller_queue = 8;       // notifications buffered below the host
+    const uint32_t reconnect_ms = 1500;
+
+    OffloadSender sender;
+    ble_offload_init(sender, OffloadSource{model_first_seq, model_end_seq, model_read, SESSION_RECORD_BYTES},
+                     ACK_RTT_EVENTS, 2000);
+    ble_offload_set_link(sender, link);
+    if (window_frames) sender.window_frames = window_frames;
+
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::exponential_distribution<double> next_drop(imp.disconnect_mean_s > 0 ? 1.0 / imp.disconnect_mean_s : 1.0);
+    double drop_at_s = imp.disconnect_mean_s > 0 ? next_drop(rng) : 1e30;
+    uint32_t frames_lost = 0, acks_lost = 0;
+    uint64_t tx_us = 0, rx_us = 0;
+
+    const uint32_t capacity = ble_link_capacity_bps(link, SESSION_RECORD_BYTES);
+    const uint16_t per_frame = ble_offload_records_per_frame(link, SESSION_RECORD_BYTES);
+    const double frames_per_event = (double)capacity / 8 / (per_frame * SESSION_RECORD_BYTES) *
+                                    link.conn_interval_us / 1e6;
+
+    std::deque<std::vector<uint8_t>> queue;
+    uint32_t expected = 0;                  // central: next record it needs
+    uint32_t frames_since_ack = 0;
+    bool pending_ack = false;
+    bool verified = true;
+    double credit = 0.0;
+    uint64_t now_us = 0;
+    uint64_t reconnect_at_us = 0;
+    bool connected = true;
+
+    ble_offload_start(sender, expected, 0);
+
+    while (!sender.stats.complete && now_us < 24ull * 3600 * 1000000) {
+        uint32_t now_ms = (uint32_t)(now_us / 1000);
+
+        if (!connected) {
+            if (now_us >= reconnect_at_us) {
+                connected = true;
+                ble_offload_start(sender, expected, now_ms);     // resume
+            }
+            now_us += link.conn_interval_us;
+            continue;
+        }
+        if (now_us / 1e6 >= drop_at_s) {
+            connected = false;
+            queue.clear();
+            pending_ack = false;
+            ble_offload_link_lost(sender, now_ms);
+            reconnect_at_us = now_us + reconnect_ms * 1000ull;
+            drop_at_s = reconnect_at_us / 1e6 + next_drop(rng);   // connected time between drops
+            continue;
+        }
+
+        // ACK written by the central in the previous event arrives now
+        if (pending_ack) {
+            rx_us += ble_att_air_us(link, OFFLOAD_CONTROL_BYTES);
+            if (uniform(rng) >= imp.ack_loss) ble_offload_ack(sender, expected, now_ms);
+            else acks_lost++;
+            pending_ack = false;
+        }
+        ble_offload_poll(sender, now_ms);
+
+        // Host fills the controller queue, and tops it up as each
+        // notification goes out (onDataSent() on the device)
+        auto fill_queue = [&]() {
+            uint8_t frame[256];
+            while (queue.size() < controller_queue) {
+                size_t n = ble_offload_frame(sender, frame, link.att_mtu - ATT_NOTIFY_HEADER);
+                if (n == 0) break;
+                queue.emplace_back(frame, frame + n);
+                ble_offload_frame_sent(sender, frame, now_ms);
+            }
+        };
+        fill_queue();
+
+        // Connection event: deliver what fits in air time
+        credit += frames_per_event;
+        while (credit >= 1.0 && !queue.empty()) {
+            credit -= 1.0;
+            std::vector<uint8_t> f = queue.front();
+            queue.pop_front();
+            fill_queue();
+            tx_us += ble_att_air_us(link, f.size());
+            if (uniform(rng) < imp.frame_loss) {
+                frames_lost++;                 // air time spent, nothing delivered
+                continue;
+            }
+
+            uint32_t first = f[0] | (f[1] << 8) | (f[2] << 16) | ((uint32_t)f[3] << 24);
+            uint32_t count = f[4];
+            for (uint32_t i = 0; i < count; i++) {
+                if (first + i != expected) continue;   // duplicate or gap: go-back-N resends
+                SessionRecord r;
+                session_record_decode(&f[OFFLOAD_FRAME_HEADER + i * SESSION_RECORD_BYTES], r);
+                if (r.seq != expected || r.tremor != expected % 101) verified = false;
+                expected++;
+            }
+            if (++frames_since_ack >= sender.window_frames / 2u || (f[5] & OFFLOAD_FRAME_LAST)) {
+                pending_ack = true;
+                frames_since_ack = 0;
+            }
+        }
+        if (queue.empty()) credit = 0.0;
+        now_us += link.conn_interval_us;
+    }
+
+    Result r;
+    r.seconds = now_us / 1e6;
+    r.stats = sender.stats;
+    r.measured_bps = ble_offload_throughput_bps(sender.stats);
+    r.capacity_bps = capacity;
+    r.window_frames = sender.window_frames;
+    r.frames_lost = frames_lost;
+    r.acks_lost = acks_lost;
+    r.tx_us = tx_us;
+    r.rx_us = rx_us;
+    r.verified = verified && expected == total_records;
+    return r;
+}
+
+static int arg_int(int argc, char **argv, const char *name, int fallback) {
+    size_t n = strlen(name);
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], name, n) == 0 && argv[i][n] == '=') return atoi(argv[i] + n + 1);
+    }
+    return fallback;
+}
+
+static double arg_double(int argc, char **argv, const char *name, double fallback) {
+    size_t n = strlen(name);
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], name, n) == 0 && argv[i][n] == '=') return atof(argv[i] + n + 1);
+    }
+    return fallback;
+}
+
+int main(int argc, char **argv) {
+    total_records = (uint32_t)arg_int(argc, argv, "--records", (int)total_records);
+    const double disconnects = arg_double(argc, argv, "--disconnects", 3.0);
+    const double frame_loss = arg_double(argc, argv, "--frame-loss", 0.002);
+    const double ack_loss = arg_double(argc, argv, "--ack-loss", 0.01);
+    const int seeds = arg_int(argc, argv, "--seeds", 8);
+
+    const Scenario scenarios[] = {
+        {"4.0 MTU23 1M 30ms",        {23, 27, false, 30000, 4}},
+        {"MTU247 no-DLE 1M 15ms",    {247, 27, false, 15000, 16}},
+        {"MTU247 DLE251 1M 15ms",    {247, 251, false, 15000, 16}},
+        {"MTU247 DLE251 2M 15ms",    {247, 251, true, 15000, 16}},
+        {"MTU247 DLE251 2M 7.5ms",   {247, 251, true, 7500, 16}},
+    };
+    const double payload_bits = total_records * (double)SESSION_RECORD_BYTES * 8;
+
+    printf("%u records (%u bytes), ACK round trip %u connection events\n\n",
+           total_records, total_records * (unsigned)SESSION_RECORD_BYTES, (unsigned)ACK_RTT_EVENTS);
+    printf("clean link: fixed 16-frame window against the bandwidth-delay window, radio charge "
+           "of the sized transfer\n");
+    printf("%-24s %12s %12s %7s %12s %9s %8s %9s\n", "link", "capacity", "16 frames", "window",
+           "measured", "transfer", "air", "radio mAh");
+    const EnergyModel model = energy_default_model();
+    bool all_ok = true;
+    for (const Scenario &s : scenarios) {
+        Result fixed = run(s.link, 16, Impairments{0, 0, 0}, 1);
+        Result sized = run(s.link, 0, Impairments{0, 0, 0}, 1);
+        uint64_t residency[ENERGY_COUNT] = {0};
+        residency[ENERGY_RADIO] = sized.tx_us + sized.rx_us;
+        EnergyReport e = energy_estimate(model, residency, (uint64_t)(sized.seconds * 1e6));
+        // Notification air time fits inside the connection events that carried it
+        all_ok = all_ok && sized.tx_us > 0 && sized.tx_us <= sized.seconds * 1e6;
+        printf("%-24s %7.1f kb/s %7.1f kb/s %7u %7.1f kb/s %8.1fs %7.1fs %9.4f\n", s.name,
+               sized.capacity_bps / 1000.0, fixed.measured_bps / 1000.0, (unsigned)sized.window_frames,
+               sized.measured_bps / 1000.0, sized.seconds, residency[ENERGY_RADIO] / 1e6, e.mah[ENERGY_RADIO]);
+    }
+
+    printf("\n%.1f disconnects per ideal transfer, %.2f%% notifications and %.2f%% ACKs lost, "
+           "%d seeds (per-seed means, worst sync)\n",
+           disconnects, 100.0 * frame_loss, 100.0 * ack_loss, seeds);
+    printf("%-24s %12s %9s %9s %8s %7s %8s %8s %8s %s\n", "link", "measured", "sync", "worst",
+           "lost", "retx", "resumes", "timeout", "ack lost", "check");
+    for (const Scenario &s : scenarios) {
+        const double ideal_s = payload_bits / ble_link_capacity_bps(s.link, SESSION_RECORD_BYTES);
+        const Impairments imp{disconnects > 0 ? ideal_s / disconnects : 0, frame_loss, ack_loss};
+        double bps = 0, seconds = 0, worst = 0, lost = 0, retx = 0, resumes = 0, timeouts = 0, acks = 0;
+        int ok = 0;
+        for (int seed = 1; seed <= seeds; seed++) {
+            Result r = run(s.link, 0, imp, (uint32_t)seed);
+            bps += r.measured_bps;
+            seconds += r.seconds;
+            worst = std::max(worst, r.seconds);
+            lost += r.frames_lost;
+            retx += r.stats.records_retransmitted;
+            resumes += r.stats.resumes;
+            timeouts += r.stats.timeouts;
+            acks += r.acks_lost;
+            ok += r.verified;
+        }
+        all_ok = all_ok && ok == seeds;
+        printf("%-24s %7.1f kb/s %8.1fs %8.1fs %8.1f %7.0f %8.1f %8.1f %8.1f %d/%d ok\n", s.name,
+               bps / seeds / 1000.0, seconds / seeds, worst, lost / seeds, retx / seeds,
+               resumes / seeds, timeouts / seeds, acks / seeds, ok, seeds);
+    }
+    return all_ok ? 0 : 1;
+}
@@ -0,0 +1,129 @@
+"""Tremor false positives with and without the gait-harmonic canceller.
+
+    python tools/canceller_report.py                        # builds both sims, 2 cycles
+    python tools/canceller_report.py --motion-scale=1 --motion-scale=3
+    python tools/canceller_report.py --on=PROGRAM --off=PROGRAM   # prebuilt sims
+    python tools/canceller_report.py --cadence=1.7 --cadence=2.3 --walk-harmonic=0.3
+
+Runs the host simulator twice over the same deterministic wearer, once as
+shipped (HARMONIC_CANCELLER=1) and once with the raw magnitude going into
+the tremor band (HARMONIC_CANCELLER=0), both with SESSION_LOG_STREAM=1 so
+every window's tremor intensity and flags reach the console. Windows are
+attributed to the scenario phase the simulated LSM6DSL was playing
+(sim/sim_lsm6dsl.cpp: 120 s each of rest, 4.5 Hz tremor, walking at 1.8
+steps/s, dyskinesia); windows that straddle a phase change are left out.
+A tremor flag during walking is a false positive; the tremor phase shows
+what the canceller costs true detections.
+
+The cadence sweep then replays the wearer walking at 1.6, 2.0 and 2.4
+steps/s with a strong vertical 2nd harmonic (--walk-hz, --walk-harmonic),
+which lands at 3.2, 4.0 and 4.8 Hz inside the tremor band. Each cadence must
+trip the detector without the canceller, and the canceller must remove at
+least --min-reduction of those false positives; otherwise the exit status
+is 1.
+"""
+
+import argparse
+import os
+import subprocess
+import sys
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+
+PHASE_S = 120
+PHASES = ["rest", "tremor", "walking", "dyskinesia"]
+WINDOW_S = 3
+SESSION_TREMOR = 0x01
+
+
+def build(canceller):
+    build_dir = os.path.join(ROOT, ".pio", "canceller_report", str(canceller))
+    env = dict(os.environ)
+    env["PLATFORMIO_BUILD_DIR"] = build_dir
+    env["PLATFORMIO_BUILD_FLAGS"] = "-DSESSION_LOG_STREAM=1 -DHARMONIC_CANCELLER=%d" % canceller
+    subprocess.check_call(["pio", "run", "-d", ROOT, "-e", "native_sim"], env=env)
+    return os.path.join(build_dir, "native_sim", "program")
+
+
+def windows(program, duration, motion_scale, walk=()):
+    out = subprocess.check_output([program, "--duration=%d" % duration, "--cpu-scale=0",
+                                   "--motion-scale=%g" % motion_scale] + list(walk)).decode()
+    by_phase = {name: [] for name in PHASES}
+    for line in out.splitlines():
+        if not line.startswith("SL "):
+            continue
+        uptime, tremor, _, flags, _ = line.split()[1:6]
+        end = int(uptime)
+        start = end - WINDOW_S
+        if start < 0 or start // PHASE_S != (end - 1) // PHASE_S:
+            continue
+        by_phase[PHASES[(start // PHASE_S) % len(PHASES)]].append(
+            (float(tremor), bool(int(flags, 16) & SESSION_TREMOR)))
+    if not any(by_phase.values()):
+        sys.exit("canceller_report: no SL lines from %s (built without SESSION_LOG_STREAM=1?)" % program)
+    return by_phase
+
+
+def summary(rows):
+    if not rows:
+        return "%6s %8s %8s %8s %6s" % ("-", "-", "-", "-", "-")
+    values = sorted(v for v, _ in rows)
+    p95 = values[int(0.95 * (len(values) - 1))]
+    flagged = sum(1 for _, f in rows if f)
+    return "%6d %7.2f%% %7.2f%% %7.2f%% %6d" % (len(rows), sum(values) / len(values), p95,
+                                                values[-1], flagged)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--duration", type=int, default=2 * len(PHASES) * PHASE_S,
+                        help="virtual seconds per run (default two scenario cycles)")
+    parser.add_argument("--motion-scale", type=float, action="append",
+                        help="wearer movement gain; repeat to sweep (default 1)")
+    parser.add_argument("--on", metavar="PROGRAM", help="prebuilt sim with the canceller")
+    parser.add_argument("--off", metavar="PROGRAM", help="prebuilt sim without it")
+    parser.add_argument("--cadence", type=float, action="append",
+                        help="walking steps/s for the sweep; repeat (default 1.6, 2.0, 2.4)")
+    parser.add_argument("--walk-harmonic", type=float, default=0.25,
+                        help="vertical 2nd-harmonic amplitude in g for the sweep (default 0.25)")
+    parser.add_argument("--min-reduction", type=float, default=0.8,
+                        help="share of walking false positives the canceller must remove")
+    args = parser.parse_args()
+
+    on = args.on or build(1)
+    off = args.off or build(0)
+    header = "%6s %8s %8s %8s %6s" % ("wins", "mean", "p95", "max", "T")
+    for scale in args.motion_scale or [1.0]:
+        with_c, without = windows(on, args.duration, scale), windows(off, args.duration, scale)
+        print("motion scale %g, %d s, tremor intensity per window" % (scale, args.duration))
+        print("%-11s | %-38s | %-38s" % ("phase", "canceller", "no canceller"))
+        print("%-11s | %-38s | %-38s" % ("", header, header))
+        for name in PHASES:
+            print("%-11s | %-38s | %-38s" % (name, summary(with_c[name]), summary(without[name])))
+        fp_on = sum(1 for _, f in with_c["walking"] if f)
+        fp_off = sum(1 for _, f in without["walking"] if f)
+        print("walking false positives: %d with, %d without (of %d windows)\n"
+              % (fp_on, fp_off, len(with_c["walking"])))
+
+    # Cadences whose 2nd harmonic falls in the tremor band
+    print("walking with a %.2f g 2nd harmonic, %d s, tremor flags while walking"
+          % (args.walk_harmonic, args.duration))
+    print("%-8s %-9s %6s %10s %10s %10s" % ("steps/s", "harmonic", "wins", "canceller",
+                                            "without", "reduction"))
+    ok = True
+    for cadence in args.cadence or [1.6, 2.0, 2.4]:
+        walk = ["--walk-hz=%g" % cadence, "--walk-harmonic=%g" % args.walk_harmonic]
+        fp_on = sum(1 for _, f in windows(on, args.duration, 1.0, walk)["walking"] if f)
+        walking = windows(off, args.duration, 1.0, walk)["walking"]
+        fp_off = sum(1 for _, f in walking if f)
+        reduction = 1.0 - float(fp_on) / fp_off if fp_off else 0.0
+        ok = ok and fp_off > 0 and reduction >= args.min_reduction
+        print("%-8g %6.1f Hz %6d %10d %10d %9.0f%%" % (cadence, 2 * cadence, len(walking),
+                                                      fp_on, fp_off, 100.0 * reduction))
+    print("check: %s (every cadence trips the detector without the canceller, "
+          "which removes >= %.0f%% of it)" % ("ok" if ok else "FAILED", 100.0 * args.min_reduction))
+    return 0 if ok else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,136 @@
+"""Compare the RTOS and bare-metal firmware builds.
+
+    python tools/footprint.py                    # build both, flash/RAM deltas
+    python tools/footprint.py --log disco_l475vg_iot01a=rtos.log \\
+                              --log disco_l475vg_iot01a_bare_metal=bare.log
+                                                 # plus boot time from console logs
+    python tools/footprint.py --sim              # host check: same output from both loops
+
+Flash is .text + .data and static RAM is .data + .bss, from
+arm-none-eabi-size on each environment's firmware.elf. Both builds keep
+the buffered UART console, the metered FileHandle console override and
+floating-point printf (energy accounting and the console format need
+them), so their share is listed per build from arm-none-eabi-nm symbol
+sizes to show what dropping each would save. Boot time comes
+from the firmware's "[BOOT]" line (main() entry and first FIFO batch, in
+µs since HAL init); capture one per build with `pio device monitor`
+after a reset. --sim runs native_sim and native_sim_bare_metal for the
+same deterministic virtual time and diffs their consoles.
+"""
+
+import argparse
+import difflib
+import os
+import re
+import subprocess
+import sys
+
+RTOS_ENV = "disco_l475vg_iot01a"
+BARE_ENV = "disco_l475vg_iot01a_bare_metal"
+SIM_ARGS = ["--duration=900", "--cpu-scale=0"]
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+
+
+def pio_run(envs):
+    cmd = ["pio", "run", "-d", ROOT]
+    for env in envs:
+        cmd += ["-e", env]
+    subprocess.check_call(cmd)
+
+
+def sections(env):
+    elf = os.path.join(ROOT, ".pio", "build", env, "firmware.elf")
+    out = subprocess.check_output(["arm-none-eabi-size", "-B", elf]).decode()
+    text, data, bss = (int(v) for v in out.splitlines()[1].split()[:3])
+    return {"flash": text + data, "ram": data + bss}
+
+
+# Console costs both builds keep, by symbol name (demangled)
+COMPONENTS = [
+    ("BufferedSerial", re.compile(r"mbed::BufferedSerial|mbed::SerialBase|\bserial_\w+|\buart_\w+")),
+    ("console FH", re.compile(r"MeteredConsole|mbed_override_console|mbed::FileHandle|mbed::FileBase"
+                              r"|mbed::mbed_file_handle|mbed::DirectSerial|\b_(write|read|open|close)\b")),
+    ("float printf", re.compile(r"minimal_formatted_string_double|__aeabi_d\w+|__aeabi_f2d"
+                                r"|__\w+df[23]\b|__\w+dsi\b|__\w+sidf\b")),
+]
+
+
+def components(env):
+    elf = os.path.join(ROOT, ".pio", "build", env, "firmware.elf")
+    out = subprocess.check_output(["arm-none-eabi-nm", "-C", "-S", "--size-sort", elf]).decode()
+    sizes = {name: {"flash": 0, "ram": 0} for name, _ in COMPONENTS}
+    for line in out.splitlines():
+        parts = line.split(None, 3)
+        if len(parts) < 4:
+            continue
+        size, kind, symbol = int(parts[1], 16), parts[2], parts[3]
+        for name, pattern in COMPONENTS:
+            if pattern.search(symbol):
+                sizes[name]["ram" if kind in "bBdD" else "flash"] += size
+                break
+    return sizes
+
+
+def boot_times(path):
+    for line in open(path, errors="replace"):
+        m = re.search(r"\[BOOT\] \S+ main\(\) at (\d+) us, first samples at (\d+) us", line)
+        if m:
+            return {"main_us": int(m.group(1)), "first_us": int(m.group(2))}
+    sys.exit("footprint: no [BOOT] line in %s" % path)
+
+
+def row(name, a, b, unit):
+    delta = b - a
+    pct = 100.0 * delta / a if a else 0.0
+    print("%-14s %10d %10d %+10d %s (%+.1f%%)" % (name, a, b, delta, unit, pct))
+
+
+def compare(logs):
+    pio_run([RTOS_ENV, BARE_ENV])
+    rtos, bare = sections(RTOS_ENV), sections(BARE_ENV)
+    print("%-14s %10s %10s %10s" % ("", "rtos", "bare-metal", "delta"))
+    row("flash", rtos["flash"], bare["flash"], "B")
+    row("static RAM", rtos["ram"], bare["ram"], "B")
+    rtos_parts, bare_parts = components(RTOS_ENV), components(BARE_ENV)
+    for name, _ in COMPONENTS:
+        row("  " + name, rtos_parts[name]["flash"], bare_parts[name]["flash"], "B flash")
+        row("  " + name, rtos_parts[name]["ram"], bare_parts[name]["ram"], "B RAM")
+    if RTOS_ENV in logs and BARE_ENV in logs:
+        a, b = boot_times(logs[RTOS_ENV]), boot_times(logs[BARE_ENV])
+        row("to main()", a["main_us"], b["main_us"], "us")
+        row("to 1st sample", a["first_us"], b["first_us"], "us")
+
+
+def sim_output(env):
+    program = os.path.join(ROOT, ".pio", "build", env, "program")
+    out = subprocess.check_output([program] + SIM_ARGS).decode()
+    # The boot line names the profile; everything else must match
+    return [re.sub(r"\[BOOT\] \S+", "[BOOT]", line) for line in out.splitlines()]
+
+
+def sim_check():
+    pio_run(["native_sim", "native_sim_bare_metal"])
+    rtos, bare = sim_output("native_sim"), sim_output("native_sim_bare_metal")
+    if rtos == bare:
+        print("footprint: identical output over %d lines" % len(rtos))
+        return
+    sys.stdout.writelines(line + "\n" for line in
+                          difflib.unified_diff(rtos, bare, "native_sim", "native_sim_bare_metal", lineterm="", n=1))
+    sys.exit(1)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--log", action="append", default=[], metavar="ENV=FILE",
+                        help="console log captured after a reset of that build")
+    parser.add_argument("--sim", action="store_true", help="host check of the event loops")
+    args = parser.parse_args()
+    if args.sim:
+        sim_check()
+    else:
+        compare(dict(item.split("=", 1) for item in args.log))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,189 @@
+"""Generate include/dpss_tapers.h: Slepian (DPSS) tapers for the multitaper
+spectral estimator, sized for the configured analysis window.
+
+Runs standalone (python tools/gen_dpss.py) or as a PlatformIO pre-build
+script (extra_scripts = pre:tools/gen_dpss.py). Window length, time-bandwidth
+product and taper count are read from include/parkinsons_system.h
+(BUFFER_SIZE, MULTITAPER_NW, MULTITAPER_TAPERS). Pure Python, no numpy.
+
+The tapers are the top eigenvectors of the symmetric tridiagonal matrix
+    diag[i]  = ((N - 1 - 2i) / 2)^2 * cos(2 pi W),   W = NW / N
+    off[i]   = (i + 1)(N - 1 - i) / 2
+found by Sturm-sequence bisection and inverse iteration.
+"""
+
+import math
+import os
+import re
+import sys
+
+
+def read_config(header_path):
+    text = open(header_path).read()
+
+    def define(name):
+        m = re.search(r"#define\s+%s\s+([0-9.]+)f?" % name, text)
+        if not m:
+            raise SystemExit("gen_dpss: %s not found in %s" % (name, header_path))
+        return m.group(1)
+
+    return int(define("BUFFER_SIZE")), float(define("MULTITAPER_NW")), int(define("MULTITAPER_TAPERS"))
+
+
+def tridiagonal(n, nw):
+    w = nw / n
+    c = math.cos(2.0 * math.pi * w)
+    diag = [((n - 1 - 2 * i) / 2.0) ** 2 * c for i in range(n)]
+    off = [(i + 1) * (n - 1 - i) / 2.0 for i in range(n - 1)]
+    return diag, off
+
+
+def count_below(diag, off, x):
+    """Number of eigenvalues smaller than x (Sturm sequence)."""
+    count = 0
+    q = diag[0] - x
+    if q < 0:
+        count += 1
+    for i in range(1, len(diag)):
+        if q == 0:
+            q = 1e-300
+        q = diag[i] - x - off[i - 1] ** 2 / q
+        if q < 0:
+            count += 1
+    return count
+
+
+def kth_largest_eigenvalue(diag, off, k):
+    n = len(diag)
+    radius = [abs(off[i - 1]) if i > 0 else 0.0 for i in range(n)]
+    for i in range(n - 1):
+        radius[i] += abs(off[i])
+    lo = min(d - r for d, r in zip(diag, radius))
+    hi = max(d + r for d, r in zip(diag, radius))
+    target = n - 1 - k  # index from the bottom
+    for _ in range(200):
+        mid = 0.5 * (lo + hi)
+        if count_below(diag, off, mid) > target:
+            hi = mid
+        else:
+            lo = mid
+    return 0.5 * (lo + hi)
+
+
+def lu_factor(diag, off, shift):
+    """Dense LU with partial pivoting of (T - shift I); N is small."""
+    n = len(diag)
+    a = [[0.0] * n for _ in range(n)]
+    for i in range(n):
+        a[i][i] = diag[i] - shift
+        if i < n - 1:
+            a[i][i + 1] = off[i]
+            a[i + 1][i] = off[i]
+    perm = list(range(n))
+    for col in range(n):
+        pivot = max(range(col, n), key=lambda r: abs(a[r][col]))
+        if pivot != col:
+            a[col], a[pivot] = a[pivot], a[col]
+            perm[col], perm[pivot] = perm[pivot], perm[col]
+        if a[col][col] == 0.0:
+            a[col][col] = 1e-300
+        inv = 1.0 / a[col][col]
+        for r in range(col + 1, n):
+            if a[r][col] != 0.0:
+                f = a[r][col] * inv
+                a[r][col] = f
+                row_r = a[r]
+                row_c = a[col]
+                for c in range(col + 1, n):
+                    row_r[c] -= f * row_c[c]
+    return a, perm
+
+
+def lu_solve(lu, rhs):
+    a, perm = lu
+    n = len(a)
+    y = [rhs[perm[i]] for i in range(n)]
+    for i in range(n):
+        s = y[i]
+        row = a[i]
+        for c in range(i):
+            s -= row[c] * y[c]
+        y[i] = s
+    for i in range(n - 1, -1, -1):
+        s = y[i]
+        row = a[i]
+        for c in range(i + 1, n):
+            s -= row[c] * y[c]
+        y[i] = s / row[i]
+    return y
+
+
+def dpss(n, nw, k):
+    diag, off = tridiagonal(n, nw)
+    tapers = []
+    for order in range(k):
+        lam = kth_largest_eigenvalue(diag, off, order)
+        lu = lu_factor(diag, off, lam + 1e-9 * max(1.0, abs(lam)))
+        v = [1.0 / math.sqrt(n) + 1e-3 * math.sin(i + order) for i in range(n)]
+        for _ in range(4):
+            v = lu_solve(lu, v)
+            norm = math.sqrt(sum(x * x for x in v))
+            v = [x / norm for x in v]
+        # Orthogonalize against lower orders (guards near-degenerate pairs)
+        for t in tapers:
+            dot = sum(a * b for a, b in zip(v, t))
+            v = [a - dot * b for a, b in zip(v, t)]
+        norm = math.sqrt(sum(x * x for x in v))
+        v = [x / norm for x in v]
+        # Standard sign convention: symmetric tapers positive in the middle,
+        # antisymmetric tapers start positive
+        if order % 2 == 0:
+            if sum(v) < 0:
+                v = [-x for x in v]
+        else:
+            first = next((x for x in v if abs(x) > 1e-9), 1.0)
+            if first < 0:
+                v = [-x for x in v]
+        tapers.append(v)
+    return tapers
+
+
+def render(n, nw, k, tapers):
+    lines = [
+        "#pragma once",
+        "// Generated by tools/gen_dpss.py - do not edit.",
+        "// DPSS (Slepian) tapers, N = %d, NW = %g, K = %d, unit energy." % (n, nw, k),
+        "",
+        "#define DPSS_N     %d" % n,
+        "#define DPSS_K     %d" % k,
+        "",
+        "static const float DPSS_TAPERS[DPSS_K][DPSS_N] = {",
+    ]
+    for v in tapers:
+        lines.append("    {")
+        for i in range(0, n, 6):
+            chunk = ", ".join("%.8ef" % x for x in v[i:i + 6])
+            lines.append("        %s," % chunk)
+        lines.append("    },")
+    lines.append("};")
+    return "\n".join(lines) + "\n"
+
+
+def generate(project_dir):
+    header = os.path.join(project_dir, "include", "parkinsons_system.h")
+    out = os.path.join(project_dir, "include", "dpss_tapers.h")
+    n, nw, k = read_config(header)
+    text = render(n, nw, k, dpss(n, nw, k))
+    if os.path.exists(out) and open(out).read() == text:
+        return
+    with open(out, "w") as f:
+        f.write(text)
+    print("gen_dpss: wrote %s (N=%d NW=%g K=%d)" % (out, n, nw, k))
+
+
+try:
+    Import("env")  # noqa: F821 - provided by PlatformIO/SCons
+    generate(env.subst("$PROJECT_DIR"))  # noqa: F821
+except NameError:
+    if __name__ == "__main__":
+        generate(os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
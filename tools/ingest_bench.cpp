@@ -0,0 +1,312 @@
+// Load generator and benchmark for the gateway UDP ingest path.
+//
+//   g++ -std=gnu++14 -O2 -pthread -Iinclude tools/ingest_bench.cpp src/gateway/ingest.cpp src/gateway/reorder.cpp src/load_shed.cpp src/timer_wheel.cpp src/detect_core.cpp src/harmonic_canceller.cpp src/activity.cpp src/baseline.cpp src/spectral_backend.cpp src/spectral_kernels.cpp -o ingest_bench
+//   ./ingest_bench [--workers=N] [--senders=N] [--streams=N] [--seconds=S] [--reuseport]
+//                  [--detect]
+//
+// Senders push 26-sample batches (one FIFO watermark of the device) for
+// `streams` simulated wearers at loopback with sendmmsg(). For each receive
+// batch size the workers' throughput is reported as datagrams per second of
+// wall time and per second of worker CPU time (packets/sec/core).
+// With --detect every closed window runs detect_stream_window() for its
+// stream at the tier the worker's load shedding picks, and each batch size
+// runs twice: with shedding disabled and with the default controller.
+// shed% is the share of windows analysed below TIER_FULL and us/win the
+// mean analysis time per window. A run that shed must have cut us/win
+// below the unshed run's, or the bench fails.
+// Workers run their per-stream hop and stall timers on the steady clock.
+// Senders compress time, so every window closes well inside its hop
+// deadline unless analysis falls behind; once they stop, workers keep
+// polling past SENSOR_STALL_MS and every stream must stall exactly once.
+
+#include "detect_core.h"
+#include "gateway/ingest.h"
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+static const uint16_t BENCH_PORT = 47500;
+static const uint16_t BATCH_SAMPLES = 26;
+static const unsigned SEND_BATCH = 32;
+
+static volatile float sink;
+
+static double thread_cpu_seconds() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void sender(std::atomic<bool> *stop, std::atomic<uint64_t> *sent_total, uint16_t port,
+                   uint32_t first_stream, uint32_t streams) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in dst = {};
+    dst.sin_family = AF_INET;
+    dst.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    dst.sin_port = htons(port);
+    // Distinct source ports per sender let SO_REUSEPORT spread the load
+    connect(fd, (sockaddr *)&dst, sizeof(dst));
+
+    std::vector<uint32_t> seq(streams, 0);
+    int16_t xyz[BATCH_SAMPLES][3];
+
+    std::vector<uint8_t> buffers(SEND_BATCH * INGEST_MAX_DATAGRAM);
+    mmsghdr msgs[SEND_BATCH];
+    iovec iov[SEND_BATCH];
+    uint32_t next_stream = 0;
+    while (!stop->load(std::memory_order_relaxed)) {
+        for (unsigned i = 0; i < SEND_BATCH; i++) {
+            uint32_t s = next_stream;
+            next_stream = next_stream + 1 == streams ? 0 : next_stream + 1;
+            // 0.1 g of 4.5 Hz tremor on 1 g of gravity, phase per stream
+            for (unsigned k = 0; k < BATCH_SAMPLES; k++) {
+                float t = (seq[s] + k) / 52.0f + 0.1f * (first_stream + s);
+                float tremor = 1640.0f * sinf(2.0f * 3.14159265f * 4.5f * t);
+                xyz[k][0] = (int16_t)(0.4f * tremor);
+                xyz[k][1] = (int16_t)(0.2f * tremor);
+                xyz[k][2] = (int16_t)(16384 + tremor);
+            }
+            uint8_t *buf = &buffers[i * INGEST_MAX_DATAGRAM];
+            size_t len = ingest_encode_samples(buf, INGEST_MAX_DATAGRAM, first_stream + s,
+                                               seq[s], xyz, BATCH_SAMPLES, 0);
+            seq[s] += BATCH_SAMPLES;
+            iov[i].iov_base = buf;
+            iov[i].iov_len = len;
+            memset(&msgs[i], 0, sizeof(mmsghdr));
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        int sent = sendmmsg(fd, msgs, SEND_BATCH, 0);
+        if (sent > 0) sent_total->fetch_add(sent, std::memory_order_relaxed);
+    }
+    close(fd);
+}
+
+struct WorkerResult {
+    uint64_t datagrams;
+    uint64_t syscalls;
+    double cpu_seconds;
+    uint32_t windows;
+    uint32_t windows_shed;
+    uint64_t streams;
+    uint64_t stalls;
+    uint64_t hop_misses;
+    double analysis_ns;
+};
+
+// Per-worker detection state, touched only by that worker's thread
+struct Analysis {
+    std::unordered_map<uint32_t, std::unique_ptr<DetectStream>> streams;
+    double ns;
+    uint64_t windows;
+};
+
+static void analyse_window(void *context, const ReorderView &view, AnalysisTier tier) {
+    Analysis &analysis = *(Analysis *)context;
+    std::unique_ptr<DetectStream> &stream = analysis.streams[view.stream_id];
+    if (!stream) {
+        stream.reset(new DetectStream);
+        detect_stream_init(*stream);
+    }
+    float xyz[WINDOW_SAMPLES * 3];
+    for (uint32_t i = 0; i < view.size && i < WINDOW_SAMPLES; i++) {
+        xyz[i * 3] = view.accel_x[i];
+        xyz[i * 3 + 1] = view.accel_y[i];
+        xyz[i * 3 + 2] = view.accel_z[i];
+    }
+    auto t0 = std::chrono::steady_clock::now();
+    sink = detect_stream_window(*stream, xyz, tier).tremor_intensity;
+    analysis.ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+    analysis.windows++;
+}
+
+static void worker_loop(IngestWorker *worker, std::atomic<bool> *stop, WorkerResult *result) {
+    double cpu0 = thread_cpu_seconds();
+    while (!stop->load(std::memory_order_relaxed)) {
+        ingest_poll(*worker, 10);
+    }
+    result->cpu_seconds = thread_cpu_seconds() - cpu0;
+    result->datagrams = worker->stats.datagrams;
+    result->syscalls = worker->stats.syscalls;
+    result->windows = worker->load_shed.windows_total;
+    result->windows_shed = worker->load_shed.windows_shed;
+    result->streams = worker->streams.size();
+    result->stalls = worker->stats.stalls;
+    result->hop_misses = worker->stats.hop_misses;
+    if (worker->on_window) result->analysis_ns = ((Analysis *)worker->window_context)->ns;
+}
+
+static int arg_int(int argc, char **argv, const char *name, int fallback) {
+    size_t n = strlen(name);
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], name, n) == 0 && argv[i][n] == '=') return atoi(argv[i] + n + 1);
+    }
+    return fallback;
+}
+
+static bool arg_flag(int argc, char **argv, const char *name) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], name) == 0) return true;
+    }
+    return false;
+}
+
+struct BenchOptions {
+    int workers;
+    int senders;
+    int streams;
+    int seconds;
+    bool reuseport;
+    bool detect;
+};
+
+struct Row {
+    double dgram_per_s;
+    double dgram_per_cpu_s;
+    double dgram_per_call;
+    double lost_percent;
+    uint64_t windows;
+    uint64_t shed;
+    double analysis_ns;
+    uint64_t streams_seen;
+    uint64_t stalls;
+    uint64_t hop_misses;
+};
+
+// One load run at a receive batch size; shedding off pins every window to
+// TIER_FULL
+static bool run(const BenchOptions &o, uint16_t port, unsigned batch, bool shedding, Row &row) {
+    std::vector<IngestWorker> pool(o.workers);
+    std::vector<Analysis> analysis(o.workers);
+    IngestConfig config = ingest_default_config(port);
+    config.batch = batch;
+    config.reuseport = o.reuseport;
+    config.send_acks = false;
+    if (!shedding) config.load_shed = LoadShedConfig{UINT32_MAX, UINT32_MAX, 0, 10};
+    for (int i = 0; i < o.workers; i++) {
+        IngestWorker &w = pool[i];
+        w.fd = -1;
+        if (!ingest_open(w, config)) {
+            perror("ingest_open");
+            return false;
+        }
+        if (o.detect) {
+            w.on_window = analyse_window;
+            w.window_context = &analysis[i];
+        }
+    }
+
+    std::atomic<bool> stop_workers(false), stop_senders(false);
+    std::atomic<uint64_t> sent(0);
+    std::vector<WorkerResult> results(o.workers);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < o.workers; i++) {
+        threads.emplace_back(worker_loop, &pool[i], &stop_workers, &results[i]);
+    }
+    std::vector<std::thread> load;
+    uint32_t per_sender = (uint32_t)((o.streams + o.senders - 1) / o.senders);
+    for (int i = 0; i < o.senders; i++) {
+        load.emplace_back(sender, &stop_senders, &sent, port, i * per_sender, per_sender);
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::seconds(o.seconds));
+    stop_senders = true;
+    for (auto &t : load) t.join();
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    // Idle workers: only the timers run, and every stream goes stale
+    std::this_thread::sleep_for(std::chrono::milliseconds(SENSOR_STALL_MS + 200));
+    stop_workers = true;
+    for (auto &t : threads) t.join();
+
+    row = Row{};
+    uint64_t datagrams = 0, syscalls = 0;
+    double cpu = 0.0;
+    for (auto &r : results) {
+        datagrams += r.datagrams;
+        syscalls += r.syscalls;
+        cpu += r.cpu_seconds;
+        row.windows += r.windows;
+        row.shed += r.windows_shed;
+        row.analysis_ns += r.analysis_ns;
+        row.streams_seen += r.streams;
+        row.stalls += r.stalls;
+        row.hop_misses += r.hop_misses;
+    }
+    uint64_t offered = sent.load();
+    row.dgram_per_s = datagrams / wall;
+    row.dgram_per_cpu_s = cpu > 0.0 ? datagrams / cpu : 0.0;
+    row.dgram_per_call = syscalls ? (double)datagrams / syscalls : 0.0;
+    row.lost_percent = offered > datagrams ? 100.0 * (offered - datagrams) / (double)offered : 0.0;
+    for (auto &w : pool) ingest_close(w);
+    return true;
+}
+
+static void print_row(const char *label, unsigned batch, const Row &row) {
+    char stalls[32];
+    snprintf(stalls, sizeof(stalls), "%llu/%llu", (unsigned long long)row.stalls,
+             (unsigned long long)row.streams_seen);
+    printf("%-5s %6u %12.0f %12.0f %14.0f %10.1f %7.1f%% %9llu %6.1f%% %8.2f %11s %10llu\n",
+           label, batch, row.dgram_per_s, row.dgram_per_s * BATCH_SAMPLES, row.dgram_per_cpu_s,
+           row.dgram_per_call, row.lost_percent, (unsigned long long)row.windows,
+           row.windows ? 100.0 * row.shed / row.windows : 0.0,
+           row.windows ? row.analysis_ns / row.windows / 1000.0 : 0.0, stalls,
+           (unsigned long long)row.hop_misses);
+}
+
+int main(int argc, char **argv) {
+    BenchOptions o;
+    o.workers = arg_int(argc, argv, "--workers", 1);
+    o.senders = arg_int(argc, argv, "--senders", 1);
+    o.streams = arg_int(argc, argv, "--streams", 256);
+    o.seconds = arg_int(argc, argv, "--seconds", 2);
+    o.detect = arg_flag(argc, argv, "--detect");
+    o.reuseport = arg_flag(argc, argv, "--reuseport") || o.workers > 1;
+
+    printf("workers=%d senders=%d streams=%d reuseport=%d cpus=%u detect=%d\n", o.workers,
+           o.senders, o.streams, o.reuseport ? 1 : 0, std::thread::hardware_concurrency(),
+           o.detect ? 1 : 0);
+    printf("%-5s %6s %12s %12s %14s %10s %8s %9s %7s %8s %11s %10s\n", "shed", "batch", "dgram/s",
+           "samples/s", "dgram/s/core", "dgram/call", "lost%", "windows", "shed%", "us/win",
+           "stalls", "hop misses");
+
+    bool stalls_ok = true, shed_ok = true, shed_any = false;
+    uint16_t port = BENCH_PORT;
+    for (unsigned batch : {1u, 8u, 32u, 64u}) {
+        Row unshed = {}, row;
+        if (o.detect) {
+            if (!run(o, ++port, batch, false, unshed)) return 1;
+            print_row("off", batch, unshed);
+            stalls_ok = stalls_ok && unshed.stalls == unshed.streams_seen;
+        }
+        if (!run(o, ++port, batch, true, row)) return 1;
+        print_row(o.detect ? "on" : "-", batch, row);
+        stalls_ok = stalls_ok && row.stalls == row.streams_seen;
+        if (o.detect && row.shed > 0 && row.windows > 0 && unshed.windows > 0) {
+            shed_any = true;
+            shed_ok = shed_ok &&
+                      row.analysis_ns / row.windows < unshed.analysis_ns / unshed.windows;
+        }
+    }
+    printf("check: %s\n", stalls_ok ? "every stream stalled once after the senders stopped"
+                                    : "STALL COUNT differs from the streams seen");
+    if (o.detect) {
+        printf("check: %s\n", !shed_any ? "no run was overloaded enough to shed"
+                              : shed_ok ? "every run that shed cut its analysis time per window"
+                                        : "A RUN SHED WITHOUT CUTTING its analysis time per window");
+    }
+    return stalls_ok && shed_ok ? 0 : 1;
+}
@@ -0,0 +1,42 @@
+"""PlatformIO pre-build script: build an environment against another
+mbed_app.json.
+
+The mbed builder only reads mbed_app.json from the project root, and the
+bare-metal profile cannot share that file with the RTOS build (mbed
+rejects overrides such as rtos.main-thread-stack-size for libraries the
+profile leaves out). An environment that sets
+
+    custom_mbed_app = mbed_app_bare_metal.json
+    extra_scripts = pre:tools/mbed_profile.py
+
+gets that file in place of mbed_app.json while its build runs; the
+original is put back when the build exits. Every firmware environment runs
+this script, so after a killed build the next one, whatever its profile,
+restores mbed_app.json before the builder reads it.
+"""
+
+import atexit
+import os
+import shutil
+
+SAVED = "mbed_app.json.saved"
+
+
+def restore(root):
+    saved = os.path.join(root, SAVED)
+    if os.path.exists(saved):
+        shutil.move(saved, os.path.join(root, "mbed_app.json"))
+
+
+def select(root, name):
+    restore(root)
+    if not name:
+        return
+    shutil.copyfile(os.path.join(root, "mbed_app.json"), os.path.join(root, SAVED))
+    atexit.register(restore, root)
+    shutil.copyfile(os.path.join(root, name), os.path.join(root, "mbed_app.json"))
+    print("mbed_profile: using %s" % name)
+
+
+Import("env")  # noqa: F821 - provided by PlatformIO/SCons
+select(env.subst("$PROJECT_DIR"), env.GetProjectOption("custom_mbed_app", ""))  # noqa: F821
@@ -0,0 +1,190 @@
+// Overhead and correctness check of the gateway reorder/dedup buffer.
+//
+//   g++ -std=gnu++14 -O2 -Iinclude tools/reorder_bench.cpp src/gateway/reorder.cpp -o reorder_bench
+//   ./reorder_bench [--streams=N] [--minutes=M]
+//
+// Each stream plays a wearer who disconnects, then reconnects and backfills
+// the stored batches while live batches keep arriving. Backfill overlaps
+// what was already delivered and is shuffled within a bounded horizon. The
+// final revision of every emitted window must match the in-order
+// reference. The accelerometer range steps every 100 s of capture time, so
+// backfilled batches carry a different range tag than the live batches
+// around them. Reports memory per stream and ns per sample against an
+// in-order ring (what the ingest path did before reordering).
+
+#include "gateway/reorder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+static const uint32_t BATCH = 26;
+static const float LSB_TO_G = 0.061f / 1000.0f;
+static const uint32_t RANGE_PERIOD = 52 * 100;   // samples per range step, a BATCH multiple
+
+static unsigned range_of(size_t seq) {
+    return (unsigned)(seq / RANGE_PERIOD % 3);
+}
+
+struct Batch {
+    uint32_t first_seq;
+    uint32_t count;
+};
+
+struct Check {
+    const std::vector<int16_t> *truth;
+    std::vector<int64_t> last_revision;
+    std::vector<uint32_t> last_present;
+    uint64_t mismatches;
+    uint64_t emits;
+};
+
+static void on_window(void *context, const ReorderView &view) {
+    Check *c = (Check *)context;
+    c->emits++;
+    if (view.window < 0 || (size_t)view.window >= c->last_revision.size()) return;
+    c->last_revision[view.window] = view.revision;
+    c->last_present[view.window] = view.present;
+    // Windows with every sample present must equal the reference exactly
+    if (view.present != view.size) return;
+    for (uint32_t i = 0; i < view.size; i++) {
+        size_t seq = (size_t)view.window * view.size + i;
+        if (seq * 3 >= c->truth->size()) break;
+        if (view.accel_x[i] != (*c->truth)[seq * 3] * (LSB_TO_G * (float)(1u << range_of(seq)))) {
+            c->mismatches++;
+            return;
+        }
+    }
+}
+
+static void encode(const std::vector<int16_t> &truth, const Batch &b, std::vector<uint8_t> &out) {
+    out.resize(b.count * 6);
+    for (uint32_t i = 0; i < b.count * 3; i++) {
+        uint16_t v = (uint16_t)truth[(size_t)b.first_seq * 3 + i];
+        out[i * 2] = (uint8_t)v;
+        out[i * 2 + 1] = (uint8_t)(v >> 8);
+    }
+}
+
+// Arrival order: live batches, a 60 s outage, then backfill of the outage
+// (plus a 10 s overlap already delivered) interleaved with live batches.
+// Backfill is shuffled in groups so it stays within REORDER_BACKFILL_HORIZON_S.
+static std::vector<Batch> arrival_order(uint32_t total, std::mt19937 &rng) {
+    std::vector<Batch> order;
+    const uint32_t outage_start = total / 3, outage_len = 52 * 60, overlap = 52 * 10;
+    std::vector<Batch> backfill;
+    for (uint32_t seq = outage_start - overlap; seq < outage_start + outage_len; seq += BATCH) {
+        backfill.push_back({seq, BATCH});
+    }
+    for (size_t g = 0; g < backfill.size(); g += 12) {
+        std::shuffle(backfill.begin() + g, backfill.begin() + std::min(backfill.size(), g + 12), rng);
+    }
+    size_t next_backfill = 0;
+    for (uint32_t seq = 0; seq + BATCH <= total; seq += BATCH) {
+        if (seq >= outage_start && seq < outage_start + outage_len) continue;
+        order.push_back({seq, BATCH});
+        // The relay replays stored batches three per live batch
+        for (int k = 0; k < 3 && seq >= outage_start + outage_len && next_backfill < backfill.size(); k++) {
+            order.push_back(backfill[next_backfill++]);
+        }
+    }
+    return order;
+}
+
+static int arg_int(int argc, char **argv, const char *name, int fallback) {
+    size_t n = strlen(name);
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], name, n) == 0 && argv[i][n] == '=') return atoi(argv[i] + n + 1);
+    }
+    return fallback;
+}
+
+int main(int argc, char **argv) {
+    const int streams = arg_int(argc, argv, "--streams", 64);
+    const int minutes = arg_int(argc, argv, "--minutes", 20);
+    const uint32_t total = (uint32_t)minutes * 60 * 52 / BATCH * BATCH;
+
+    std::mt19937 rng(1234);
+    std::vector<int16_t> truth((size_t)total * 3);
+    for (auto &v : truth) v = (int16_t)(rng() & 0xFFFF);
+
+    // The shipped default: retention sized from REORDER_BACKFILL_HORIZON_S
+    ReorderConfig config = reorder_default_config();
+    const uint32_t windows = total / config.window_samples + 1;
+
+    std::vector<Batch> order = arrival_order(total, rng);
+    std::vector<std::vector<uint8_t>> wire(order.size());
+    for (size_t i = 0; i < order.size(); i++) encode(truth, order[i], wire[i]);
+
+    std::vector<ReorderBuffer> buffers(streams);
+    std::vector<Check> checks(streams);
+    for (int s = 0; s < streams; s++) {
+        reorder_init(buffers[s], config, (uint32_t)s);
+        checks[s] = Check{&truth, std::vector<int64_t>(windows, -1),
+                          std::vector<uint32_t>(windows, 0), 0, 0};
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < order.size(); i++) {
+        for (int s = 0; s < streams; s++) {
+            reorder_insert(buffers[s], order[i].first_seq, wire[i].data(), order[i].count,
+                           range_of(order[i].first_seq), LSB_TO_G, on_window, &checks[s]);
+        }
+    }
+    for (int s = 0; s < streams; s++) reorder_flush(buffers[s], on_window, &checks[s]);
+    double reorder_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    // Baseline: the same datagrams appended to a plain ring in arrival order
+    std::vector<float> ring(4 * config.window_samples);
+    uint32_t index = 0;
+    t0 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < order.size(); i++) {
+        for (int s = 0; s < streams; s++) {
+            const uint8_t *p = wire[i].data();
+            for (uint32_t k = 0; k < order[i].count; k++, p += 6) {
+                float x = (int16_t)(p[0] | (p[1] << 8)) * LSB_TO_G;
+                float y = (int16_t)(p[2] | (p[3] << 8)) * LSB_TO_G;
+                float z = (int16_t)(p[4] | (p[5] << 8)) * LSB_TO_G;
+                ring[index] = x;
+                ring[config.window_samples + index] = y;
+                ring[2 * config.window_samples + index] = z;
+                ring[3 * config.window_samples + index] = sqrtf(x * x + y * y + z * z);
+                index = index + 1 == config.window_samples ? 0 : index + 1;
+            }
+        }
+    }
+    double ring_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    uint64_t delivered = 0;
+    for (auto &b : order) delivered += b.count;
+    const ReorderStats &st = buffers[0].stats;
+    uint64_t incomplete = 0, missing = 0, mismatches = 0;
+    for (int s = 0; s < streams; s++) {
+        mismatches += checks[s].mismatches;
+        for (uint32_t w = 0; w + 1 < windows; w++) {
+            if (checks[s].last_revision[w] < 0) missing++;
+            else if (checks[s].last_present[w] != config.window_samples) incomplete++;
+        }
+    }
+
+    printf("streams=%d minutes=%d window=%u retain=%u lateness=%u\n", streams, minutes,
+           config.window_samples, config.retain_windows, config.lateness_samples);
+    printf("per stream: %u windows, %llu samples delivered, %llu accepted, %llu duplicates, "
+           "%llu too late, %llu late accepted\n",
+           windows - 1, (unsigned long long)delivered, (unsigned long long)st.accepted,
+           (unsigned long long)st.duplicates, (unsigned long long)st.too_late,
+           (unsigned long long)st.late_accepted);
+    printf("per stream: %llu windows emitted, %llu re-analysed (%.1f%% of windows)\n",
+           (unsigned long long)st.windows_emitted, (unsigned long long)st.revisions_emitted,
+           100.0 * st.revisions_emitted / (double)st.windows_emitted);
+    printf("memory: %zu bytes per stream\n", reorder_memory_bytes(buffers[0]));
+    printf("cpu: reorder %.1f ns/sample, in-order ring %.1f ns/sample\n",
+           reorder_s * 1e9 / (delivered * (double)streams), ring_s * 1e9 / (delivered * (double)streams));
+    printf("check: %llu mismatched, %llu never emitted, %llu incomplete windows\n",
+           (unsigned long long)mismatches, (unsigned long long)missing, (unsigned long long)incomplete);
+    return (mismatches || missing || incomplete) ? 1 : 0;
+}
@@ -0,0 +1,191 @@
+// Update/query cost and correctness check of the gateway rollups.
+//
+//   g++ -std=gnu++14 -O2 -Iinclude tools/rollup_bench.cpp src/gateway/rollup.cpp -o rollup_bench
+//   ./rollup_bench [--patients=N] [--days=D]
+//
+// Each patient wears the device 12 h a day. Results arrive mostly in
+// order, with 2% of windows revised up to 5 minutes later, and one hour a
+// day is backfilled shuffled in 6-minute batches, so some revisions
+// overtake the original. Every day and week is then compared with a full
+// recomputation from the final results, and a result far beyond the
+// correction horizon must leave them untouched.
+
+#include "gateway/rollup.h"
+#include "session_log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+static const int64_t EPOCH = 1767225600;      // 2026-01-01 00:00 UTC (Thursday)
+static const int64_t WEAR_WINDOWS = 12 * 3600 / ROLLUP_WINDOW_S;
+
+static volatile uint32_t sink;
+
+static int arg_int(int argc, char **argv, const char *name, int fallback) {
+    size_t n = strlen(name);
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], name, n) == 0 && argv[i][n] == '=') return atoi(argv[i] + n + 1);
+    }
+    return fallback;
+}
+
+// Patient window w lies on day w / WEAR_WINDOWS, starting 08:00 local
+static int64_t window_start(int64_t w) {
+    return EPOCH + (w / WEAR_WINDOWS) * 86400 + 8 * 3600 + (w % WEAR_WINDOWS) * ROLLUP_WINDOW_S;
+}
+
+static uint8_t random_flags(std::mt19937 &rng, bool prev_fog) {
+    uint8_t f = 0;
+    if (rng() % 100 < 8) f |= SESSION_TREMOR;
+    if (rng() % 100 < 3) f |= SESSION_DYSKINESIA;
+    // FoG comes in runs of a few windows, a handful per day
+    if (rng() % 10000 < (prev_fog ? 6000u : 5u)) f |= SESSION_FREEZING;
+    return f;
+}
+
+int main(int argc, char **argv) {
+    const int patients = arg_int(argc, argv, "--patients", 20);
+    const int days = arg_int(argc, argv, "--days", 56);
+    const int64_t windows = (int64_t)days * WEAR_WINDOWS;
+
+    std::mt19937 rng(42);
+    RollupStore store;
+    rollup_init(store);
+
+    std::vector<std::vector<uint8_t>> truth(patients, std::vector<uint8_t>(windows));
+    uint64_t updates = 0;
+    double update_s = 0.0;
+
+    for (int p = 0; p < patients; p++) {
+        std::vector<RollupWindow> order;
+        order.reserve(windows + windows / 20);
+        bool prev_fog = false;
+        for (int64_t w = 0; w < windows; w++) {
+            uint8_t f = random_flags(rng, prev_fog);
+            prev_fog = (f & SESSION_FREEZING) != 0;
+            truth[p][w] = f;
+            order.push_back({(uint32_t)p, w, window_start(w), 1, f});
+        }
+        // Revisions: 2% of windows first arrive with other flags and are
+        // corrected up to 100 windows later (inside the recent ring)
+        std::vector<RollupWindow> arrivals;
+        arrivals.reserve(order.size() * 11 / 10);
+        std::vector<std::pair<int64_t, RollupWindow>> pending;
+        for (auto &r : order) {
+            if (rng() % 100 < 2) {
+                RollupWindow wrong = r;
+                wrong.flags = (uint8_t)(rng() & 0x07);
+                wrong.revision = 0;
+                arrivals.push_back(wrong);
+                pending.push_back({r.window + 1 + rng() % 100, r});
+            } else {
+                arrivals.push_back(r);
+            }
+            for (size_t i = 0; i < pending.size();) {
+                if (pending[i].first <= r.window) {
+                    arrivals.push_back(pending[i].second);
+                    pending[i] = pending.back();
+                    pending.pop_back();
+                } else {
+                    i++;
+                }
+            }
+        }
+        for (auto &pr : pending) arrivals.push_back(pr.second);
+        // Backfill: one hour per day arrives shuffled in 6-minute batches,
+        // keeping every revision within ROLLUP_RECENT_WINDOWS of its original
+        for (int d = 0; d < days; d++) {
+            size_t begin = (size_t)d * arrivals.size() / days + arrivals.size() / days / 3;
+            for (size_t g = 0; g < 1200 && begin + g < arrivals.size(); g += 120) {
+                size_t end = std::min(arrivals.size(), begin + g + 120);
+                std::shuffle(arrivals.begin() + begin + g, arrivals.begin() + end, rng);
+            }
+        }
+
+        auto t0 = std::chrono::steady_clock::now();
+        for (auto &r : arrivals) rollup_update(store, r);
+        update_s += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        updates += arrivals.size();
+    }
+
+    // Full recomputation from the final results
+    uint64_t bad_days = 0, bad_weeks = 0, episodes = 0;
+    for (int p = 0; p < patients; p++) {
+        std::vector<DayRollup> expect(days + 1);
+        std::vector<WeekRollup> expect_week(days / 7 + 3);
+        const int32_t first_day = rollup_day_of(store, p, window_start(0));
+        const int32_t first_week = rollup_week_of_day(first_day);
+        for (int64_t w = 0; w < windows; w++) {
+            uint8_t f = truth[p][w];
+            int32_t day = rollup_day_of(store, p, window_start(w));
+            DayRollup &d = expect[day - first_day];
+            WeekRollup &wk = expect_week[rollup_week_of_day(day) - first_week];
+            bool start = (f & SESSION_FREEZING) && (w == 0 || !(truth[p][w - 1] & SESSION_FREEZING));
+            d.windows++;
+            wk.windows++;
+            if (f & SESSION_TREMOR) { d.tremor_windows++; wk.tremor_windows++; }
+            if (f & SESSION_DYSKINESIA) { d.dyskinesia_windows++; wk.dyskinesia_windows++; }
+            if (f & SESSION_FREEZING) { d.fog_windows++; wk.fog_windows++; }
+            if (start) { d.fog_episodes++; wk.fog_episodes++; episodes++; }
+        }
+        for (int d = 0; d < days; d++) {
+            DayRollup got;
+            rollup_day(store, p, first_day + d, got);
+            if (memcmp(&got, &expect[d], sizeof(got)) != 0) bad_days++;
+        }
+        for (size_t k = 0; k < expect_week.size(); k++) {
+            WeekRollup got;
+            rollup_week(store, p, first_week + (int32_t)k, got);
+            if (memcmp(&got, &expect_week[k], sizeof(got)) != 0) bad_weeks++;
+        }
+    }
+
+    // A result beyond the correction horizon must be dropped, not re-added
+    DayRollup before, after;
+    rollup_day(store, 0, rollup_day_of(store, 0, window_start(0)), before);
+    rollup_update(store, RollupWindow{0, 0, window_start(0), 1, SESSION_FREEZING});
+    rollup_day(store, 0, rollup_day_of(store, 0, window_start(0)), after);
+    const bool horizon_ok = memcmp(&before, &after, sizeof(before)) == 0 && store.too_old == 1;
+
+    // Dashboard queries: one day, one week, the 8-week trend
+    const int32_t last_day = rollup_day_of(store, 0, window_start(windows - 1));
+    const int32_t last_week = rollup_week_of_day(last_day);
+    const int queries = 200000;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < queries; i++) {
+        DayRollup d;
+        rollup_day(store, (uint32_t)(i % patients), last_day - i % days, d);
+        sink += d.fog_episodes;
+    }
+    double day_ns = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count() * 1e9 / queries;
+    t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < queries; i++) {
+        RollupTrend t;
+        rollup_trend(store, (uint32_t)(i % patients), last_week, ROLLUP_TREND_WEEKS, t);
+        sink += (uint32_t)t.fog_episodes_per_day[0];
+    }
+    double trend_ns = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count() * 1e9 / queries;
+
+    RollupTrend t;
+    rollup_trend(store, 0, last_week, ROLLUP_TREND_WEEKS, t);
+    printf("patients=%d days=%d results=%llu corrections=%llu fog_episodes=%llu\n",
+           patients, days, (unsigned long long)updates, (unsigned long long)store.corrections,
+           (unsigned long long)episodes);
+    printf("update: %.1f ns/result\n", update_s * 1e9 / updates);
+    printf("query: day %.0f ns, 8-week trend %.0f ns\n", day_ns, trend_ns);
+    printf("memory: %zu bytes per patient (%zu B/day record)\n",
+           rollup_memory_bytes(store) / patients, sizeof(DayRollup));
+    printf("patient 0 trend: tremor %.1f min/day (slope %+.2f/wk), fog %.2f episodes/day (slope %+.3f/wk)\n",
+           t.tremor_minutes_per_day[t.weeks - 1], t.tremor_slope,
+           t.fog_episodes_per_day[t.weeks - 1], t.fog_slope);
+    printf("check: %llu days and %llu weeks differ from recomputation, "
+           "window 0 replayed at the end %s\n",
+           (unsigned long long)bad_days, (unsigned long long)bad_weeks,
+           horizon_ok ? "dropped as too old" : "CHANGED THE ROLLUP");
+    return (bad_days || bad_weeks || !horizon_ok) ? 1 : 0;
+}
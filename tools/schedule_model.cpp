@@ -0,0 +1,152 @@
+// Host-side model of the batched acquisition schedule: the MCU wakes on
+// each FIFO watermark, drains the batch over I2C, runs hop analysis when a
+// window completes, queues console output, then sleeps. While the UART is
+// still transmitting only light sleep is allowed; otherwise stop mode.
+//
+//   g++ -std=gnu++14 -O2 -Iinclude tools/schedule_model.cpp src/energy.cpp -o schedule_model
+//   ./schedule_model [--duration=S] [--analysis-us=N]
+//
+// Prints wakeups, duty cycle, sleep residency and estimated current for a
+// range of FIFO watermarks around the firmware's FIFO_BATCH_SAMPLES. The
+// simulator (sim/, native_sim) measures the same schedule on the real
+// firmware; this is the closed-form view for choosing the watermark.
+
+#include "config.h"
+#include "energy.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+
+struct ScheduleParams {
+    float    sample_rate_hz;         // IMU ODR
+    uint32_t batch_samples;          // FIFO watermark
+    uint32_t hop_samples;            // samples between analyses
+    uint32_t wake_overhead_us;       // stop-mode exit + RTOS bookkeeping
+    uint32_t i2c_status_us;          // FIFO status read per wakeup
+    uint32_t i2c_per_sample_us;      // burst read time per x/y/z sample
+    uint32_t analysis_us;            // detect_symptoms() per hop
+    uint32_t uart_bytes_per_hop;     // status lines per hop
+    uint32_t uart_bytes_per_second;  // periodic sample log
+    uint32_t uart_baud;
+};
+
+struct ScheduleResult {
+    float wakeups_per_s;
+    float awake_fraction;            // duty cycle
+    float sleep_fraction;
+    float deep_sleep_fraction;
+    EnergyReport energy;
+};
+
+// Parameters matching the current firmware configuration
+static ScheduleParams schedule_default_params() {
+    ScheduleParams p{};
+    p.sample_rate_hz        = FS_HZ;
+    p.batch_samples         = 26;       // FIFO_BATCH_SAMPLES
+    p.hop_samples           = WINDOW_SAMPLES;
+    p.wake_overhead_us      = 60;
+    p.i2c_status_us         = 150;      // 4 bytes + address at 400 kHz
+    p.i2c_per_sample_us     = 150;      // 6 bytes at 400 kHz
+    p.analysis_us           = 6000;
+    p.uart_bytes_per_hop    = 16;       // "[T|D|F]" + "---"
+    p.uart_bytes_per_second = 48;       // "Sample n | X: ..." line
+    p.uart_baud             = 115200;
+    return p;
+}
+
+static ScheduleResult schedule_simulate(const ScheduleParams &p,
+                                        const EnergyModel &model,
+                                        float duration_s) {
+    ScheduleResult r{};
+    if (p.sample_rate_hz <= 0.0f || p.batch_samples == 0 || duration_s <= 0.0f) return r;
+
+    const double sample_us = 1e6 / p.sample_rate_hz;
+    const double batch_us = sample_us * p.batch_samples;
+    const double total_us = duration_s * 1e6;
+    const double us_per_uart_byte = 10.0 * 1e6 / p.uart_baud;
+
+    uint64_t residency[ENERGY_COUNT] = {0};
+    double samples = 0.0;
+    double next_hop = p.hop_samples;
+    double next_log_s = 0.0;
+    uint32_t wakeups = 0;
+
+    // Walk the schedule one batch (one wakeup) at a time
+    for (double t = batch_us; t <= total_us; t += batch_us) {
+        wakeups++;
+        samples += p.batch_samples;
+
+        double awake = p.wake_overhead_us;
+        double i2c = p.i2c_status_us + (double)p.i2c_per_sample_us * p.batch_samples;
+        double dsp = 0.0;
+        double uart_bytes = 0.0;
+
+        while (p.hop_samples > 0 && samples >= next_hop) {
+            dsp += p.analysis_us;
+            uart_bytes += p.uart_bytes_per_hop;
+            next_hop += p.hop_samples;
+        }
+        while (t / 1e6 >= next_log_s) {
+            uart_bytes += p.uart_bytes_per_second;
+            next_log_s += 1.0;
+        }
+
+        // TX drains after the CPU is done; it only blocks deep sleep
+        double awake_total = awake + i2c + dsp;
+        double uart_us = uart_bytes * us_per_uart_byte;
+        double idle_us = batch_us - awake_total;
+        if (idle_us < 0.0) idle_us = 0.0;
+        double light_us = uart_us < idle_us ? uart_us : idle_us;
+
+        residency[ENERGY_I2C]        += (uint64_t)i2c;
+        residency[ENERGY_DSP]        += (uint64_t)dsp;
+        residency[ENERGY_UART]       += (uint64_t)uart_us;
+        residency[ENERGY_SLEEP]      += (uint64_t)light_us;
+        residency[ENERGY_DEEP_SLEEP] += (uint64_t)(idle_us - light_us);
+    }
+
+    const double simulated_us = wakeups * batch_us;
+    if (simulated_us <= 0.0) return r;
+
+    r.wakeups_per_s       = (float)(wakeups / (simulated_us / 1e6));
+    r.sleep_fraction      = (float)(residency[ENERGY_SLEEP] / simulated_us);
+    r.deep_sleep_fraction = (float)(residency[ENERGY_DEEP_SLEEP] / simulated_us);
+    r.awake_fraction      = 1.0f - r.sleep_fraction - r.deep_sleep_fraction;
+    r.energy = energy_estimate(model, residency, (uint64_t)simulated_us);
+    return r;
+}
+
+static bool parse_option(const char *arg, const char *name, const char **value) {
+    size_t n = strlen(name);
+    if (strncmp(arg, name, n) != 0 || arg[n] != '=') return false;
+    *value = arg + n + 1;
+    return true;
+}
+
+int main(int argc, char **argv) {
+    ScheduleParams params = schedule_default_params();
+    float duration_s = 3600.0f;
+    for (int i = 1; i < argc; i++) {
+        const char *v;
+        if (parse_option(argv[i], "--duration", &v)) duration_s = (float)atof(v);
+        else if (parse_option(argv[i], "--analysis-us", &v)) params.analysis_us = (uint32_t)atoi(v);
+        else {
+            fprintf(stderr, "usage: %s [--duration=S] [--analysis-us=N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    const EnergyModel model = energy_default_model();
+    printf("%8s %10s %8s %8s %8s %10s\n", "batch", "wakeups/s", "awake", "sleep", "deep", "mAh/h");
+    for (uint32_t batch : {1u, 4u, 13u, 26u, 52u, 104u}) {
+        params.batch_samples = batch;
+        ScheduleResult r = schedule_simulate(params, model, duration_s);
+        printf("%8u %10.2f %7.2f%% %7.2f%% %7.2f%% %10.3f%s\n", (unsigned)batch, r.wakeups_per_s,
+               100.0f * r.awake_fraction, 100.0f * r.sleep_fraction,
+               100.0f * r.deep_sleep_fraction, r.energy.total_mah_per_hour,
+               batch == schedule_default_params().batch_samples ? "  <- firmware" : "");
+    }
+    return 0;
+}
@@ -0,0 +1,555 @@
+// Moves live streams between gateway processes through a ShardRing.
+//
+//   g++ -std=gnu++14 -O2 -Iinclude tools/shard_handoff.cpp src/gateway/*.cpp src/load_shed.cpp src/timer_wheel.cpp src/detect_core.cpp src/harmonic_canceller.cpp src/activity.cpp src/baseline.cpp src/spectral_backend.cpp src/spectral_kernels.cpp -o shard_handoff
+//   ./shard_handoff [--nodes=N] [--streams=S] [--minutes=M]
+//
+// Forks N node processes. Each runs an IngestWorker fed over a socketpair
+// with the ingest datagrams a relay would send, and a DetectStream per
+// stream on every closed window. The parent plays the relays: S wearers
+// cycling through standing, 4.5 Hz tremor, walking and lying, one 26-sample
+// batch per stream every 0.5 s, each routed to its owner on the ring.
+// Nodes 0..N-2 start on the ring; node N-1 joins halfway through and node
+// 0 leaves at three quarters. Every stream whose owner changes is handed
+// over before its next batch:
+//   checkpoint  the old owner sends checkpoint_save() of its DetectStream
+//               and ReorderBuffer, the new owner restores it
+//   cold        the old owner flushes its partial window and forgets the
+//               stream; the new owner starts from nothing
+// Every window result is compared with an in-process run of the same
+// pipeline that never moves. With checkpoints nothing may be missing,
+// incomplete or different; cold handoff shows the split window (the 3 s
+// refill gap) and the results that differ until state is re-learned.
+// Every 16th wearer also drops out for 10 s every 4 minutes, and another
+// 16th sits behind a relay whose live link hangs for 5 s, resending its
+// last batch until it catches up. The nodes run their hop and stall timers
+// on the relay's clock (one tick per batch round): each drop-out must
+// count as exactly one stall, each hang as at least one missed hop
+// deadline, and the totals must match the unmoved run wherever the
+// streams live at the time.
+
+#include "gateway/checkpoint.h"
+#include "gateway/ingest.h"
+#include "gateway/shard.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+static const uint16_t BATCH = 26;
+static const float LSB_TO_G = 0.061f / 1000.0f;
+static const size_t MAX_MESSAGE = 256 * 1024;
+
+enum MessageType : uint8_t {
+    NODE_BATCH = 1,           // parent -> node: ingest datagram
+    NODE_HANDOFF_OUT,         // parent -> node: u32 stream, u8 cold
+    NODE_HANDOFF_IN,          // parent -> node: checkpoint
+    NODE_FINISH,              // parent -> node: flush everything and exit
+    NODE_TICK,                // parent -> node: u32 clock in ms
+    NODE_RESULT,              // node -> parent: one analysed window
+    NODE_CHECKPOINT,          // node -> parent: handoff reply (empty when cold)
+    NODE_DONE,                // node -> parent: flushed, u64 hop misses, u64 stalls
+};
+
+struct ResultMessage {
+    uint8_t type;
+    uint32_t stream_id;
+    int64_t window;
+    uint32_t revision;
+    uint32_t present;
+    float tremor;
+    float dyskinesia;
+    float step_hz;
+    uint8_t activity;
+    uint8_t flags;           // bit0 tremor, bit1 dyskinesia, bit2 freezing
+};
+
+// === Node side ===
+struct Node {
+    int fd;                  // -1 for the in-process reference
+    IngestWorker ingest;
+    std::unordered_map<uint32_t, std::unique_ptr<DetectStream>> detect;
+    std::map<std::pair<uint32_t, int64_t>, ResultMessage> *results;   // reference only
+};
+
+static DetectStream &detect_for(Node &node, uint32_t stream_id) {
+    std::unique_ptr<DetectStream> &d = node.detect[stream_id];
+    if (!d) {
+        d.reset(new DetectStream);
+        detect_stream_init(*d);
+    }
+    return *d;
+}
+
+static void analyse_at_tier(void *context, const ReorderView &view, AnalysisTier tier) {
+    Node &node = *(Node *)context;
+    float xyz[WINDOW_SAMPLES * 3];
+    for (uint32_t i = 0; i < view.size && i < WINDOW_SAMPLES; i++) {
+        xyz[i * 3] = view.accel_x[i];
+        xyz[i * 3 + 1] = view.accel_y[i];
+        xyz[i * 3 + 2] = view.accel_z[i];
+    }
+    DetectWindowResult r = detect_stream_window(detect_for(node, view.stream_id), xyz, tier);
+
+    ResultMessage m = {};
+    m.type = NODE_RESULT;
+    m.stream_id = view.stream_id;
+    m.window = view.window;
+    m.revision = view.revision;
+    m.present = view.present;
+    m.tremor = r.tremor_intensity;
+    m.dyskinesia = r.dyskinesia_intensity;
+    m.step_hz = r.step_hz;
+    m.activity = r.activity;
+    m.flags = (r.tremor_detected ? 1 : 0) | (r.dyskinesia_detected ? 2 : 0) |
+              (r.freezing_detected ? 4 : 0);
+    if (node.fd < 0) (*node.results)[{m.stream_id, m.window}] = m;
+    else send(node.fd, &m, sizeof(m), 0);
+}
+
+// Flushes bypass the worker; node_init() keeps every window at TIER_FULL
+// anyway, since each must match the reference exactly
+static void analyse(void *context, const ReorderView &view) {
+    analyse_at_tier(context, view, TIER_FULL);
+}
+
+static void node_init(Node &node, int fd) {
+    IngestConfig config = ingest_default_config(0);
+    config.send_acks = false;
+    config.load_shed.latency_budget_us = UINT32_MAX;
+    config.load_shed.queue_high = UINT32_MAX;
+    node.fd = fd;
+    ingest_init(node.ingest, config);
+    node.ingest.on_window = analyse_at_tier;
+    node.ingest.window_context = &node;
+}
+
+static void node_release(Node &node, uint32_t stream_id, bool cold, std::vector<uint8_t> &reply) {
+    reply.assign(1, NODE_CHECKPOINT);
+    ReorderBuffer *reorder = ingest_stream(node.ingest, stream_id);
+    if (reorder == nullptr) return;
+    if (cold) {
+        reorder_flush(*reorder, analyse, &node);
+    } else {
+        reply.resize(1 + checkpoint_size(*reorder));
+        checkpoint_save(detect_for(node, stream_id), *reorder, &reply[1], reply.size() - 1);
+    }
+    ingest_forget(node.ingest, stream_id);
+    node.detect.erase(stream_id);
+}
+
+static bool node_adopt(Node &node, const uint8_t *blob, size_t length) {
+    ReorderBuffer reorder;
+    std::unique_ptr<DetectStream> d(new DetectStream);
+    detect_stream_init(*d);
+    if (!checkpoint_restore(blob, length, *d, reorder)) return false;
+    node.detect[reorder.stream_id] = std::move(d);
+    ingest_adopt(node.ingest, std::move(reorder));
+    return true;
+}
+
+static int node_main(int fd) {
+    Node node;
+    node_init(node, fd);
+    std::vector<uint8_t> msg(MAX_MESSAGE), reply;
+    for (;;) {
+        ssize_t n = recv(fd, msg.data(), msg.size(), 0);
+        if (n <= 0) return 1;
+        switch (msg[0]) {
+        case NODE_BATCH:
+            ingest_datagram(node.ingest, &msg[1], (size_t)n - 1);
+            break;
+        case NODE_HANDOFF_OUT: {
+            uint32_t stream_id;
+            memcpy(&stream_id, &msg[1], sizeof(stream_id));
+            node_release(node, stream_id, msg[5] != 0, reply);
+            send(fd, reply.data(), reply.size(), 0);
+            break;
+        }
+        case NODE_HANDOFF_IN:
+            if (!node_adopt(node, &msg[1], (size_t)n - 1)) {
+                fprintf(stderr, "shard_handoff: checkpoint rejected\n");
+                return 1;
+            }
+            break;
+        case NODE_TICK: {
+            uint32_t now_ms;
+            memcpy(&now_ms, &msg[1], sizeof(now_ms));
+            ingest_advance(node.ingest, now_ms);
+            break;
+        }
+        case NODE_FINISH: {
+            for (auto &s : node.ingest.streams) reorder_flush(s.second, analyse, &node);
+            uint8_t done[17] = {NODE_DONE};
+            memcpy(&done[1], &node.ingest.stats.hop_misses, 8);
+            memcpy(&done[9], &node.ingest.stats.stalls, 8);
+            send(fd, done, sizeof(done), 0);
+            return 0;
+        }
+        default:
+            return 1;
+        }
+    }
+}
+
+// === Relay side ===
+struct Wearer {
+    uint32_t rng;
+    double step_phase;
+    double tremor_phase;
+};
+
+static double noise(Wearer &w) {
+    w.rng = w.rng * 1664525u + 1013904223u;
+    return ((w.rng >> 8) / 16777216.0) - 0.5;
+}
+
+// Every 16th stream is silent for 10 s out of every 4 minutes, staggered.
+// Another 16th has a relay whose live link stalls for 5 s as often: it
+// keeps resending its last batch, then delivers the held ones at once, so
+// batches never stop but no window can close in time.
+static const uint32_t EPISODE_EVERY = 480, SILENT_BATCHES = 20, HELD_BATCHES = 10;
+
+static bool wearer_silent(uint32_t stream_id, uint32_t batch) {
+    return stream_id % 16 == 3 && (batch + 37 * stream_id) % EPISODE_EVERY < SILENT_BATCHES;
+}
+
+static bool relay_holding(uint32_t stream_id, uint32_t batch) {
+    return stream_id % 16 == 11 && batch > 0 &&
+           (batch + 37 * stream_id) % EPISODE_EVERY < HELD_BATCHES;
+}
+
+// 60 s each of standing, tremor, walking, lying, offset per stream
+static void wearer_batch(Wearer &w, uint32_t stream_id, uint32_t first_seq, int16_t (*xyz)[3]) {
+    const double fs = 52.0;
+    for (uint16_t i = 0; i < BATCH; i++) {
+        double t = (first_seq + i) / fs + 7.0 * stream_id;
+        int phase = (int)(t / 60.0) % 4;
+        double g[3] = {0.0, 0.0, 1.0};
+        if (phase == 3) {
+            g[0] = 1.0;
+            g[2] = 0.05;
+        }
+        double motion = 0.0;
+        if (phase == 1) {
+            w.tremor_phase += 2.0 * M_PI * 4.5 / fs;
+            motion = 0.15 * sin(w.tremor_phase);
+        } else if (phase == 2) {
+            w.step_phase += 2.0 * M_PI * 1.8 / fs;
+            motion = 0.3 * sin(w.step_phase) + 0.1 * sin(2.0 * w.step_phase);
+        }
+        for (int a = 0; a < 3; a++) {
+            double v = g[a] + (a == 2 ? motion : 0.4 * motion) + 0.01 * noise(w);
+            xyz[i][a] = (int16_t)lrint(v / LSB_TO_G);
+        }
+    }
+}
+
+struct Peer {
+    int fd;
+    pid_t pid;
+    bool done;
+};
+
+struct Tally {
+    std::map<std::pair<uint32_t, int64_t>, ResultMessage> results;
+    uint32_t handoffs;
+    uint64_t checkpoint_bytes;
+    uint64_t hop_misses;
+    uint64_t stalls;
+};
+
+// Read whatever the node has sent; stop early once `want` arrives
+static bool drain(Peer &peer, Tally &tally, std::vector<uint8_t> &buf, uint8_t want, bool block) {
+    for (;;) {
+        ssize_t n = recv(peer.fd, buf.data(), buf.size(), block ? 0 : MSG_DONTWAIT);
+        if (n <= 0) return false;
+        if (buf[0] == NODE_RESULT) {
+            ResultMessage m;
+            memcpy(&m, buf.data(), sizeof(m));
+            tally.results[{m.stream_id, m.window}] = m;
+            continue;
+        }
+        if (buf[0] == NODE_DONE && n == 17) {
+            uint64_t misses, stalls;
+            memcpy(&misses, &buf[1], 8);
+            memcpy(&stalls, &buf[9], 8);
+            tally.hop_misses += misses;
+            tally.stalls += stalls;
+            peer.done = true;
+        }
+        if (buf[0] == want) {
+            buf.resize((size_t)n);
+            return true;
+        }
+    }
+}
+
+static void send_to(std::vector<Peer> &peers, size_t node, const uint8_t *data, size_t length,
+                    Tally &tally, std::vector<uint8_t> &buf) {
+    // Drain results while the node's queue is full so neither side blocks
+    while (send(peers[node].fd, data, length, MSG_DONTWAIT) < 0) {
+        for (Peer &p : peers) drain(p, tally, buf, 0, false);
+        buf.resize(MAX_MESSAGE);
+    }
+}
+
+static void hand_over(std::vector<Peer> &peers, uint32_t stream_id, uint32_t from, uint32_t to,
+                      bool cold, Tally &tally, std::vector<uint8_t> &buf) {
+    uint8_t request[6] = {NODE_HANDOFF_OUT};
+    memcpy(&request[1], &stream_id, sizeof(stream_id));
+    request[5] = cold ? 1 : 0;
+    send_to(peers, from, request, sizeof(request), tally, buf);
+    buf.resize(MAX_MESSAGE);
+    if (!drain(peers[from], tally, buf, NODE_CHECKPOINT, true)) {
+        fprintf(stderr, "shard_handoff: node %u did not answer\n", from);
+        exit(1);
+    }
+    tally.handoffs++;
+    if (!cold && buf.size() > 1) {
+        tally.checkpoint_bytes += buf.size() - 1;
+        buf[0] = NODE_HANDOFF_IN;
+        std::vector<uint8_t> blob(buf);
+        send_to(peers, to, blob.data(), blob.size(), tally, buf);
+    }
+    buf.resize(MAX_MESSAGE);
+}
+
+static void reassign(const ShardRing &ring, std::vector<uint32_t> &owner, std::vector<Peer> &peers,
+                     bool cold, Tally &tally, std::vector<uint8_t> &buf, uint32_t &moved) {
+    for (uint32_t s = 0; s < owner.size(); s++) {
+        uint32_t now;
+        shard_ring_lookup(ring, s, now);
+        if (now == owner[s]) continue;
+        hand_over(peers, s, owner[s], now, cold, tally, buf);
+        owner[s] = now;
+        moved++;
+    }
+}
+
+struct Plan {
+    int nodes;
+    int streams;
+    uint32_t batches;
+    uint32_t join_at;
+    uint32_t leave_at;
+};
+
+// cold < 0: the in-process reference, no nodes and no moves
+static bool run(const Plan &plan, int cold, Tally &tally, uint32_t &joined, uint32_t &left) {
+    tally = Tally{};
+    joined = left = 0;
+    std::vector<Peer> peers;
+    Node reference;
+    if (cold < 0) {
+        node_init(reference, -1);
+        reference.results = &tally.results;
+    } else {
+        for (int i = 0; i < plan.nodes; i++) {
+            int sv[2];
+            if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sv) != 0) return false;
+            int size = 4 << 20;
+            setsockopt(sv[0], SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+            setsockopt(sv[1], SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+            fflush(stdout);
+            pid_t pid = fork();
+            if (pid == 0) {
+                close(sv[0]);
+                for (Peer &p : peers) close(p.fd);
+                _exit(node_main(sv[1]));
+            }
+            close(sv[1]);
+            peers.push_back(Peer{sv[0], pid, false});
+        }
+    }
+
+    ShardRing ring;
+    shard_ring_init(ring);
+    for (int i = 0; i + 1 < plan.nodes; i++) shard_ring_add_node(ring, (uint32_t)i);
+    std::vector<uint32_t> owner(plan.streams);
+    for (int s = 0; s < plan.streams; s++) shard_ring_lookup(ring, (uint32_t)s, owner[s]);
+
+    std::vector<Wearer> wearers(plan.streams);
+    for (int s = 0; s < plan.streams; s++) wearers[s] = Wearer{(uint32_t)s + 1, 0.0, 0.0};
+    std::vector<uint8_t> buf(MAX_MESSAGE);
+    std::vector<std::vector<uint8_t>> last_sent(plan.streams), held;
+    std::vector<std::vector<std::vector<uint8_t>>> holding(plan.streams);
+    int16_t xyz[BATCH][3];
+
+    for (uint32_t b = 0; b < plan.batches; b++) {
+        // Batch b is sent once its 0.5 s of samples has been read
+        const uint32_t now_ms = (b + 1) * 500;
+        if (cold < 0) {
+            ingest_advance(reference.ingest, now_ms);
+        } else {
+            uint8_t tick[5] = {NODE_TICK};
+            memcpy(&tick[1], &now_ms, sizeof(now_ms));
+            for (size_t i = 0; i < peers.size(); i++) send_to(peers, i, tick, sizeof(tick), tally, buf);
+        }
+        if (cold >= 0 && b == plan.join_at) {
+            shard_ring_add_node(ring, (uint32_t)plan.nodes - 1);
+            reassign(ring, owner, peers, cold > 0, tally, buf, joined);
+        }
+        if (cold >= 0 && b == plan.leave_at) {
+            shard_ring_remove_node(ring, 0);
+            reassign(ring, owner, peers, cold > 0, tally, buf, left);
+        }
+        for (int s = 0; s < plan.streams; s++) {
+            wearer_batch(wearers[s], (uint32_t)s, b * BATCH, xyz);
+            if (wearer_silent((uint32_t)s, b)) continue;
+            std::vector<uint8_t> msg(1 + INGEST_MAX_DATAGRAM, NODE_BATCH);
+            msg.resize(1 + ingest_encode_samples(&msg[1], INGEST_MAX_DATAGRAM, (uint32_t)s,
+                                                 b * BATCH, xyz, BATCH, 0));
+            if (relay_holding((uint32_t)s, b)) {
+                holding[s].push_back(msg);
+                held.assign(1, last_sent[s]);
+            } else {
+                held.swap(holding[s]);
+                holding[s].clear();
+                held.push_back(msg);
+                last_sent[s] = msg;
+            }
+            for (const std::vector<uint8_t> &m : held) {
+                if (cold < 0) ingest_datagram(reference.ingest, &m[1], m.size() - 1);
+                else send_to(peers, owner[s], m.data(), m.size(), tally, buf);
+            }
+        }
+    }
+
+    if (cold < 0) {
+        for (auto &s : reference.ingest.streams) reorder_flush(s.second, analyse, &reference);
+        tally.hop_misses = reference.ingest.stats.hop_misses;
+        tally.stalls = reference.ingest.stats.stalls;
+        return true;
+    }
+    bool ok = true;
+    for (size_t i = 0; i < peers.size(); i++) {
+        uint8_t finish = NODE_FINISH;
+        send_to(peers, i, &finish, 1, tally, buf);
+    }
+    for (Peer &p : peers) {
+        while (!p.done) {
+            buf.resize(MAX_MESSAGE);
+            if (!drain(p, tally, buf, NODE_DONE, true)) break;
+        }
+        int status = 0;
+        waitpid(p.pid, &status, 0);
+        ok = ok && p.done && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        close(p.fd);
+    }
+    return ok;
+}
+
+struct Comparison {
+    uint32_t windows;
+    uint32_t missing;
+    uint32_t incomplete;
+    uint32_t differ;
+    uint32_t flags_differ;
+};
+
+static Comparison compare(const Tally &reference, const Tally &moved) {
+    Comparison c = {};
+    for (const auto &kv : reference.results) {
+        c.windows++;
+        auto it = moved.results.find(kv.first);
+        if (it == moved.results.end()) {
+            c.missing++;
+            continue;
+        }
+        const ResultMessage &a = kv.second, &b = it->second;
+        c.incomplete += b.present != a.present;
+        c.differ += a.tremor != b.tremor || a.dyskinesia != b.dyskinesia ||
+                    a.step_hz != b.step_hz || a.activity != b.activity || a.flags != b.flags;
+        c.flags_differ += a.flags != b.flags;
+    }
+    return c;
+}
+
+// Drop-outs long enough for the stall timer to fire before the run ends
+static uint64_t expected_stalls(const Plan &plan) {
+    uint64_t n = 0;
+    for (int s = 0; s < plan.streams; s++) {
+        for (uint32_t b = 1; b + 2 < plan.batches; b++) {
+            n += wearer_silent((uint32_t)s, b) && !wearer_silent((uint32_t)s, b - 1);
+        }
+    }
+    return n;
+}
+
+// Held relay links, each of which must miss at least one hop deadline
+static uint64_t expected_holds(const Plan &plan) {
+    uint64_t n = 0;
+    for (int s = 0; s < plan.streams; s++) {
+        for (uint32_t b = 1; b + HELD_BATCHES < plan.batches; b++) {
+            n += relay_holding((uint32_t)s, b) && !relay_holding((uint32_t)s, b - 1);
+        }
+    }
+    return n;
+}
+
+static int arg_int(int argc, char **argv, const char *name, int fallback) {
+    size_t n = strlen(name);
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], name, n) == 0 && argv[i][n] == '=') return atoi(argv[i] + n + 1);
+    }
+    return fallback;
+}
+
+int main(int argc, char **argv) {
+    Plan plan;
+    plan.nodes = arg_int(argc, argv, "--nodes", 4);
+    plan.streams = arg_int(argc, argv, "--streams", 128);
+    const int minutes = arg_int(argc, argv, "--minutes", 12);
+    plan.batches = (uint32_t)minutes * 120;
+    plan.join_at = plan.batches / 2 + 1;      // mid-window: batches are 1/6 of a window
+    plan.leave_at = plan.batches * 3 / 4 + 3;
+    if (plan.nodes < 2) plan.nodes = 2;
+
+    Tally reference, tally;
+    uint32_t joined, left;
+    run(plan, -1, reference, joined, left);
+
+    printf("nodes=%d streams=%d minutes=%d: node %d joins at %.1f s, node 0 leaves at %.1f s\n",
+           plan.nodes, plan.streams, minutes, plan.nodes - 1, plan.join_at * BATCH / 52.0,
+           plan.leave_at * BATCH / 52.0);
+    const uint64_t stalls = expected_stalls(plan);
+    const uint64_t holds = expected_holds(plan);
+    printf("unmoved: %zu windows, %llu stalls (%llu drop-outs), %llu hop deadlines missed "
+           "(%llu held relay links)\n", reference.results.size(),
+           (unsigned long long)reference.stalls, (unsigned long long)stalls,
+           (unsigned long long)reference.hop_misses, (unsigned long long)holds);
+    printf("%-11s %8s %8s %11s %8s %8s %11s %8s %12s %7s %11s\n", "handoff", "joined", "left",
+           "ckpt bytes", "windows", "missing", "incomplete", "differ", "flags differ", "stalls",
+           "hop misses");
+    bool ok = reference.stalls == stalls && reference.hop_misses >= holds;
+    for (int cold = 0; cold <= 1; cold++) {
+        if (!run(plan, cold, tally, joined, left)) {
+            fprintf(stderr, "shard_handoff: a node failed\n");
+            return 1;
+        }
+        Comparison c = compare(reference, tally);
+        char bytes[16] = "-";
+        if (!cold && tally.handoffs) {
+            snprintf(bytes, sizeof(bytes), "%llu", (unsigned long long)(tally.checkpoint_bytes / tally.handoffs));
+        }
+        printf("%-11s %8u %8u %11s %8u %8u %11u %8u %12u %7llu %11llu\n",
+               cold ? "cold" : "checkpoint", joined, left, bytes, c.windows, c.missing,
+               c.incomplete, c.differ, c.flags_differ, (unsigned long long)tally.stalls,
+               (unsigned long long)tally.hop_misses);
+        if (!cold) {
+            ok = ok && c.missing == 0 && c.incomplete == 0 && c.differ == 0 && joined + left > 0 &&
+                 tally.stalls == stalls && tally.hop_misses == reference.hop_misses;
+        }
+    }
+    printf("check: checkpoint handoff %s the unmoved run, timers included\n",
+           ok ? "matches" : "DIFFERS from");
+    return ok ? 0 : 1;
+}
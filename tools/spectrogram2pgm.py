@@ -0,0 +1,112 @@
+"""Convert a firmware spectrogram dump to a PGM image (one column per
+window, low frequencies at the bottom; gaps are black).
+
+Reads a console log containing
+
+    SPECTROGRAM BEGIN bins=<n> low=<first bin> fft=<size> fs=<Hz> offset=<q at 0 dB>
+    SD <hex records>
+    ...
+    SPECTROGRAM END
+
+Records are described in include/spectrogram.h. Live "SG" lines
+(SPECTROGRAM_STREAM) use the same records and are decoded too when no
+dump is present.
+
+usage: python tools/spectrogram2pgm.py console.log > spectrogram.pgm
+"""
+
+import re
+import sys
+
+
+def parse(lines):
+    header = None
+    data = bytearray()
+    live = bytearray()
+    dumping = False
+    for line in lines:
+        line = line.strip()
+        m = re.match(r"SPECTROGRAM BEGIN bins=(\d+) low=(\d+) fft=(\d+) fs=([\d.]+) offset=(\d+)", line)
+        if m:
+            header = {"bins": int(m.group(1)), "low": int(m.group(2)), "fft": int(m.group(3)),
+                      "fs": float(m.group(4)), "offset": int(m.group(5))}
+            data = bytearray()
+            dumping = True
+        elif line.startswith("SPECTROGRAM END"):
+            dumping = False
+        elif dumping and line.startswith("SD "):
+            data += bytes.fromhex(line[3:].strip())
+        elif line.startswith("SG "):
+            live += bytes.fromhex(line[3:].strip())
+    return header, data if data else live
+
+
+def bits(payload):
+    for b in payload:
+        for shift in range(7, -1, -1):
+            yield (b >> shift) & 1
+
+
+def read(it, count):
+    value = 0
+    for _ in range(count):
+        value = (value << 1) | next(it)
+    return value
+
+
+def decode(data, bins):
+    """Yield (window seq, column or None for a gap, record bytes)."""
+    seq = None
+    column = [0] * bins
+    pos = 0
+    while pos < len(data):
+        kind = chr(data[pos])
+        if kind == "K":
+            seq = data[pos + 1] | (data[pos + 2] << 8)
+            column = list(data[pos + 3:pos + 3 + bins])
+            size = 3 + bins
+        elif kind == "D":
+            size = 2 + data[pos + 1]
+            k = data[pos + 2]
+            it = bits(data[pos + 3:pos + size])
+            for i in range(bins):
+                q = 0
+                while q < 12 and next(it):
+                    q += 1
+                if q == 12:
+                    column[i] = read(it, 8)
+                    continue
+                u = (q << k) | read(it, k)
+                column[i] = (column[i] + (-(u + 1) // 2 if u & 1 else u // 2)) & 0xFF
+        elif kind == "G":
+            size = 1
+        else:
+            raise ValueError("bad record %r at byte %d" % (kind, pos))
+        if seq is not None:
+            yield seq, (None if kind == "G" else list(column)), size
+            seq = (seq + 1) & 0xFFFF
+        pos += size
+
+
+def main():
+    lines = open(sys.argv[1]) if len(sys.argv) > 1 else sys.stdin
+    header, data = parse(lines)
+    bins = header["bins"] if header else 71
+    windows = list(decode(data, bins))
+    if not windows:
+        sys.exit("no spectrogram records found")
+
+    if header:
+        hz = header["fs"] / header["fft"]
+        sys.stderr.write("%d windows, %d bytes (%.1f per window), %.2f-%.2f Hz, 0 dB at level %d\n" % (
+            len(windows), len(data), len(data) / len(windows),
+            header["low"] * hz, (header["low"] + bins - 1) * hz, header["offset"]))
+
+    out = sys.stdout.buffer
+    out.write(b"P5\n%d %d\n255\n" % (len(windows), bins))
+    for row in reversed(range(bins)):
+        out.write(bytes(c[row] if c else 0 for _, c, _ in windows))
+
+
+if __name__ == "__main__":
+    main()
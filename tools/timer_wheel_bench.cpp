@@ -0,0 +1,144 @@
+// Cost of the timer wheel at gateway scale.
+//
+//   g++ -std=gnu++14 -O2 -Iinclude tools/timer_wheel_bench.cpp src/timer_wheel.cpp -o timer_wheel_bench
+//   ./timer_wheel_bench [--streams=N] [--minutes=M]
+//
+// Every stream owns a hop timer (one analysis per HOP_PERIOD_MS, phases
+// spread across streams) and a stall timer pushed back SENSOR_STALL_MS on
+// each 0.5 s sample batch. 1% of streams go silent for a minute at a time,
+// so their stall timer fires and is re-armed when data returns. The wheel
+// advances one 1 ms tick at a time, as a worker's event loop would.
+// Reports ns per reschedule, per cancel and per tick (including the
+// callbacks that re-arm hops), and checks every timer fired on its tick.
+
+#include "config.h"
+#include "timer_wheel.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+static const uint32_t BATCH_MS = 500;
+static const uint32_t SILENT_MS = 60000;
+
+using Clock = std::chrono::steady_clock;
+
+struct Stream {
+    TimerNode hop;
+    TimerNode stall;
+    uint32_t silent_until;
+};
+
+static TimerWheel wheel;
+static uint64_t hops_fired = 0;
+static uint64_t stalls_fired = 0;
+static uint64_t late = 0;
+
+static void on_hop(TimerNode &node) {
+    if (node.expires != wheel.now) late++;
+    hops_fired++;
+    timer_wheel_schedule(wheel, node, node.expires + HOP_PERIOD_MS);
+}
+
+static void on_stall(TimerNode &node) {
+    if (node.expires != wheel.now) late++;
+    stalls_fired++;
+}
+
+static int arg_int(int argc, char **argv, const char *name, int fallback) {
+    size_t n = strlen(name);
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], name, n) == 0 && argv[i][n] == '=') return atoi(argv[i] + n + 1);
+    }
+    return fallback;
+}
+
+static double ns_since(Clock::time_point t0) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+}
+
+int main(int argc, char **argv) {
+    const int streams = arg_int(argc, argv, "--streams", 100000);
+    const int minutes = arg_int(argc, argv, "--minutes", 5);
+    const uint32_t end_ms = (uint32_t)minutes * 60000u;
+
+    std::vector<Stream> s(streams);
+    timer_wheel_init(wheel, 0);
+
+    auto t0 = Clock::now();
+    for (int i = 0; i < streams; i++) {
+        timer_node_init(s[i].hop, on_hop, &s[i]);
+        timer_node_init(s[i].stall, on_stall, &s[i]);
+        s[i].silent_until = 0;
+        timer_wheel_schedule(wheel, s[i].hop, (uint32_t)((uint64_t)i * HOP_PERIOD_MS / streams) + 1);
+        timer_wheel_schedule(wheel, s[i].stall, SENSOR_STALL_MS);
+    }
+    double setup_ns = ns_since(t0);
+
+    // Batches arrive spread over each 500 ms; stream i's batch lands on
+    // tick i % BATCH_MS of every period
+    std::vector<std::vector<int>> arrivals(BATCH_MS);
+    for (int i = 0; i < streams; i++) arrivals[i % BATCH_MS].push_back(i);
+
+    std::vector<int> silenced;
+    uint32_t rng = 1;
+    uint64_t reschedules = 0, cancels = 0, ticks = 0;
+    double reschedule_ns = 0.0, cancel_ns = 0.0, advance_ns = 0.0;
+
+    for (uint32_t now = 1; now <= end_ms; now++) {
+        const std::vector<int> &due = arrivals[now % BATCH_MS];
+
+        // 1% of arriving streams go silent: cancel their hop until data returns
+        silenced.clear();
+        for (int i : due) {
+            Stream &st = s[i];
+            if (st.silent_until > now) continue;
+            rng = rng * 1664525u + 1013904223u;
+            if ((rng >> 8) % 100 == 0 && now % SILENT_MS < BATCH_MS) {
+                st.silent_until = now + SILENT_MS;
+                silenced.push_back(i);
+            }
+        }
+        if (!silenced.empty()) {
+            t0 = Clock::now();
+            for (int i : silenced) timer_wheel_cancel(wheel, s[i].hop);
+            cancel_ns += ns_since(t0);
+            cancels += silenced.size();
+        }
+
+        t0 = Clock::now();
+        for (int i : due) {
+            Stream &st = s[i];
+            if (st.silent_until > now) continue;
+            timer_wheel_schedule(wheel, st.stall, now + SENSOR_STALL_MS);
+            reschedules++;
+            if (!timer_node_pending(st.hop)) {
+                timer_wheel_schedule(wheel, st.hop, now + HOP_PERIOD_MS);
+                reschedules++;
+            }
+        }
+        reschedule_ns += ns_since(t0);
+
+        t0 = Clock::now();
+        timer_wheel_advance(wheel, now);
+        advance_ns += ns_since(t0);
+        ticks++;
+    }
+
+    printf("streams=%d minutes=%d timers=%u pending\n", streams, minutes, wheel.pending);
+    printf("setup: %.1f ns per schedule\n", setup_ns / (2.0 * streams));
+    printf("reschedule: %llu stall/hop re-arms, %.1f ns each\n",
+           (unsigned long long)reschedules, reschedule_ns / reschedules);
+    printf("cancel: %llu, %.1f ns each\n", (unsigned long long)cancels,
+           cancels ? cancel_ns / cancels : 0.0);
+    printf("advance: %llu ticks, %.0f ns per tick, %.1f ns per fired timer (hops %llu, stalls %llu)\n",
+           (unsigned long long)ticks, advance_ns / ticks,
+           advance_ns / (double)(hops_fired + stalls_fired),
+           (unsigned long long)hops_fired, (unsigned long long)stalls_fired);
+    printf("per stream: %.0f ns of wheel work per second of data\n",
+           (reschedule_ns + cancel_ns + advance_ns) / streams / (end_ms / 1000.0));
+    printf("check: %llu timers fired off their tick\n", (unsigned long long)late);
+    return late ? 1 : 0;
+}
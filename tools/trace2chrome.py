@@ -0,0 +1,88 @@
+"""Convert a firmware trace dump to Chrome trace JSON (chrome://tracing,
+ui.perfetto.dev).
+
+Reads a console log containing
+
+    TRACE BEGIN hz=<counter Hz> dropped=<n>
+    TR <hex records>
+    ...
+    TRACE END
+
+where each record is 8 bytes little endian: u32 timestamp, u8 stage,
+u8 phase ('B', 'E' or 'i'), u16 arg. Timestamps count at hz (1 MHz from
+current firmware, sleep included); the u32 wraps after ~71 minutes and is
+unwrapped here, which holds as long as consecutive records are less than
+one wrap apart (the main loop records at least every FIFO batch).
+
+usage: python tools/trace2chrome.py console.log > trace.json
+"""
+
+import json
+import re
+import struct
+import sys
+
+STAGES = ["acquisition", "i2c", "spectral", "gait", "output", "sleep"]
+
+
+def parse(lines):
+    dumps = []
+    current = None
+    for line in lines:
+        line = line.strip()
+        m = re.match(r"TRACE BEGIN hz=(\d+)", line)
+        if m:
+            current = {"hz": int(m.group(1)), "data": bytearray()}
+            continue
+        if current is None:
+            continue
+        if line.startswith("TR "):
+            current["data"] += bytes.fromhex(line[3:].strip())
+        elif line.startswith("TRACE END"):
+            dumps.append(current)
+            current = None
+    return dumps
+
+
+def convert(dumps):
+    events = []
+    offset_us = 0.0
+    for dump in dumps:
+        hz = dump["hz"]
+        data = dump["data"]
+        last = None
+        base = 0
+        first_us = None
+        for i in range(0, len(data) - 7, 8):
+            stamp, stage, phase, arg = struct.unpack_from("<IBBH", data, i)
+            if last is not None and stamp < last:
+                base += 1 << 32
+            last = stamp
+            ts = (base + stamp) * 1e6 / hz
+            if first_us is None:
+                first_us = ts
+            name = STAGES[stage] if stage < len(STAGES) else "stage%d" % stage
+            ev = {
+                "name": name,
+                "ph": chr(phase),
+                "ts": offset_us + ts - first_us,
+                "pid": 1,
+                "tid": 1,
+            }
+            if chr(phase) == "i":
+                ev["s"] = "t"
+            if arg:
+                ev["args"] = {"arg": arg}
+            events.append(ev)
+        if events:
+            offset_us = events[-1]["ts"] + 1000.0  # keep dumps apart on the timeline
+    return {"traceEvents": events, "displayTimeUnit": "ms"}
+
+
+def main():
+    src = open(sys.argv[1]) if len(sys.argv) > 1 else sys.stdin
+    json.dump(convert(parse(src)), sys.stdout)
+
+
+if __name__ == "__main__":
+    main()
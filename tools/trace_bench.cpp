@@ -0,0 +1,97 @@
+// Cost of timeline tracing on the host.
+//
+//   g++ -std=gnu++14 -O2 -Iinclude tools/trace_bench.cpp src/trace.cpp -o trace_bench
+//   ./trace_bench
+//
+// Times trace_record() the way the firmware calls it (begin/end pairs,
+// ring overwriting) and trace_drain() per record, each as the fastest of
+// REPEATS runs so scheduler and frequency noise drop out. The clock read
+// is timed the same way for reference only: the two are separate
+// measurements, and their difference is not the ring bookkeeping cost
+// (it can come out negative). The host build timestamps with
+// steady_clock; on the device the clock is a CYCCNT load, a subtract and
+// a divide (trace.cpp). Also checks that drained timestamps never go
+// backwards.
+
+#include "trace.h"
+
+#include <chrono>
+#include <cstdio>
+
+using Clock = std::chrono::steady_clock;
+
+static const int REPEATS = 20;
+
+static double ns_per(Clock::time_point t0, long long n) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / n;
+}
+
+// Fastest of REPEATS runs of fn(), in ns per item
+template <typename F>
+static double min_ns_per(long long items, F fn) {
+    double best = 0.0;
+    for (int r = 0; r < REPEATS; r++) {
+        auto t0 = Clock::now();
+        fn();
+        double ns = ns_per(t0, items);
+        if (r == 0 || ns < best) best = ns;
+    }
+    return best;
+}
+
+int main() {
+    trace_init();
+    const long long pairs = 200000;
+
+    // Warm the ring and caches
+    for (int i = 0; i < TRACE_BUFFER_EVENTS; i++) TRACE_MARK(TRACE_OUTPUT, i);
+
+    double record_ns = min_ns_per(2 * pairs, [&] {
+        for (long long i = 0; i < pairs; i++) {
+            TRACE_BEGIN(TRACE_SPECTRAL);
+            TRACE_END_ARG(TRACE_SPECTRAL, i);
+        }
+    });
+
+    volatile long long sink = 0;
+    double clock_ns = min_ns_per(2 * pairs, [&] {
+        for (long long i = 0; i < 2 * pairs; i++) {
+            sink = sink + Clock::now().time_since_epoch().count();
+        }
+    });
+
+    // Drain a full ring per run, checking timestamp order every time
+    uint32_t dropped = trace_dropped();
+    TraceEvent chunk[64];
+    size_t drained = 0;
+    long long backwards = 0;
+    bool first = true;
+    double drain_ns = 0.0;
+    for (int r = 0; r < REPEATS; r++) {
+        for (int i = 0; i < TRACE_BUFFER_EVENTS; i++) TRACE_MARK(TRACE_OUTPUT, i);
+        size_t run = 0, n;
+        uint32_t last = 0;
+        auto t0 = Clock::now();
+        while ((n = trace_drain(chunk, sizeof(chunk) / sizeof(chunk[0]))) > 0) {
+            for (size_t i = 0; i < n; i++) {
+                if (run + i > 0 && (int32_t)(chunk[i].timestamp_us - last) < 0) backwards++;
+                last = chunk[i].timestamp_us;
+            }
+            run += n;
+        }
+        double ns = ns_per(t0, run);
+        if (first || ns < drain_ns) drain_ns = ns;
+        if (first) drained = run;
+        first = false;
+    }
+
+    printf("ring %d events (%zu bytes), %u Hz timestamps, best of %d runs\n",
+           TRACE_BUFFER_EVENTS, sizeof(TraceEvent) * TRACE_BUFFER_EVENTS,
+           (unsigned)trace_clock_hz(), REPEATS);
+    printf("trace_record: %.1f ns per record, clock read included (steady_clock alone %.1f ns)\n",
+           record_ns, clock_ns);
+    printf("trace_drain:  %.1f ns per record, %zu drained per run, %lu dropped to overwrite\n",
+           drain_ns, drained, (unsigned long)dropped);
+    printf("check: %lld timestamps went backwards\n", backwards);
+    return backwards ? 1 : 0;
+}
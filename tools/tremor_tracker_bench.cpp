@@ -0,0 +1,174 @@
+// Accuracy and cost of the per-sample WFLC tremor tracker on chirps.
+//
+//   g++ -std=gnu++14 -O2 -Iinclude tools/tremor_tracker_bench.cpp src/tremor_tracker.cpp -o tremor_tracker_bench
+//   ./tremor_tracker_bench [--seconds=S] [--seed=N]
+//
+// Each scenario is an acceleration magnitude in g at FS_HZ: gravity,
+// a 0.2 g 1 Hz voluntary component, white noise, and a tremor whose
+// instantaneous frequency and amplitude are known at every sample (steady
+// tones, linear chirps across the band, an amplitude ramp, none at all).
+// After a 3 s lock-in the tracked frequency and amplitude are compared
+// with the truth on every sample the tracker reports as locked, and the
+// share of in-band samples it locks on is listed. The run fails if a
+// tremor locks on less than MIN_LOCKED of its in-band samples, if a locked
+// frequency is off by more than MAX_DF_P95_HZ at the 95th percentile, or
+// if the tracker locks on more than MAX_FALSE_LOCK of a tremor-free
+// signal. The last table is ns per tremor_tracker_update() call.
+
+#include "config.h"
+#include "tremor_tracker.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+static const double TWO_PI = 2.0 * M_PI;
+static const double LOCK_IN_S = 3.0;
+static const double MIN_LOCKED = 0.80;
+static const double MAX_DF_P95_HZ = 0.25;
+static const double MAX_FALSE_LOCK = 0.05;
+
+struct Scenario {
+    const char *name;
+    double f_start, f_end;   // Hz, linear over the run
+    double a_start, a_end;   // g
+};
+
+static const Scenario SCENARIOS[] = {
+    {"tone 3.5 Hz", 3.5, 3.5, 0.08, 0.08},
+    {"tone 4.5 Hz", 4.5, 4.5, 0.08, 0.08},
+    {"chirp 3->5 Hz", 3.0, 5.0, 0.08, 0.08},
+    {"chirp 5->3 Hz", 5.0, 3.0, 0.08, 0.08},
+    {"chirp 3->6 Hz", 3.0, 6.0, 0.08, 0.08},
+    {"weak 4 Hz", 4.0, 4.0, 0.02, 0.02},
+    {"ramp 0.02->0.2", 4.0, 4.0, 0.02, 0.2},
+    {"no tremor", 4.0, 4.0, 0.0, 0.0},
+};
+
+static uint32_t rng;
+static double noise() {
+    rng = rng * 1664525u + 1013904223u;
+    return ((rng >> 8) / 16777216.0) - 0.5;
+}
+
+static int arg_int(int argc, char **argv, const char *name, int fallback) {
+    size_t n = strlen(name);
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], name, n) == 0 && argv[i][n] == '=') return atoi(argv[i] + n + 1);
+    }
+    return fallback;
+}
+
+static double percentile(std::vector<double> v, double p) {
+    if (v.empty()) return 0.0;
+    size_t k = (size_t)(p * (v.size() - 1));
+    std::nth_element(v.begin(), v.begin() + k, v.end());
+    return v[k];
+}
+
+// Signal plus the truth behind it, sample by sample
+static void make_signal(const Scenario &sc, int samples, std::vector<float> &x,
+                        std::vector<double> &freq, std::vector<double> &amp) {
+    x.resize(samples);
+    freq.resize(samples);
+    amp.resize(samples);
+    double phase = 0.0;
+    for (int i = 0; i < samples; i++) {
+        double t = i / (double)FS_HZ;
+        double u = i / (double)(samples - 1);
+        freq[i] = sc.f_start + (sc.f_end - sc.f_start) * u;
+        amp[i] = sc.a_start + (sc.a_end - sc.a_start) * u;
+        phase += TWO_PI * freq[i] / FS_HZ;
+        x[i] = (float)(1.0 + 0.2 * sin(TWO_PI * 1.0 * t) + amp[i] * sin(phase) + 0.02 * noise());
+    }
+}
+
+int main(int argc, char **argv) {
+    const int seconds = arg_int(argc, argv, "--seconds", 60);
+    rng = (uint32_t)arg_int(argc, argv, "--seed", 1);
+    const int samples = (int)(seconds * FS_HZ);
+    const int lock_in = (int)(LOCK_IN_S * FS_HZ);
+
+    printf("fs=%.0f Hz, band %.1f-%.1f Hz, %d s per scenario, errors after %.0f s lock-in\n\n",
+           FS_HZ, TREMOR_F_LOW, TREMOR_F_HIGH, seconds, LOCK_IN_S);
+    printf("%-16s %10s %10s %10s %10s %10s %10s\n", "scenario", "|df| mean", "|df| p95",
+           "|df| max", "da/a mean", "da/a p95", "locked");
+
+    std::vector<float> x;
+    std::vector<double> freq, amp;
+    bool all_ok = true;
+    for (const Scenario &sc : SCENARIOS) {
+        make_signal(sc, samples, x, freq, amp);
+        tremor_tracker_init(FS_HZ, TREMOR_F_LOW, TREMOR_F_HIGH);
+
+        // Without a tremor every locked sample is a false lock
+        const bool tremor = sc.a_start > 0.0 || sc.a_end > 0.0;
+        std::vector<double> df, da;
+        int in_band = 0, locked = 0;
+        for (int i = 0; i < samples; i++) {
+            tremor_tracker_update(x[i]);
+            if (i < lock_in) continue;
+            TremorEstimate e = tremor_tracker_estimate();
+            if (e.locked && tremor) {
+                df.push_back(fabs(e.frequency_hz - freq[i]));
+                da.push_back(fabs(e.amplitude_g - amp[i]) / amp[i]);
+            }
+            if (!tremor || (freq[i] >= TREMOR_F_LOW && freq[i] <= TREMOR_F_HIGH)) {
+                in_band++;
+                locked += e.locked;
+            }
+        }
+        const double share = in_band ? (double)locked / in_band : 0.0;
+        if (!tremor) {
+            all_ok = all_ok && share <= MAX_FALSE_LOCK;
+            printf("%-16s %10s %10s %10s %10s %10s %9.1f%%\n", sc.name, "-", "-", "-", "-", "-",
+                   100.0 * share);
+            continue;
+        }
+        double df_mean = 0.0, da_mean = 0.0;
+        for (double v : df) df_mean += v;
+        for (double v : da) da_mean += v;
+        const double df_p95 = percentile(df, 0.95);
+        all_ok = all_ok && share >= MIN_LOCKED && df_p95 <= MAX_DF_P95_HZ;
+        printf("%-16s %8.3fHz %8.3fHz %8.3fHz %9.1f%% %9.1f%% %9.1f%%\n", sc.name,
+               df.empty() ? 0.0 : df_mean / df.size(), df_p95,
+               df.empty() ? 0.0 : *std::max_element(df.begin(), df.end()),
+               da.empty() ? 0.0 : 100.0 * da_mean / da.size(), 100.0 * percentile(da, 0.95),
+               100.0 * share);
+    }
+    printf("check: %s (tremors locked >= %.0f%% in band with |df| p95 <= %.2f Hz, "
+           "<= %.0f%% locked without one)\n", all_ok ? "ok" : "FAILED", 100.0 * MIN_LOCKED,
+           MAX_DF_P95_HZ, 100.0 * MAX_FALSE_LOCK);
+
+    // Cost: the 3->5 Hz chirp, repeated until the timing is stable
+    using Clock = std::chrono::steady_clock;
+    make_signal(SCENARIOS[2], samples, x, freq, amp);
+    tremor_tracker_init(FS_HZ, TREMOR_F_LOW, TREMOR_F_HIGH);
+    volatile float sink = 0.0f;
+    long long calls = 0;
+    double ns = 0.0;
+    for (int reps = 16; ns < 2e8; reps *= 2) {
+        auto t0 = Clock::now();
+        for (int r = 0; r < reps; r++) {
+            for (int i = 0; i < samples; i++) tremor_tracker_update(x[i]);
+        }
+        ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+        calls = (long long)reps * samples;
+        sink = tremor_tracker_estimate().frequency_hz;
+    }
+    auto t0 = Clock::now();
+    const int estimates = 1000000;
+    for (int i = 0; i < estimates; i++) sink = tremor_tracker_estimate().intensity;
+    double est_ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+    (void)sink;
+
+    printf("\nupdate: %.1f ns per sample (%lld calls), estimate: %.1f ns per call\n",
+           ns / calls, calls, est_ns / estimates);
+    printf("at %.0f Hz that is %.2f us of tracking per second of data\n",
+           FS_HZ, ns / calls * FS_HZ / 1000.0);
+    return all_ok ? 0 : 1;
+}